@@ -36,6 +36,13 @@
 #include "Pkcs5.h"
 #include "Crypto.h"
 
+#ifndef TC_WINDOWS_BOOT
+/* A derivation whose abort flag is set stops after at most this number of iterations
+   of the current output block. Its output is undefined then. */
+#define PKCS5_ABORT_CHECK_INTERVAL	1024
+#define PKCS5_DERIVATION_ABORTED(pAbortKeyDerivation)	((pAbortKeyDerivation) && *(pAbortKeyDerivation))
+#endif
+
 #if !defined(TC_WINDOWS_BOOT) || defined(TC_WINDOWS_BOOT_SHA2)
 
 typedef struct hmac_sha256_ctx_struct
@@ -155,7 +162,7 @@ void hmac_sha256
 }
 #endif
 
-static void derive_u_sha256 (char *salt, int salt_len, uint32 iterations, int b, hmac_sha256_ctx* hmac)
+static void derive_u_sha256 (char *salt, int salt_len, uint32 iterations, int b, hmac_sha256_ctx* hmac, long volatile *pAbortKeyDerivation)
 {
 	char* k = hmac->k;
 	char* u = hmac->u;
@@ -202,11 +209,73 @@ static void derive_u_sha256 (char *salt, int salt_len, uint32 iterations, int b,
 			u[i] ^= k[i];
 		}
 		c--;
+#ifndef TC_WINDOWS_BOOT
+		if ((c % PKCS5_ABORT_CHECK_INTERVAL) == 0 && PKCS5_DERIVATION_ABORTED (pAbortKeyDerivation))
+			break;
+#endif
+	}
+}
+
+#ifdef SHA2_PBKDF2_LANES_SUPPORTED
+/* Derives the output blocks b to b + SHA256_PBKDF2_LANES - 1 in the lanes of the multi-buffer
+   kernel and stores the first dklen bytes of them in dk */
+static void derive_blocks_sha256_lanes (char *salt, int salt_len, uint32 iterations, int b, hmac_sha256_ctx* hmac, char *dk, int dklen, long volatile *pAbortKeyDerivation)
+{
+	CRYPTOPP_ALIGN_DATA(32) uint_32t inner[8 * SHA256_PBKDF2_LANES];
+	CRYPTOPP_ALIGN_DATA(32) uint_32t outer[8 * SHA256_PBKDF2_LANES];
+	CRYPTOPP_ALIGN_DATA(32) uint_32t block[8 * SHA256_PBKDF2_LANES];
+	CRYPTOPP_ALIGN_DATA(32) uint_32t uBlock[8 * SHA256_PBKDF2_LANES];
+	uint_32t* u = (uint_32t*) hmac->u;
+	uint32 c, count;
+	int i, lane;
+
+	for (lane = 0; lane < SHA256_PBKDF2_LANES; lane++)
+	{
+		/* iteration 1 */
+		derive_u_sha256 (salt, salt_len, 1, b + lane, hmac, NULL);
+
+		for (i = 0; i < 8; i++)
+		{
+			inner[i * SHA256_PBKDF2_LANES + lane] = hmac->inner_digest_ctx.hash[i];
+			outer[i * SHA256_PBKDF2_LANES + lane] = hmac->outer_digest_ctx.hash[i];
+			block[i * SHA256_PBKDF2_LANES + lane] = uBlock[i * SHA256_PBKDF2_LANES + lane] = BE32 (u[i]);
+		}
+	}
+
+	/* remaining iterations */
+	for (c = 1; c < iterations; c += count)
+	{
+		count = iterations - c < PKCS5_ABORT_CHECK_INTERVAL ? iterations - c : PKCS5_ABORT_CHECK_INTERVAL;
+
+		if (HasAVX512F() && HasAVX512VL())
+			sha256_avx512_pbkdf2 (inner, outer, uBlock, block, count);
+		else
+			sha256_avx2_pbkdf2 (inner, outer, uBlock, block, count);
+
+		if (PKCS5_DERIVATION_ABORTED (pAbortKeyDerivation))
+			break;
 	}
+
+	for (lane = 0; lane < SHA256_PBKDF2_LANES && dklen > 0; lane++)
+	{
+		for (i = 0; i < 8; i++)
+			u[i] = BE32 (block[i * SHA256_PBKDF2_LANES + lane]);
+
+		memcpy (dk, u, dklen < SHA256_DIGESTSIZE ? dklen : SHA256_DIGESTSIZE);
+		dk += SHA256_DIGESTSIZE;
+		dklen -= SHA256_DIGESTSIZE;
+	}
+
+	/* Prevent possible leaks. */
+	burn (inner, sizeof(inner));
+	burn (outer, sizeof(outer));
+	burn (block, sizeof(block));
+	burn (uBlock, sizeof(uBlock));
 }
+#endif
 
 
-void derive_key_sha256 (char *pwd, int pwd_len, char *salt, int salt_len, uint32 iterations, char *dk, int dklen)
+void derive_key_sha256 (char *pwd, int pwd_len, char *salt, int salt_len, uint32 iterations, char *dk, int dklen, long volatile *pAbortKeyDerivation)
 {	
 	hmac_sha256_ctx hmac;
 	sha256_ctx* ctx;
@@ -277,17 +346,33 @@ void derive_key_sha256 (char *pwd, int pwd_len, char *salt, int salt_len, uint32
 
 	sha256_hash ((unsigned char *) buf, SHA256_BLOCKSIZE, ctx);
 
-	/* first l - 1 blocks */
-	for (b = 1; b < l; b++)
+#ifdef SHA2_PBKDF2_LANES_SUPPORTED
+	/* The output blocks are independent: derive them in parallel lanes, unless only the AVX2
+	   kernel is available and the SHA extensions are faster */
+	if (l > 1 && ((HasAVX512F() && HasAVX512VL()) || (HasSAVX2() && !HasSHANI())))
 	{
-		derive_u_sha256 (salt, salt_len, iterations, b, &hmac);
-		memcpy (dk, hmac.u, SHA256_DIGESTSIZE);
-		dk += SHA256_DIGESTSIZE;
+		for (b = 1; b <= l; b += SHA256_PBKDF2_LANES)
+		{
+			derive_blocks_sha256_lanes (salt, salt_len, iterations, b, &hmac, dk, dklen, pAbortKeyDerivation);
+			dk += SHA256_PBKDF2_LANES * SHA256_DIGESTSIZE;
+			dklen -= SHA256_PBKDF2_LANES * SHA256_DIGESTSIZE;
+		}
 	}
+	else
+#endif
+	{
+		/* first l - 1 blocks */
+		for (b = 1; b < l; b++)
+		{
+			derive_u_sha256 (salt, salt_len, iterations, b, &hmac, pAbortKeyDerivation);
+			memcpy (dk, hmac.u, SHA256_DIGESTSIZE);
+			dk += SHA256_DIGESTSIZE;
+		}
 
-	/* last block */
-	derive_u_sha256 (salt, salt_len, iterations, b, &hmac);
-	memcpy (dk, hmac.u, r);
+		/* last block */
+		derive_u_sha256 (salt, salt_len, iterations, b, &hmac, pAbortKeyDerivation);
+		memcpy (dk, hmac.u, r);
+	}
 
 #if defined (DEVICE_DRIVER)
 	if (NT_SUCCESS (saveStatus))
@@ -425,7 +510,7 @@ void hmac_sha512
 	burn (key, sizeof(key));
 }
 
-static void derive_u_sha512 (char *salt, int salt_len, uint32 iterations, int b, hmac_sha512_ctx* hmac)
+static void derive_u_sha512 (char *salt, int salt_len, uint32 iterations, int b, hmac_sha512_ctx* hmac, long volatile *pAbortKeyDerivation)
 {
 	char* k = hmac->k;
 	char* u = hmac->u;
@@ -448,11 +533,72 @@ static void derive_u_sha512 (char *salt, int salt_len, uint32 iterations, int b,
 		{
 			u[i] ^= k[i];
 		}
+
+		if ((c % PKCS5_ABORT_CHECK_INTERVAL) == 0 && PKCS5_DERIVATION_ABORTED (pAbortKeyDerivation))
+			break;
+	}
+}
+
+#ifdef SHA2_PBKDF2_LANES_SUPPORTED
+/* Derives the output blocks b to b + SHA512_PBKDF2_LANES - 1 in the lanes of the multi-buffer
+   kernel and stores the first dklen bytes of them in dk */
+static void derive_blocks_sha512_lanes (char *salt, int salt_len, uint32 iterations, int b, hmac_sha512_ctx* hmac, char *dk, int dklen, long volatile *pAbortKeyDerivation)
+{
+	CRYPTOPP_ALIGN_DATA(32) uint_64t inner[8 * SHA512_PBKDF2_LANES];
+	CRYPTOPP_ALIGN_DATA(32) uint_64t outer[8 * SHA512_PBKDF2_LANES];
+	CRYPTOPP_ALIGN_DATA(32) uint_64t block[8 * SHA512_PBKDF2_LANES];
+	CRYPTOPP_ALIGN_DATA(32) uint_64t uBlock[8 * SHA512_PBKDF2_LANES];
+	uint_64t* u = (uint_64t*) hmac->u;
+	uint32 c, count;
+	int i, lane;
+
+	for (lane = 0; lane < SHA512_PBKDF2_LANES; lane++)
+	{
+		/* iteration 1 */
+		derive_u_sha512 (salt, salt_len, 1, b + lane, hmac, NULL);
+
+		for (i = 0; i < 8; i++)
+		{
+			inner[i * SHA512_PBKDF2_LANES + lane] = hmac->inner_digest_ctx.hash[i];
+			outer[i * SHA512_PBKDF2_LANES + lane] = hmac->outer_digest_ctx.hash[i];
+			block[i * SHA512_PBKDF2_LANES + lane] = uBlock[i * SHA512_PBKDF2_LANES + lane] = BE64 (u[i]);
+		}
+	}
+
+	/* remaining iterations */
+	for (c = 1; c < iterations; c += count)
+	{
+		count = iterations - c < PKCS5_ABORT_CHECK_INTERVAL ? iterations - c : PKCS5_ABORT_CHECK_INTERVAL;
+
+		if (HasAVX512F() && HasAVX512VL())
+			sha512_avx512_pbkdf2 (inner, outer, uBlock, block, count);
+		else
+			sha512_avx2_pbkdf2 (inner, outer, uBlock, block, count);
+
+		if (PKCS5_DERIVATION_ABORTED (pAbortKeyDerivation))
+			break;
+	}
+
+	for (lane = 0; lane < SHA512_PBKDF2_LANES && dklen > 0; lane++)
+	{
+		for (i = 0; i < 8; i++)
+			u[i] = BE64 (block[i * SHA512_PBKDF2_LANES + lane]);
+
+		memcpy (dk, u, dklen < SHA512_DIGESTSIZE ? dklen : SHA512_DIGESTSIZE);
+		dk += SHA512_DIGESTSIZE;
+		dklen -= SHA512_DIGESTSIZE;
 	}
+
+	/* Prevent possible leaks. */
+	burn (inner, sizeof(inner));
+	burn (outer, sizeof(outer));
+	burn (block, sizeof(block));
+	burn (uBlock, sizeof(uBlock));
 }
+#endif
 
 
-void derive_key_sha512 (char *pwd, int pwd_len, char *salt, int salt_len, uint32 iterations, char *dk, int dklen)
+void derive_key_sha512 (char *pwd, int pwd_len, char *salt, int salt_len, uint32 iterations, char *dk, int dklen, long volatile *pAbortKeyDerivation)
 {
 	hmac_sha512_ctx hmac;
 	sha512_ctx* ctx;
@@ -522,17 +668,32 @@ void derive_key_sha512 (char *pwd, int pwd_len, char *salt, int salt_len, uint32
 
 	sha512_hash ((unsigned char *) buf, SHA512_BLOCKSIZE, ctx);
 
-	/* first l - 1 blocks */
-	for (b = 1; b < l; b++)
+#ifdef SHA2_PBKDF2_LANES_SUPPORTED
+	/* The output blocks are independent: derive them in parallel lanes */
+	if (HasSAVX2() && l > 1)
 	{
-		derive_u_sha512 (salt, salt_len, iterations, b, &hmac);
-		memcpy (dk, hmac.u, SHA512_DIGESTSIZE);
-		dk += SHA512_DIGESTSIZE;
+		for (b = 1; b <= l; b += SHA512_PBKDF2_LANES)
+		{
+			derive_blocks_sha512_lanes (salt, salt_len, iterations, b, &hmac, dk, dklen, pAbortKeyDerivation);
+			dk += SHA512_PBKDF2_LANES * SHA512_DIGESTSIZE;
+			dklen -= SHA512_PBKDF2_LANES * SHA512_DIGESTSIZE;
+		}
 	}
+	else
+#endif
+	{
+		/* first l - 1 blocks */
+		for (b = 1; b < l; b++)
+		{
+			derive_u_sha512 (salt, salt_len, iterations, b, &hmac, pAbortKeyDerivation);
+			memcpy (dk, hmac.u, SHA512_DIGESTSIZE);
+			dk += SHA512_DIGESTSIZE;
+		}
 
-	/* last block */
-	derive_u_sha512 (salt, salt_len, iterations, b, &hmac);
-	memcpy (dk, hmac.u, r);
+		/* last block */
+		derive_u_sha512 (salt, salt_len, iterations, b, &hmac, pAbortKeyDerivation);
+		memcpy (dk, hmac.u, r);
+	}
 
 #if defined (DEVICE_DRIVER)
 	if (NT_SUCCESS (saveStatus))
@@ -669,7 +830,7 @@ void hmac_blake2s
 }
 #endif
 
-static void derive_u_blake2s (char *salt, int salt_len, uint32 iterations, int b, hmac_blake2s_ctx* hmac)
+static void derive_u_blake2s (char *salt, int salt_len, uint32 iterations, int b, hmac_blake2s_ctx* hmac, long volatile *pAbortKeyDerivation)
 {
 	char* k = hmac->k;
 	char* u = hmac->u;
@@ -716,11 +877,85 @@ static void derive_u_blake2s (char *salt, int salt_len, uint32 iterations, int b
 			u[i] ^= k[i];
 		}
 		c--;
+#ifndef TC_WINDOWS_BOOT
+		if ((c % PKCS5_ABORT_CHECK_INTERVAL) == 0 && PKCS5_DERIVATION_ABORTED (pAbortKeyDerivation))
+			break;
+#endif
+	}
+}
+
+#ifdef BLAKE2S_PBKDF2_LANES_SUPPORTED
+/* Derives the output blocks b to b + BLAKE2S_PBKDF2_LANES - 1 in the lanes of the multi-buffer
+   kernel and stores the first dklen bytes of them in dk */
+static void derive_blocks_blake2s_lanes (char *salt, int salt_len, uint32 iterations, int b, hmac_blake2s_ctx* hmac, char *dk, int dklen, long volatile *pAbortKeyDerivation)
+{
+	CRYPTOPP_ALIGN_DATA(32) uint32 inner[8 * BLAKE2S_PBKDF2_LANES];
+	CRYPTOPP_ALIGN_DATA(32) uint32 outer[8 * BLAKE2S_PBKDF2_LANES];
+	CRYPTOPP_ALIGN_DATA(32) uint32 block[8 * BLAKE2S_PBKDF2_LANES];
+	CRYPTOPP_ALIGN_DATA(32) uint32 uBlock[8 * BLAKE2S_PBKDF2_LANES];
+	blake2s_state innerKeyed, outerKeyed;
+	uint32* u = (uint32*) hmac->u;
+	uint32 c, count;
+	int i, lane;
+
+	for (lane = 0; lane < BLAKE2S_PBKDF2_LANES; lane++)
+	{
+		/* iteration 1 */
+		derive_u_blake2s (salt, salt_len, 1, b + lane, hmac, NULL);
+
+		for (i = 0; i < 8; i++)
+			block[i * BLAKE2S_PBKDF2_LANES + lane] = uBlock[i * BLAKE2S_PBKDF2_LANES + lane] = LE32 (u[i]);
+	}
+
+	/* The padded keys stay buffered in the precomputed contexts until more data is hashed.
+	   Hashing a digest compresses them, which gives the chaining values every iteration
+	   starts from. */
+	memcpy (&innerKeyed, &(hmac->inner_digest_ctx), sizeof (blake2s_state));
+	blake2s_update (&innerKeyed, hmac->u, BLAKE2S_DIGESTSIZE);
+	memcpy (&outerKeyed, &(hmac->outer_digest_ctx), sizeof (blake2s_state));
+	blake2s_update (&outerKeyed, hmac->u, BLAKE2S_DIGESTSIZE);
+
+	for (lane = 0; lane < BLAKE2S_PBKDF2_LANES; lane++)
+	{
+		for (i = 0; i < 8; i++)
+		{
+			inner[i * BLAKE2S_PBKDF2_LANES + lane] = innerKeyed.h[i];
+			outer[i * BLAKE2S_PBKDF2_LANES + lane] = outerKeyed.h[i];
+		}
+	}
+
+	/* remaining iterations */
+	for (c = 1; c < iterations; c += count)
+	{
+		count = iterations - c < PKCS5_ABORT_CHECK_INTERVAL ? iterations - c : PKCS5_ABORT_CHECK_INTERVAL;
+		blake2s_avx2_pbkdf2 (inner, outer, uBlock, block, count);
+
+		if (PKCS5_DERIVATION_ABORTED (pAbortKeyDerivation))
+			break;
 	}
+
+	for (lane = 0; lane < BLAKE2S_PBKDF2_LANES && dklen > 0; lane++)
+	{
+		for (i = 0; i < 8; i++)
+			u[i] = LE32 (block[i * BLAKE2S_PBKDF2_LANES + lane]);
+
+		memcpy (dk, u, dklen < BLAKE2S_DIGESTSIZE ? dklen : BLAKE2S_DIGESTSIZE);
+		dk += BLAKE2S_DIGESTSIZE;
+		dklen -= BLAKE2S_DIGESTSIZE;
+	}
+
+	/* Prevent possible leaks. */
+	burn (&innerKeyed, sizeof(innerKeyed));
+	burn (&outerKeyed, sizeof(outerKeyed));
+	burn (inner, sizeof(inner));
+	burn (outer, sizeof(outer));
+	burn (block, sizeof(block));
+	burn (uBlock, sizeof(uBlock));
 }
+#endif
 
 
-void derive_key_blake2s (char *pwd, int pwd_len, char *salt, int salt_len, uint32 iterations, char *dk, int dklen)
+void derive_key_blake2s (char *pwd, int pwd_len, char *salt, int salt_len, uint32 iterations, char *dk, int dklen, long volatile *pAbortKeyDerivation)
 {	
 	hmac_blake2s_ctx hmac;
 	blake2s_state* ctx;
@@ -791,17 +1026,32 @@ void derive_key_blake2s (char *pwd, int pwd_len, char *salt, int salt_len, uint3
 
 	blake2s_update (ctx, buf, BLAKE2S_BLOCKSIZE);
 
-	/* first l - 1 blocks */
-	for (b = 1; b < l; b++)
+#ifdef BLAKE2S_PBKDF2_LANES_SUPPORTED
+	/* The output blocks are independent: derive them in parallel lanes */
+	if (l > 1 && HasSAVX2())
 	{
-		derive_u_blake2s (salt, salt_len, iterations, b, &hmac);
-		memcpy (dk, hmac.u, BLAKE2S_DIGESTSIZE);
-		dk += BLAKE2S_DIGESTSIZE;
+		for (b = 1; b <= l; b += BLAKE2S_PBKDF2_LANES)
+		{
+			derive_blocks_blake2s_lanes (salt, salt_len, iterations, b, &hmac, dk, dklen, pAbortKeyDerivation);
+			dk += BLAKE2S_PBKDF2_LANES * BLAKE2S_DIGESTSIZE;
+			dklen -= BLAKE2S_PBKDF2_LANES * BLAKE2S_DIGESTSIZE;
+		}
 	}
+	else
+#endif
+	{
+		/* first l - 1 blocks */
+		for (b = 1; b < l; b++)
+		{
+			derive_u_blake2s (salt, salt_len, iterations, b, &hmac, pAbortKeyDerivation);
+			memcpy (dk, hmac.u, BLAKE2S_DIGESTSIZE);
+			dk += BLAKE2S_DIGESTSIZE;
+		}
 
-	/* last block */
-	derive_u_blake2s (salt, salt_len, iterations, b, &hmac);
-	memcpy (dk, hmac.u, r);
+		/* last block */
+		derive_u_blake2s (salt, salt_len, iterations, b, &hmac, pAbortKeyDerivation);
+		memcpy (dk, hmac.u, r);
+	}
 
 #if defined (DEVICE_DRIVER)
 	if (NT_SUCCESS (saveStatus))
@@ -926,7 +1176,7 @@ void hmac_whirlpool
 	burn(&hmac, sizeof(hmac));
 }
 
-static void derive_u_whirlpool (char *salt, int salt_len, uint32 iterations, int b, hmac_whirlpool_ctx* hmac)
+static void derive_u_whirlpool (char *salt, int salt_len, uint32 iterations, int b, hmac_whirlpool_ctx* hmac, long volatile *pAbortKeyDerivation)
 {
 	char* u = hmac->u;
 	char* k = hmac->k;
@@ -949,10 +1199,13 @@ static void derive_u_whirlpool (char *salt, int salt_len, uint32 iterations, int
 		{
 			u[i] ^= k[i];
 		}
+
+		if ((c % PKCS5_ABORT_CHECK_INTERVAL) == 0 && PKCS5_DERIVATION_ABORTED (pAbortKeyDerivation))
+			break;
 	}
 }
 
-void derive_key_whirlpool (char *pwd, int pwd_len, char *salt, int salt_len, uint32 iterations, char *dk, int dklen)
+void derive_key_whirlpool (char *pwd, int pwd_len, char *salt, int salt_len, uint32 iterations, char *dk, int dklen, long volatile *pAbortKeyDerivation)
 {
 	hmac_whirlpool_ctx hmac;
 	WHIRLPOOL_CTX* ctx;
@@ -1018,13 +1271,13 @@ void derive_key_whirlpool (char *pwd, int pwd_len, char *salt, int salt_len, uin
 	/* first l - 1 blocks */
 	for (b = 1; b < l; b++)
 	{
-		derive_u_whirlpool (salt, salt_len, iterations, b, &hmac);
+		derive_u_whirlpool (salt, salt_len, iterations, b, &hmac, pAbortKeyDerivation);
 		memcpy (dk, hmac.u, WHIRLPOOL_DIGESTSIZE);
 		dk += WHIRLPOOL_DIGESTSIZE;
 	}
 
 	/* last block */
-	derive_u_whirlpool (salt, salt_len, iterations, b, &hmac);
+	derive_u_whirlpool (salt, salt_len, iterations, b, &hmac, pAbortKeyDerivation);
 	memcpy (dk, hmac.u, r);
 
 #if defined (DEVICE_DRIVER) && !defined (_WIN64)
@@ -1141,7 +1394,7 @@ void hmac_streebog
 	burn(&hmac, sizeof(hmac));
 }
 
-static void derive_u_streebog (char *salt, int salt_len, uint32 iterations, int b, hmac_streebog_ctx* hmac)
+static void derive_u_streebog (char *salt, int salt_len, uint32 iterations, int b, hmac_streebog_ctx* hmac, long volatile *pAbortKeyDerivation)
 {
 	char* u = hmac->u;
 	char* k = hmac->k;
@@ -1164,10 +1417,13 @@ static void derive_u_streebog (char *salt, int salt_len, uint32 iterations, int
 		{
 			u[i] ^= k[i];
 		}
+
+		if ((c % PKCS5_ABORT_CHECK_INTERVAL) == 0 && PKCS5_DERIVATION_ABORTED (pAbortKeyDerivation))
+			break;
 	}
 }
 
-void derive_key_streebog (char *pwd, int pwd_len, char *salt, int salt_len, uint32 iterations, char *dk, int dklen)
+void derive_key_streebog (char *pwd, int pwd_len, char *salt, int salt_len, uint32 iterations, char *dk, int dklen, long volatile *pAbortKeyDerivation)
 {
 	hmac_streebog_ctx hmac;
 	STREEBOG_CTX* ctx;
@@ -1233,13 +1489,13 @@ void derive_key_streebog (char *pwd, int pwd_len, char *salt, int salt_len, uint
 	/* first l - 1 blocks */
 	for (b = 1; b < l; b++)
 	{
-		derive_u_streebog (salt, salt_len, iterations, b, &hmac);
+		derive_u_streebog (salt, salt_len, iterations, b, &hmac, pAbortKeyDerivation);
 		memcpy (dk, hmac.u, STREEBOG_DIGESTSIZE);
 		dk += STREEBOG_DIGESTSIZE;
 	}
 
 	/* last block */
-	derive_u_streebog (salt, salt_len, iterations, b, &hmac);
+	derive_u_streebog (salt, salt_len, iterations, b, &hmac, pAbortKeyDerivation);
 	memcpy (dk, hmac.u, r);
 
 #if defined (DEVICE_DRIVER) && !defined (_WIN64)
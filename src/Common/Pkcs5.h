@@ -20,25 +20,28 @@
 extern "C"
 {
 #endif
+/* The derive_key functions return early, leaving dk undefined, once the value pAbortKeyDerivation
+   points to is nonzero. pAbortKeyDerivation may be NULL. */
+
 /* output written to input_digest which must be at lease 32 bytes long */
 void hmac_blake2s (char *key, int keylen, char *input_digest, int len);
-void derive_key_blake2s (char *pwd, int pwd_len, char *salt, int salt_len, uint32 iterations, char *dk, int dklen);
+void derive_key_blake2s (char *pwd, int pwd_len, char *salt, int salt_len, uint32 iterations, char *dk, int dklen, long volatile *pAbortKeyDerivation);
 
 /* output written to d which must be at lease 32 bytes long */
 void hmac_sha256 (char *k, int lk, char *d, int ld);
-void derive_key_sha256 (char *pwd, int pwd_len, char *salt, int salt_len, uint32 iterations, char *dk, int dklen);
+void derive_key_sha256 (char *pwd, int pwd_len, char *salt, int salt_len, uint32 iterations, char *dk, int dklen, long volatile *pAbortKeyDerivation);
 
 #ifndef TC_WINDOWS_BOOT
 /* output written to d which must be at lease 64 bytes long */
 void hmac_sha512 (char *k, int lk, char *d, int ld);
-void derive_key_sha512 (char *pwd, int pwd_len, char *salt, int salt_len, uint32 iterations, char *dk, int dklen);
+void derive_key_sha512 (char *pwd, int pwd_len, char *salt, int salt_len, uint32 iterations, char *dk, int dklen, long volatile *pAbortKeyDerivation);
 
 /* output written to d which must be at lease 64 bytes long */
 void hmac_whirlpool (char *k, int lk, char *d, int ld);
-void derive_key_whirlpool (char *pwd, int pwd_len, char *salt, int salt_len, uint32 iterations, char *dk, int dklen);
+void derive_key_whirlpool (char *pwd, int pwd_len, char *salt, int salt_len, uint32 iterations, char *dk, int dklen, long volatile *pAbortKeyDerivation);
 
 void hmac_streebog (char *k, int32 lk, char *d, int32 ld);
-void derive_key_streebog (char *pwd, int pwd_len, char *salt, int salt_len, uint32 iterations, char *dk, int dklen);
+void derive_key_streebog (char *pwd, int pwd_len, char *salt, int salt_len, uint32 iterations, char *dk, int dklen, long volatile *pAbortKeyDerivation);
 
 int get_pkcs5_iteration_count (int pkcs5_prf_id, int pim, BOOL truecryptMode, BOOL bBoot);
 wchar_t *get_pkcs5_prf_name (int pkcs5_prf_id);
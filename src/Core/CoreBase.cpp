@@ -14,6 +14,7 @@
 
 #include "CoreBase.h"
 #include "RandomNumberGenerator.h"
+#include "Volume/EncryptionThreadPool.h"
 #include "Volume/Volume.h"
 
 namespace VeraCrypt
@@ -261,10 +262,21 @@ namespace VeraCrypt
 			return false;
 	}
 
-	shared_ptr <Volume> CoreBase::OpenVolume (shared_ptr <VolumePath> volumePath, bool preserveTimestamps, shared_ptr <VolumePassword> password, int pim, shared_ptr<Pkcs5Kdf> kdf, bool truecryptMode, shared_ptr <KeyfileList> keyfiles, VolumeProtection::Enum protection, shared_ptr <VolumePassword> protectionPassword, int protectionPim, shared_ptr<Pkcs5Kdf> protectionKdf, shared_ptr <KeyfileList> protectionKeyfiles, bool sharedAccessAllowed, VolumeType::Enum volumeType, bool useBackupHeaders, bool partitionInSystemEncryptionScope) const
+	shared_ptr <Volume> CoreBase::OpenVolume (shared_ptr <VolumePath> volumePath, bool preserveTimestamps, shared_ptr <VolumePassword> password, int pim, shared_ptr<Pkcs5Kdf> kdf, bool truecryptMode, shared_ptr <KeyfileList> keyfiles, VolumeProtection::Enum protection, shared_ptr <VolumePassword> protectionPassword, int protectionPim, shared_ptr<Pkcs5Kdf> protectionKdf, shared_ptr <KeyfileList> protectionKeyfiles, bool sharedAccessAllowed, VolumeType::Enum volumeType, bool useBackupHeaders, bool partitionInSystemEncryptionScope, bool directIo) const
 	{
+		// Header keys are derived in parallel by the encryption thread pool. Processes that do not run the pool, such as
+		// the core service performing mounts, start it on demand. It is stopped again before FuseService::Mount forks,
+		// as the threads would not exist in the child process.
+		bool threadPoolStarted = false;
+		if (!EncryptionThreadPool::IsRunning())
+		{
+			EncryptionThreadPool::Start();
+			threadPoolStarted = EncryptionThreadPool::IsRunning();
+		}
+		finally_do_arg (bool, threadPoolStarted, { if (finally_arg) EncryptionThreadPool::Stop(); });
+
 		make_shared_auto (Volume, volume);
-		volume->Open (*volumePath, preserveTimestamps, password, pim, kdf, truecryptMode, keyfiles, protection, protectionPassword, protectionPim, protectionKdf, protectionKeyfiles, sharedAccessAllowed, volumeType, useBackupHeaders, partitionInSystemEncryptionScope);
+		volume->Open (*volumePath, preserveTimestamps, password, pim, kdf, truecryptMode, keyfiles, protection, protectionPassword, protectionPim, protectionKdf, protectionKeyfiles, sharedAccessAllowed, volumeType, useBackupHeaders, partitionInSystemEncryptionScope, directIo);
 		return volume;
 	}
 
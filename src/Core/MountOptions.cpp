@@ -22,6 +22,8 @@ namespace VeraCrypt
 #define TC_CLONE_SHARED(TYPE,NAME) NAME = other.NAME ? make_shared <TYPE> (*other.NAME) : shared_ptr <TYPE> ()
 
 		TC_CLONE (CachePassword);
+		TC_CLONE (DirectIo);
+		TC_CLONE (EncryptionThreadCount);
 		TC_CLONE (FilesystemOptions);
 		TC_CLONE (FilesystemType);
 		TC_CLONE_SHARED (KeyfileList, Keyfiles);
@@ -39,6 +41,7 @@ namespace VeraCrypt
 			Kdf.reset();
 		TC_CLONE_SHARED (VolumePath, Path);
 		TC_CLONE (PartitionInSystemEncryptionScope);
+		TC_CLONE (PinEncryptionThreads);
 		TC_CLONE (PreserveTimestamps);
 		TC_CLONE (Protection);
 		TC_CLONE_SHARED (VolumePassword, ProtectionPassword);
@@ -48,6 +51,7 @@ namespace VeraCrypt
 		else
 			ProtectionKdf.reset();
 		TC_CLONE_SHARED (KeyfileList, ProtectionKeyfiles);
+		TC_CLONE (ReadAheadSize);
 		TC_CLONE (Removable);
 		TC_CLONE (SharedAccessAllowed);
 		TC_CLONE (SlotNumber);
@@ -125,6 +129,11 @@ namespace VeraCrypt
 
 		sr.Deserialize ("Pim", Pim);
 		sr.Deserialize ("ProtectionPim", ProtectionPim);
+
+		sr.Deserialize ("EncryptionThreadCount", EncryptionThreadCount);
+		sr.Deserialize ("PinEncryptionThreads", PinEncryptionThreads);
+		sr.Deserialize ("ReadAheadSize", ReadAheadSize);
+		sr.Deserialize ("DirectIo", DirectIo);
 	}
 
 	void MountOptions::Serialize (shared_ptr <Stream> stream) const
@@ -179,6 +188,11 @@ namespace VeraCrypt
 
 		sr.Serialize ("Pim", Pim);
 		sr.Serialize ("ProtectionPim", ProtectionPim);
+
+		sr.Serialize ("EncryptionThreadCount", EncryptionThreadCount);
+		sr.Serialize ("PinEncryptionThreads", PinEncryptionThreads);
+		sr.Serialize ("ReadAheadSize", ReadAheadSize);
+		sr.Serialize ("DirectIo", DirectIo);
 	}
 
 	TC_SERIALIZER_FACTORY_ADD_CLASS (MountOptions);
@@ -26,14 +26,18 @@ namespace VeraCrypt
 		MountOptions ()
 			:
 			CachePassword (false),
+			DirectIo (false),
+			EncryptionThreadCount (0),
 			NoFilesystem (false),
 			NoHardwareCrypto (false),
 			NoKernelCrypto (false),
 			Pim (-1),
 			PartitionInSystemEncryptionScope (false),
+			PinEncryptionThreads (false),
 			PreserveTimestamps (true),
 			Protection (VolumeProtection::None),
 			ProtectionPim (-1),
+			ReadAheadSize (DefaultReadAheadSize),
 			Removable (false),
 			SharedAccessAllowed (false),
 			SlotNumber (0),
@@ -49,7 +53,11 @@ namespace VeraCrypt
 
 		TC_SERIALIZABLE (MountOptions);
 
+		static const uint32 DefaultReadAheadSize = 4096;
+
 		bool CachePassword;
+		bool DirectIo;
+		uint32 EncryptionThreadCount; // 0 = determined by available CPUs
 		wstring FilesystemOptions;
 		wstring FilesystemType;
 		shared_ptr <KeyfileList> Keyfiles;
@@ -62,12 +70,14 @@ namespace VeraCrypt
 		shared_ptr <Pkcs5Kdf> Kdf;
 		bool PartitionInSystemEncryptionScope;
 		shared_ptr <VolumePath> Path;
+		bool PinEncryptionThreads;
 		bool PreserveTimestamps;
 		VolumeProtection::Enum Protection;
 		shared_ptr <VolumePassword> ProtectionPassword;
 		int ProtectionPim;
 		shared_ptr <Pkcs5Kdf> ProtectionKdf;
 		shared_ptr <KeyfileList> ProtectionKeyfiles;
+		uint32 ReadAheadSize; // KiB, 0 = disabled
 		bool Removable;
 		bool SharedAccessAllowed;
 		VolumeSlotNumber SlotNumber;
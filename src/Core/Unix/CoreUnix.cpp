@@ -310,6 +310,14 @@ namespace VeraCrypt
 
 				shared_ptr <Stream> controlFileStream (new FileStream (controlFile));
 				mountedVol = Serializable::DeserializeNew <VolumeInfo> (controlFileStream);
+
+				// Not provided by older versions of the FUSE service
+				try
+				{
+					Serializer sr (controlFileStream);
+					sr.Deserialize ("ReadAheadHits", mountedVol->ReadAheadHits);
+				}
+				catch (...) { }
 			}
 			catch (...)
 			{
@@ -556,7 +564,8 @@ namespace VeraCrypt
 					options.SharedAccessAllowed,
 					VolumeType::Unknown,
 					options.UseBackupHeaders,
-					options.PartitionInSystemEncryptionScope
+					options.PartitionInSystemEncryptionScope,
+					options.DirectIo
 					);
 
 				options.Password.reset();
@@ -628,7 +637,7 @@ namespace VeraCrypt
 
 		try
 		{
-			FuseService::Mount (volume, options.SlotNumber, fuseMountPoint);
+			FuseService::Mount (volume, options.SlotNumber, fuseMountPoint, options.EncryptionThreadCount, options.PinEncryptionThreads, (size_t) options.ReadAheadSize * 1024);
 		}
 		catch (...)
 		{
@@ -49,6 +49,9 @@ namespace VeraCrypt
 	{
 		try
 		{
+			// Volume creation is a bulk job that must not delay interactive work submitted to the same pool
+			EncryptionThreadPool::ClientScope bulkClientScope (EncryptionThreadPool::GetCurrentClient().GetPool().CreateClient (EncryptionThreadPool::ClientWeight::Bulk));
+
 			uint64 endOffset;
 			uint64 filesystemSize = Layout->GetDataSize (HostSize);
 
@@ -113,21 +116,64 @@ namespace VeraCrypt
 				// Empty sectors are encrypted with different key to randomize plaintext
 				Core->RandomizeEncryptionAlgorithmKey (Options->EA);
 
-				SecureBuffer outputBuffer (File::GetOptimalWriteSize());
-				uint64 dataFragmentLength = outputBuffer.Size();
+				// Each fragment is encrypted by the thread pool while the writes of the previous ones are in
+				// flight. The fragments are held in one buffer registered with the queue.
+				const size_t fragmentBufferCount = 8;
+				size_t fragmentSize = File::GetOptimalWriteSize();
+
+				SecureBuffer outputBuffer (fragmentSize * fragmentBufferCount);
+				BufferPtr fragmentBuffer = outputBuffer.GetRange (0, fragmentSize);
+
+				FileIoQueue ioQueue (VolumeFile, fragmentBufferCount);
+				ioQueue.RegisterBuffers (list <BufferPtr> (1, outputBuffer.GetRange (0, outputBuffer.Size())));
+				list <FileIoQueue::RequestId> pendingWrites;
+
+				uint64 dataFragmentLength = VC_MIN (fragmentSize, endOffset - WriteOffset);
+				size_t fragmentIndex = 0;
+				shared_ptr <EncryptionThreadPool::WorkItemCompletion> fragmentEncryption;
+
+				if (WriteOffset < endOffset)
+				{
+					fragmentBuffer.Zero();
+					fragmentEncryption = Options->EA->BeginEncryptSectors (fragmentBuffer, WriteOffset / ENCRYPTION_DATA_UNIT_SIZE, dataFragmentLength / ENCRYPTION_DATA_UNIT_SIZE, ENCRYPTION_DATA_UNIT_SIZE);
+				}
 
 				while (!AbortRequested && WriteOffset < endOffset)
 				{
-					if (WriteOffset + dataFragmentLength > endOffset)
-						dataFragmentLength = endOffset - WriteOffset;
+					fragmentEncryption->Wait();
 
-					outputBuffer.Zero();
-					Options->EA->EncryptSectors (outputBuffer, WriteOffset / ENCRYPTION_DATA_UNIT_SIZE, dataFragmentLength / ENCRYPTION_DATA_UNIT_SIZE, ENCRYPTION_DATA_UNIT_SIZE);
-					VolumeFile->Write (outputBuffer, (size_t) dataFragmentLength);
+					uint64 nextWriteOffset = WriteOffset + dataFragmentLength;
+					uint64 nextDataFragmentLength = VC_MIN (fragmentSize, endOffset - nextWriteOffset);
+					BufferPtr nextFragmentBuffer = outputBuffer.GetRange (((fragmentIndex + 1) % fragmentBufferCount) * fragmentSize, fragmentSize);
 
-					WriteOffset += dataFragmentLength;
+					if (nextDataFragmentLength > 0)
+					{
+						// The buffer of the next fragment is reused once the write of its previous fragment completes
+						while (pendingWrites.size() > fragmentBufferCount - 2)
+						{
+							ioQueue.Wait (pendingWrites.front());
+							pendingWrites.pop_front();
+						}
+
+						nextFragmentBuffer.Zero();
+						fragmentEncryption = Options->EA->BeginEncryptSectors (nextFragmentBuffer, nextWriteOffset / ENCRYPTION_DATA_UNIT_SIZE, nextDataFragmentLength / ENCRYPTION_DATA_UNIT_SIZE, ENCRYPTION_DATA_UNIT_SIZE);
+					}
+
+					pendingWrites.push_back (ioQueue.QueueWrite (fragmentBuffer.GetRange (0, (size_t) dataFragmentLength), WriteOffset));
+					ioQueue.Submit();
+
+					WriteOffset = nextWriteOffset;
 					SizeDone.Set (WriteOffset - DataStart);
+
+					fragmentBuffer = nextFragmentBuffer;
+					dataFragmentLength = nextDataFragmentLength;
+					++fragmentIndex;
 				}
+
+				ioQueue.WaitAll();
+
+				// The backup header of a normal volume is written at the file position following the data
+				VolumeFile->SeekAt (WriteOffset);
 			}
 
 			if (!AbortRequested)
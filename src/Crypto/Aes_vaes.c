@@ -0,0 +1,178 @@
+/*
+ Copyright (c) 2013-2018 IDRIX. All rights reserved.
+
+ Governed by the Apache License 2.0 the full text of which is
+ contained in the file License.txt included in VeraCrypt binary and source
+ code distribution packages.
+*/
+
+#include "Aes_vaes.h"
+#include "Aes_hw_cpu.h"
+
+#ifdef TC_XTS_AES_HW_CPU
+
+#if defined (__VAES__) && defined (__VPCLMULQDQ__) && defined (__AVX512F__) && defined (__AVX512BW__)
+
+#include <immintrin.h>
+
+#define AES_VAES_ROUND_KEY_COUNT 15
+#define AES_VAES_LANE_BLOCKS 4
+#define AES_VAES_PARALLEL_BLOCKS 16
+#define AES_VAES_REGISTER_COUNT (AES_VAES_PARALLEL_BLOCKS / AES_VAES_LANE_BLOCKS)
+
+/* Multiplies the whitening value in each 128-bit lane by x^SHIFT (0 < SHIFT < 64). Both 64-bit
+   halves are shifted left; the bits shifted out of the low half enter the high half and the bits
+   shifted out of the high half are reduced by a carry-less multiplication by 135. */
+#define AES_VAES_XTS_MUL_X(T, SHIFT) \
+	_mm512_xor_si512 ( \
+		_mm512_xor_si512 (_mm512_slli_epi64 (T, SHIFT), _mm512_bslli_epi128 (_mm512_srli_epi64 (T, 64 - (SHIFT)), 8)), \
+		_mm512_clmulepi64_epi128 (_mm512_bsrli_epi128 (_mm512_srli_epi64 (T, 64 - (SHIFT)), 8), reductionPoly, 0x00))
+
+#define AES_VAES_LOAD_ROUND_KEYS() \
+	__m512i roundKeys[AES_VAES_ROUND_KEY_COUNT]; \
+	int i, round; \
+	\
+	for (round = 0; round < AES_VAES_ROUND_KEY_COUNT; ++round) \
+		roundKeys[round] = _mm512_broadcast_i32x4 (_mm_loadu_si128 ((const __m128i *) ks + round));
+
+#define AES_VAES_BLOCKS(ROUND, LAST_ROUND, BLOCK_FUNCTION) \
+	AES_VAES_LOAD_ROUND_KEYS(); \
+	\
+	while (blockCount >= AES_VAES_PARALLEL_BLOCKS) \
+	{ \
+		__m512i b[AES_VAES_REGISTER_COUNT]; \
+		\
+		for (i = 0; i < AES_VAES_REGISTER_COUNT; ++i) \
+			b[i] = _mm512_xor_si512 (_mm512_loadu_si512 ((const __m512i *) data + i), roundKeys[0]); \
+		\
+		for (round = 1; round < AES_VAES_ROUND_KEY_COUNT - 1; ++round) \
+		{ \
+			for (i = 0; i < AES_VAES_REGISTER_COUNT; ++i) \
+				b[i] = ROUND (b[i], roundKeys[round]); \
+		} \
+		\
+		for (i = 0; i < AES_VAES_REGISTER_COUNT; ++i) \
+			_mm512_storeu_si512 ((__m512i *) data + i, LAST_ROUND (b[i], roundKeys[AES_VAES_ROUND_KEY_COUNT - 1])); \
+		\
+		data += AES_VAES_PARALLEL_BLOCKS * 16; \
+		blockCount -= AES_VAES_PARALLEL_BLOCKS; \
+	} \
+	\
+	while (blockCount-- > 0) \
+	{ \
+		BLOCK_FUNCTION (ks, data); \
+		data += 16; \
+	}
+
+/* The whitening value is XORed with the first round key before and with the last round key
+   after the rounds. Each of the four registers holds the whitening values of four consecutive
+   blocks and is advanced by x^16 per iteration. */
+#define AES_VAES_XTS_BLOCKS(ROUND, LAST_ROUND, BLOCKS_FUNCTION) \
+	__m128i t = _mm_loadu_si128 ((const __m128i *) tweak); \
+	\
+	if (blockCount >= AES_VAES_PARALLEL_BLOCKS) \
+	{ \
+		const __m512i reductionPoly = _mm512_set1_epi64 (135); \
+		__m512i tweaks[AES_VAES_REGISTER_COUNT]; \
+		__m512i b[AES_VAES_REGISTER_COUNT]; \
+		__m128i t1 = aes_vaes_xts_mul_x (t); \
+		__m128i t2 = aes_vaes_xts_mul_x (t1); \
+		__m128i t3 = aes_vaes_xts_mul_x (t2); \
+		AES_VAES_LOAD_ROUND_KEYS(); \
+		\
+		tweaks[0] = _mm512_inserti32x4 (_mm512_inserti32x4 (_mm512_inserti32x4 (_mm512_castsi128_si512 (t), t1, 1), t2, 2), t3, 3); \
+		\
+		for (i = 1; i < AES_VAES_REGISTER_COUNT; ++i) \
+			tweaks[i] = AES_VAES_XTS_MUL_X (tweaks[i - 1], AES_VAES_LANE_BLOCKS); \
+		\
+		do \
+		{ \
+			for (i = 0; i < AES_VAES_REGISTER_COUNT; ++i) \
+				b[i] = _mm512_ternarylogic_epi64 (_mm512_loadu_si512 ((const __m512i *) data + i), tweaks[i], roundKeys[0], 0x96); \
+			\
+			for (round = 1; round < AES_VAES_ROUND_KEY_COUNT - 1; ++round) \
+			{ \
+				for (i = 0; i < AES_VAES_REGISTER_COUNT; ++i) \
+					b[i] = ROUND (b[i], roundKeys[round]); \
+			} \
+			\
+			for (i = 0; i < AES_VAES_REGISTER_COUNT; ++i) \
+			{ \
+				_mm512_storeu_si512 ((__m512i *) data + i, LAST_ROUND (b[i], _mm512_xor_si512 (tweaks[i], roundKeys[AES_VAES_ROUND_KEY_COUNT - 1]))); \
+				tweaks[i] = AES_VAES_XTS_MUL_X (tweaks[i], AES_VAES_PARALLEL_BLOCKS); \
+			} \
+			\
+			data += AES_VAES_PARALLEL_BLOCKS * 16; \
+			blockCount -= AES_VAES_PARALLEL_BLOCKS; \
+		} \
+		while (blockCount >= AES_VAES_PARALLEL_BLOCKS); \
+		\
+		t = _mm512_castsi512_si128 (tweaks[0]); \
+	} \
+	\
+	_mm_storeu_si128 ((__m128i *) tweak, t); \
+	\
+	if (blockCount > 0) \
+		BLOCKS_FUNCTION (ks, data, tweak, blockCount);
+
+VC_INLINE __m128i aes_vaes_xts_mul_x (__m128i t)
+{
+	__m128i carry = _mm_shuffle_epi32 (_mm_srai_epi32 (t, 31), _MM_SHUFFLE (1, 1, 3, 3));
+	carry = _mm_and_si128 (carry, _mm_set_epi32 (0, 1, 0, 135));
+
+	return _mm_xor_si128 (_mm_add_epi64 (t, t), carry);
+}
+
+void aes_vaes_decrypt_blocks (const byte *ks, byte *data, size_t blockCount)
+{
+	AES_VAES_BLOCKS (_mm512_aesdec_epi128, _mm512_aesdeclast_epi128, aes_hw_cpu_decrypt);
+}
+
+void aes_vaes_encrypt_blocks (const byte *ks, byte *data, size_t blockCount)
+{
+	AES_VAES_BLOCKS (_mm512_aesenc_epi128, _mm512_aesenclast_epi128, aes_hw_cpu_encrypt);
+}
+
+void xts_aes_vaes_decrypt_blocks (const byte *ks, byte *data, byte *tweak, size_t blockCount)
+{
+	AES_VAES_XTS_BLOCKS (_mm512_aesdec_epi128, _mm512_aesdeclast_epi128, xts_aes_hw_cpu_decrypt_blocks);
+}
+
+void xts_aes_vaes_encrypt_blocks (const byte *ks, byte *data, byte *tweak, size_t blockCount)
+{
+	AES_VAES_XTS_BLOCKS (_mm512_aesenc_epi128, _mm512_aesenclast_epi128, xts_aes_hw_cpu_encrypt_blocks);
+}
+
+#else // The compiler does not support VAES and AVX-512
+
+void aes_vaes_decrypt_blocks (const byte *ks, byte *data, size_t blockCount)
+{
+	while (blockCount-- > 0)
+	{
+		aes_hw_cpu_decrypt (ks, data);
+		data += 16;
+	}
+}
+
+void aes_vaes_encrypt_blocks (const byte *ks, byte *data, size_t blockCount)
+{
+	while (blockCount-- > 0)
+	{
+		aes_hw_cpu_encrypt (ks, data);
+		data += 16;
+	}
+}
+
+void xts_aes_vaes_decrypt_blocks (const byte *ks, byte *data, byte *tweak, size_t blockCount)
+{
+	xts_aes_hw_cpu_decrypt_blocks (ks, data, tweak, blockCount);
+}
+
+void xts_aes_vaes_encrypt_blocks (const byte *ks, byte *data, byte *tweak, size_t blockCount)
+{
+	xts_aes_hw_cpu_encrypt_blocks (ks, data, tweak, blockCount);
+}
+
+#endif
+
+#endif // TC_XTS_AES_HW_CPU
@@ -0,0 +1,40 @@
+/*
+ Copyright (c) 2013-2018 IDRIX. All rights reserved.
+
+ Governed by the Apache License 2.0 the full text of which is
+ contained in the file License.txt included in VeraCrypt binary and source
+ code distribution packages.
+*/
+
+#ifndef TC_HEADER_Crypto_Aes_vaes
+#define TC_HEADER_Crypto_Aes_vaes
+
+#include "Common/Tcdefs.h"
+#include "Xts_simd.h"
+
+#ifdef TC_XTS_AES_HW_CPU
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+/* AES-256 on four 128-bit lanes of ZMM registers using VAES. Sixteen blocks are processed
+   per iteration; remaining blocks are passed to the 128-bit AES-NI routines. ks points to
+   the 15 round keys of the respective direction.
+
+   The routines may only be called if HasVAES(), HasVPCLMULQDQ(), HasAVX512F() and
+   HasAVX512BW() are all true. If the compiler lacks support for these extensions, they
+   fall back to the AES-NI routines. */
+void aes_vaes_decrypt_blocks (const byte *ks, byte *data, size_t blockCount);
+void aes_vaes_encrypt_blocks (const byte *ks, byte *data, size_t blockCount);
+void xts_aes_vaes_decrypt_blocks (const byte *ks, byte *data, byte *tweak, size_t blockCount);
+void xts_aes_vaes_encrypt_blocks (const byte *ks, byte *data, byte *tweak, size_t blockCount);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // TC_XTS_AES_HW_CPU
+
+#endif // TC_HEADER_Crypto_Aes_vaes
@@ -58,6 +58,19 @@ void camellia_dec_blk2(const byte *ctx, byte *dst, const byte *src);
 void camellia_ecb_enc_16way(const byte *ctx, byte *dst, const byte *src);
 void camellia_ecb_dec_16way(const byte *ctx, byte *dst, const byte *src);
 
+/* The 32-way AVX2/VAES kernel is only assembled by the Unix makefiles. The Windows and
+   macOS builds use yasm, which does not support VAES instructions. */
+#if !defined (_WIN32) && !defined (TC_MACOSX) && !defined (_UEFI)
+#define CAMELLIA_VAES_32WAY
+
+void camellia_ecb_enc_32way(const byte *ctx, byte *dst, const byte *src);
+void camellia_ecb_dec_32way(const byte *ctx, byte *dst, const byte *src);
+
+#define IsCamelliaVaesSupported() (HasSAVX2() && HasVAES())
+#else
+#define IsCamelliaVaesSupported() 0
+#endif
+
 /* key constants */
 
 #define CAMELLIA_SIGMA1L (0xA09E667FL)
@@ -1096,12 +1109,25 @@ void camellia_decrypt(const unsigned __int8 *inBlock,  unsigned __int8 *outBlock
 void camellia_encrypt_blocks(unsigned __int8 *instance, const byte* in_blk, byte* out_blk, uint32 blockCount)
 {
 #if !defined (_UEFI)
-	if ((blockCount >= 16) && IsCpuIntel() && IsAesHwCpuSupported () && HasSAVX()) /* on AMD cpu, AVX is too slow */
+	/* on AMD cpu, AVX is too slow, except on those implementing VAES */
+	if ((blockCount >= 16) && (IsCpuIntel() || IsCamelliaVaesSupported()) && IsAesHwCpuSupported () && HasSAVX())
 	{
 #if defined (TC_WINDOWS_DRIVER)
 		XSTATE_SAVE SaveState;
 		if (NT_SUCCESS (KeSaveExtendedProcessorStateVC(XSTATE_MASK_GSSE, &SaveState)))
 		{
+#endif
+#ifdef CAMELLIA_VAES_32WAY
+			if (IsCamelliaVaesSupported())
+			{
+				while (blockCount >= 32)
+				{
+					camellia_ecb_enc_32way (instance, out_blk, in_blk);
+					out_blk += 32 * 16;
+					in_blk += 32 * 16;
+					blockCount -= 32;
+				}
+			}
 #endif
 			while (blockCount >= 16)
 			{
@@ -1132,12 +1158,25 @@ void camellia_encrypt_blocks(unsigned __int8 *instance, const byte* in_blk, byte
 void camellia_decrypt_blocks(unsigned __int8 *instance, const byte* in_blk, byte* out_blk, uint32 blockCount)
 {
 #if !defined (_UEFI)
-	if ((blockCount >= 16) && IsCpuIntel() && IsAesHwCpuSupported () && HasSAVX()) /* on AMD cpu, AVX is too slow */
+	/* on AMD cpu, AVX is too slow, except on those implementing VAES */
+	if ((blockCount >= 16) && (IsCpuIntel() || IsCamelliaVaesSupported()) && IsAesHwCpuSupported () && HasSAVX())
 	{
 #if defined (TC_WINDOWS_DRIVER)
 		XSTATE_SAVE SaveState;
 		if (NT_SUCCESS (KeSaveExtendedProcessorStateVC(XSTATE_MASK_GSSE, &SaveState)))
 		{
+#endif
+#ifdef CAMELLIA_VAES_32WAY
+			if (IsCamelliaVaesSupported())
+			{
+				while (blockCount >= 32)
+				{
+					camellia_ecb_dec_32way (instance, out_blk, in_blk);
+					out_blk += 32 * 16;
+					in_blk += 32 * 16;
+					blockCount -= 32;
+				}
+			}
 #endif
 		while (blockCount >= 16)
 		{
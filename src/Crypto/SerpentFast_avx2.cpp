@@ -0,0 +1,182 @@
+/*
+* Serpent (AVX2)
+* (C) 2009,2013 Jack Lloyd
+*
+* Botan is released under the Simplified BSD License (see license.txt)
+*/
+
+#include "SerpentFast.h"
+#include "SerpentFast_simd.h"
+#include "cpu.h"
+#include "misc.h"
+
+#if defined(__AVX2__)
+
+#include <immintrin.h>
+
+/**
+* 256-bit counterpart of SIMD_4x32 in SerpentFast_simd.cpp. Each 128-bit lane
+* holds the bitsliced words of four blocks, so that 8 blocks are processed at once.
+*/
+class SIMD_8x32
+{
+public:
+
+    SIMD_8x32() // zero initialized
+        {
+        m_reg = _mm256_setzero_si256();
+        }
+
+    explicit SIMD_8x32(unsigned __int32 B)
+        {
+        m_reg = _mm256_set1_epi32(B);
+        }
+
+    static SIMD_8x32 load_le(const void* in)
+        {
+        return SIMD_8x32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in)));
+        }
+
+    void store_le(unsigned __int8 out[]) const
+        {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), m_reg);
+        }
+
+    void rotate_left(size_t rot)
+        {
+        m_reg = _mm256_or_si256(_mm256_slli_epi32(m_reg, static_cast<int>(rot)),
+                                _mm256_srli_epi32(m_reg, static_cast<int>(32-rot)));
+        }
+
+    void rotate_right(size_t rot)
+        {
+        rotate_left(32 - rot);
+        }
+
+    void operator^=(const SIMD_8x32& other)
+        {
+        m_reg = _mm256_xor_si256(m_reg, other.m_reg);
+        }
+
+    SIMD_8x32 operator^(const SIMD_8x32& other) const
+        {
+        return SIMD_8x32(_mm256_xor_si256(m_reg, other.m_reg));
+        }
+
+    void operator|=(const SIMD_8x32& other)
+        {
+        m_reg = _mm256_or_si256(m_reg, other.m_reg);
+        }
+
+    void operator&=(const SIMD_8x32& other)
+        {
+        m_reg = _mm256_and_si256(m_reg, other.m_reg);
+        }
+
+    SIMD_8x32 operator<<(size_t shift) const
+        {
+        return SIMD_8x32(_mm256_slli_epi32(m_reg, static_cast<int>(shift)));
+        }
+
+    SIMD_8x32 operator~() const
+        {
+        return SIMD_8x32(_mm256_xor_si256(m_reg, _mm256_set1_epi32(0xFFFFFFFF)));
+        }
+
+    // Transposes the 4x4 matrix of 32-bit words in each 128-bit lane
+    static void transpose(SIMD_8x32& B0, SIMD_8x32& B1,
+                        SIMD_8x32& B2, SIMD_8x32& B3)
+        {
+        __m256i T0 = _mm256_unpacklo_epi32(B0.m_reg, B1.m_reg);
+        __m256i T1 = _mm256_unpacklo_epi32(B2.m_reg, B3.m_reg);
+        __m256i T2 = _mm256_unpackhi_epi32(B0.m_reg, B1.m_reg);
+        __m256i T3 = _mm256_unpackhi_epi32(B2.m_reg, B3.m_reg);
+        B0.m_reg = _mm256_unpacklo_epi64(T0, T1);
+        B1.m_reg = _mm256_unpackhi_epi64(T0, T1);
+        B2.m_reg = _mm256_unpacklo_epi64(T2, T3);
+        B3.m_reg = _mm256_unpackhi_epi64(T2, T3);
+        }
+
+private:
+
+    explicit SIMD_8x32(__m256i in) { m_reg = in; }
+
+    __m256i m_reg;
+
+};
+
+/*
+* The blocks are loaded contiguously. As the same transposition is applied before and
+* after the rounds, the order in which the lanes hold the blocks does not matter.
+*/
+extern "C" void serpent_avx2_encrypt_blocks(const unsigned __int8* in, unsigned __int8* out, size_t blocks, unsigned __int8 *ks)
+{
+   const unsigned __int32* round_key = ((const unsigned __int32*) ks) + 8;
+
+   while (blocks >= 8)
+   {
+      SIMD_8x32 B0 = SIMD_8x32::load_le(in);
+      SIMD_8x32 B1 = SIMD_8x32::load_le(in + 32);
+      SIMD_8x32 B2 = SIMD_8x32::load_le(in + 64);
+      SIMD_8x32 B3 = SIMD_8x32::load_le(in + 96);
+
+      SIMD_8x32::transpose(B0, B1, B2, B3);
+      serpent_simd_encrypt_rounds(B0, B1, B2, B3, round_key);
+      SIMD_8x32::transpose(B0, B1, B2, B3);
+
+      B0.store_le(out);
+      B1.store_le(out + 32);
+      B2.store_le(out + 64);
+      B3.store_le(out + 96);
+
+      in += 8 * 16;
+      out += 8 * 16;
+      blocks -= 8;
+   }
+
+   if (blocks > 0)
+      serpent_encrypt_blocks(in, out, blocks, ks);
+}
+
+extern "C" void serpent_avx2_decrypt_blocks(const unsigned __int8* in, unsigned __int8* out, size_t blocks, unsigned __int8 *ks)
+{
+   const unsigned __int32* round_key = ((const unsigned __int32*) ks) + 8;
+
+   while (blocks >= 8)
+   {
+      SIMD_8x32 B0 = SIMD_8x32::load_le(in);
+      SIMD_8x32 B1 = SIMD_8x32::load_le(in + 32);
+      SIMD_8x32 B2 = SIMD_8x32::load_le(in + 64);
+      SIMD_8x32 B3 = SIMD_8x32::load_le(in + 96);
+
+      SIMD_8x32::transpose(B0, B1, B2, B3);
+      serpent_simd_decrypt_rounds(B0, B1, B2, B3, round_key);
+      SIMD_8x32::transpose(B0, B1, B2, B3);
+
+      B0.store_le(out);
+      B1.store_le(out + 32);
+      B2.store_le(out + 64);
+      B3.store_le(out + 96);
+
+      in += 8 * 16;
+      out += 8 * 16;
+      blocks -= 8;
+   }
+
+   if (blocks > 0)
+      serpent_decrypt_blocks(in, out, blocks, ks);
+}
+
+#else // The compiler does not support AVX2
+
+extern "C" void serpent_avx2_encrypt_blocks(const unsigned __int8* in, unsigned __int8* out, size_t blocks, unsigned __int8 *ks)
+{
+   serpent_encrypt_blocks(in, out, blocks, ks);
+}
+
+extern "C" void serpent_avx2_decrypt_blocks(const unsigned __int8* in, unsigned __int8* out, size_t blocks, unsigned __int8 *ks)
+{
+   serpent_decrypt_blocks(in, out, blocks, ks);
+}
+
+#endif
@@ -0,0 +1,194 @@
+/*
+* Serpent (AVX-512)
+* (C) 2009,2013 Jack Lloyd
+*
+* Botan is released under the Simplified BSD License (see license.txt)
+*/
+
+#include "SerpentFast.h"
+#include "SerpentFast_simd.h"
+#include "cpu.h"
+#include "misc.h"
+
+#if defined(__AVX512F__)
+
+#include <immintrin.h>
+
+/*
+* GCC 12 expands the unmasked AVX-512 intrinsics through the self-initialized
+* _mm512_undefined_epi32(), which -Wmaybe-uninitialized reports at every inlined use.
+*/
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+/**
+* 512-bit counterpart of SIMD_4x32 in SerpentFast_simd.cpp. Each 128-bit lane
+* holds the bitsliced words of four blocks, so that 16 blocks are processed at once.
+*/
+class SIMD_16x32
+{
+public:
+
+    SIMD_16x32() // zero initialized
+        {
+        m_reg = _mm512_setzero_si512();
+        }
+
+    explicit SIMD_16x32(unsigned __int32 B)
+        {
+        m_reg = _mm512_set1_epi32(B);
+        }
+
+    static SIMD_16x32 load_le(const void* in)
+        {
+        return SIMD_16x32(_mm512_loadu_si512(reinterpret_cast<const __m512i*>(in)));
+        }
+
+    void store_le(unsigned __int8 out[]) const
+        {
+        _mm512_storeu_si512(reinterpret_cast<__m512i*>(out), m_reg);
+        }
+
+    void rotate_left(size_t rot)
+        {
+        m_reg = _mm512_rolv_epi32(m_reg, _mm512_set1_epi32(static_cast<int>(rot)));
+        }
+
+    void rotate_right(size_t rot)
+        {
+        rotate_left(32 - rot);
+        }
+
+    void operator^=(const SIMD_16x32& other)
+        {
+        m_reg = _mm512_xor_si512(m_reg, other.m_reg);
+        }
+
+    SIMD_16x32 operator^(const SIMD_16x32& other) const
+        {
+        return SIMD_16x32(_mm512_xor_si512(m_reg, other.m_reg));
+        }
+
+    void operator|=(const SIMD_16x32& other)
+        {
+        m_reg = _mm512_or_si512(m_reg, other.m_reg);
+        }
+
+    void operator&=(const SIMD_16x32& other)
+        {
+        m_reg = _mm512_and_si512(m_reg, other.m_reg);
+        }
+
+    SIMD_16x32 operator<<(size_t shift) const
+        {
+        return SIMD_16x32(_mm512_slli_epi32(m_reg, static_cast<int>(shift)));
+        }
+
+    SIMD_16x32 operator~() const
+        {
+        return SIMD_16x32(_mm512_xor_si512(m_reg, _mm512_set1_epi32(0xFFFFFFFF)));
+        }
+
+    // Transposes the 4x4 matrix of 32-bit words in each 128-bit lane
+    static void transpose(SIMD_16x32& B0, SIMD_16x32& B1,
+                        SIMD_16x32& B2, SIMD_16x32& B3)
+        {
+        __m512i T0 = _mm512_unpacklo_epi32(B0.m_reg, B1.m_reg);
+        __m512i T1 = _mm512_unpacklo_epi32(B2.m_reg, B3.m_reg);
+        __m512i T2 = _mm512_unpackhi_epi32(B0.m_reg, B1.m_reg);
+        __m512i T3 = _mm512_unpackhi_epi32(B2.m_reg, B3.m_reg);
+        B0.m_reg = _mm512_unpacklo_epi64(T0, T1);
+        B1.m_reg = _mm512_unpackhi_epi64(T0, T1);
+        B2.m_reg = _mm512_unpacklo_epi64(T2, T3);
+        B3.m_reg = _mm512_unpackhi_epi64(T2, T3);
+        }
+
+private:
+
+    explicit SIMD_16x32(__m512i in) { m_reg = in; }
+
+    __m512i m_reg;
+
+};
+
+/*
+* The blocks are loaded contiguously. As the same transposition is applied before and
+* after the rounds, the order in which the lanes hold the blocks does not matter.
+*/
+extern "C" void serpent_avx512_encrypt_blocks(const unsigned __int8* in, unsigned __int8* out, size_t blocks, unsigned __int8 *ks)
+{
+   const unsigned __int32* round_key = ((const unsigned __int32*) ks) + 8;
+
+   while (blocks >= 16)
+   {
+      SIMD_16x32 B0 = SIMD_16x32::load_le(in);
+      SIMD_16x32 B1 = SIMD_16x32::load_le(in + 64);
+      SIMD_16x32 B2 = SIMD_16x32::load_le(in + 128);
+      SIMD_16x32 B3 = SIMD_16x32::load_le(in + 192);
+
+      SIMD_16x32::transpose(B0, B1, B2, B3);
+      serpent_simd_encrypt_rounds(B0, B1, B2, B3, round_key);
+      SIMD_16x32::transpose(B0, B1, B2, B3);
+
+      B0.store_le(out);
+      B1.store_le(out + 64);
+      B2.store_le(out + 128);
+      B3.store_le(out + 192);
+
+      in += 16 * 16;
+      out += 16 * 16;
+      blocks -= 16;
+   }
+
+   if (blocks > 0)
+      serpent_encrypt_blocks(in, out, blocks, ks);
+}
+
+extern "C" void serpent_avx512_decrypt_blocks(const unsigned __int8* in, unsigned __int8* out, size_t blocks, unsigned __int8 *ks)
+{
+   const unsigned __int32* round_key = ((const unsigned __int32*) ks) + 8;
+
+   while (blocks >= 16)
+   {
+      SIMD_16x32 B0 = SIMD_16x32::load_le(in);
+      SIMD_16x32 B1 = SIMD_16x32::load_le(in + 64);
+      SIMD_16x32 B2 = SIMD_16x32::load_le(in + 128);
+      SIMD_16x32 B3 = SIMD_16x32::load_le(in + 192);
+
+      SIMD_16x32::transpose(B0, B1, B2, B3);
+      serpent_simd_decrypt_rounds(B0, B1, B2, B3, round_key);
+      SIMD_16x32::transpose(B0, B1, B2, B3);
+
+      B0.store_le(out);
+      B1.store_le(out + 64);
+      B2.store_le(out + 128);
+      B3.store_le(out + 192);
+
+      in += 16 * 16;
+      out += 16 * 16;
+      blocks -= 16;
+   }
+
+   if (blocks > 0)
+      serpent_decrypt_blocks(in, out, blocks, ks);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#else // The compiler does not support AVX-512
+
+extern "C" void serpent_avx512_encrypt_blocks(const unsigned __int8* in, unsigned __int8* out, size_t blocks, unsigned __int8 *ks)
+{
+   serpent_encrypt_blocks(in, out, blocks, ks);
+}
+
+extern "C" void serpent_avx512_decrypt_blocks(const unsigned __int8* in, unsigned __int8* out, size_t blocks, unsigned __int8 *ks)
+{
+   serpent_decrypt_blocks(in, out, blocks, ks);
+}
+
+#endif
@@ -39,7 +39,7 @@ typedef void (*transformFn)(sha512_ctx* ctx, void* m, uint_64t num_blks);
 
 transformFn transfunc = NULL;
 
-static const uint_64t K[80] = {
+CRYPTOPP_ALIGN_DATA(16) const uint_64t SHA512_K[80] CRYPTOPP_SECTION_ALIGN16 = {
 	LL(0x428a2f98d728ae22), LL(0x7137449123ef65cd), LL(0xb5c0fbcfec4d3b2f), LL(0xe9b5dba58189dbbc),
 	LL(0x3956c25bf348b538), LL(0x59f111f1b605d019), LL(0x923f82a4af194f9b), LL(0xab1c5ed5da6d8118),
 	LL(0xd807aa98a3030242), LL(0x12835b0145706fbe), LL(0x243185be4ee4b28c), LL(0x550c7dc3d5ffb4e2),
@@ -116,25 +116,25 @@ void StdTransform(sha512_ctx* ctx, void* mp, uint_64t num_blks)
 #if defined (TC_WINDOWS_DRIVER) && defined (DEBUG)
 			for (j = 0; j < 16; j++)
 			{
-				COMPRESS_ROUND(i, j, K);
+				COMPRESS_ROUND(i, j, SHA512_K);
 			}
 #else
-			COMPRESS_ROUND(i, 0, K);
-			COMPRESS_ROUND(i, 1, K);
-			COMPRESS_ROUND(i , 2, K);
-			COMPRESS_ROUND(i, 3, K);
-			COMPRESS_ROUND(i, 4, K);
-			COMPRESS_ROUND(i, 5, K);
-			COMPRESS_ROUND(i, 6, K);
-			COMPRESS_ROUND(i, 7, K);
-			COMPRESS_ROUND(i, 8, K);
-			COMPRESS_ROUND(i, 9, K);
-			COMPRESS_ROUND(i, 10, K);
-			COMPRESS_ROUND(i, 11, K);
-			COMPRESS_ROUND(i, 12, K);
-			COMPRESS_ROUND(i, 13, K);
-			COMPRESS_ROUND(i, 14, K);
-			COMPRESS_ROUND(i, 15, K);
+			COMPRESS_ROUND(i, 0, SHA512_K);
+			COMPRESS_ROUND(i, 1, SHA512_K);
+			COMPRESS_ROUND(i , 2, SHA512_K);
+			COMPRESS_ROUND(i, 3, SHA512_K);
+			COMPRESS_ROUND(i, 4, SHA512_K);
+			COMPRESS_ROUND(i, 5, SHA512_K);
+			COMPRESS_ROUND(i, 6, SHA512_K);
+			COMPRESS_ROUND(i, 7, SHA512_K);
+			COMPRESS_ROUND(i, 8, SHA512_K);
+			COMPRESS_ROUND(i, 9, SHA512_K);
+			COMPRESS_ROUND(i, 10, SHA512_K);
+			COMPRESS_ROUND(i, 11, SHA512_K);
+			COMPRESS_ROUND(i, 12, SHA512_K);
+			COMPRESS_ROUND(i, 13, SHA512_K);
+			COMPRESS_ROUND(i, 14, SHA512_K);
+			COMPRESS_ROUND(i, 15, SHA512_K);
 #endif
 		}
 		ctx->hash[0] += a;
@@ -318,7 +318,7 @@ extern "C"
 
 #endif
 
-CRYPTOPP_ALIGN_DATA(16) static const uint_32t SHA256_K[64] CRYPTOPP_SECTION_ALIGN16 = {
+CRYPTOPP_ALIGN_DATA(16) const uint_32t SHA256_K[64] CRYPTOPP_SECTION_ALIGN16 = {
 		0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
 		0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
 		0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
@@ -747,6 +747,13 @@ void SSE2Sha256Transform(sha256_ctx* ctx, void* mp, uint_64t num_blks)
 }
 #endif
 
+#ifdef SHA256_SHANI_SUPPORTED
+void ShaNiSha256Transform(sha256_ctx* ctx, void* mp, uint_64t num_blks)
+{
+	sha256_shani(mp, ctx->hash, num_blks);
+}
+#endif
+
 #if CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32
 void Sha256AsmTransform(sha256_ctx* ctx, void* mp, uint_64t num_blks)
 {
@@ -774,6 +781,12 @@ void sha256_begin(sha256_ctx* ctx)
 	if (!sha256transfunc)
 	{
 #ifndef NO_OPTIMIZED_VERSIONS
+#ifdef SHA256_SHANI_SUPPORTED
+		if (HasSHANI())
+			sha256transfunc = ShaNiSha256Transform;
+		else
+#endif
+
 #if CRYPTOPP_BOOL_X64
 		if (g_isIntel && HasSAVX2() && HasSBMI2())
 			sha256transfunc = Avx2Sha256Transform;
@@ -51,6 +51,35 @@ void sha256_hash(const unsigned char * source, uint_32t sourceLen, sha256_ctx *c
 void sha256_end(unsigned char * result, sha256_ctx* ctx);
 void sha256(unsigned char * result, const unsigned char* source, uint_32t sourceLen);
 
+extern const uint_64t SHA512_K[80];
+extern const uint_32t SHA256_K[64];
+
+/* SHA-256 compression using the SHA extensions, built by the Unix makefiles for x86 and x64.
+   May only be called if HasSHANI() is true. */
+#if defined (TC_UNIX) && (CRYPTOPP_BOOL_X64 || CRYPTOPP_BOOL_X86) && !defined (CRYPTOPP_DISABLE_ASM)
+#define SHA256_SHANI_SUPPORTED
+void sha256_shani (const void *input_data, uint_32t digest[8], uint_64t num_blks);
+#endif
+
+/* Multi-lane PBKDF2 kernels, built by the Unix makefiles for x64 */
+#if defined (TC_UNIX) && CRYPTOPP_BOOL_X64 && !defined (CRYPTOPP_DISABLE_ASM)
+#define SHA2_PBKDF2_LANES_SUPPORTED
+
+#define SHA512_PBKDF2_LANES 4
+#define SHA256_PBKDF2_LANES 8
+
+/* Run the next iterations PBKDF2-HMAC iterations for SHA512_PBKDF2_LANES/SHA256_PBKDF2_LANES
+   independent output blocks at once. Word i of lane j is stored at index i * lanes + j.
+   inner and outer hold the chaining values after absorbing the padded HMAC key of each lane.
+   uBlock holds the last U_c and block the XOR of U_1 to U_c, and both are updated, so that
+   a derivation can be run in several calls. The avx2 variants may only be called if
+   HasSAVX2() is true, the avx512 variants if HasAVX512F() and HasAVX512VL() are true. */
+void sha512_avx2_pbkdf2 (const uint_64t *inner, const uint_64t *outer, uint_64t *uBlock, uint_64t *block, uint_32t iterations);
+void sha512_avx512_pbkdf2 (const uint_64t *inner, const uint_64t *outer, uint_64t *uBlock, uint_64t *block, uint_32t iterations);
+void sha256_avx2_pbkdf2 (const uint_32t *inner, const uint_32t *outer, uint_32t *uBlock, uint_32t *block, uint_32t iterations);
+void sha256_avx512_pbkdf2 (const uint_32t *inner, const uint_32t *outer, uint_32t *uBlock, uint_32t *block, uint_32t iterations);
+#endif
+
 #if defined(__cplusplus)
 }
 #endif
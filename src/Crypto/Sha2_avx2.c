@@ -0,0 +1,75 @@
+/*
+ Copyright (c) 2013-2018 IDRIX. All rights reserved.
+
+ Governed by the Apache License 2.0 the full text of which is
+ contained in the file License.txt included in VeraCrypt binary and source
+ code distribution packages.
+*/
+
+#include "Sha2.h"
+
+#ifdef SHA2_PBKDF2_LANES_SUPPORTED
+
+#if defined (__AVX2__)
+
+#include <immintrin.h>
+
+#define S64_VEC __m256i
+#define S64_LOAD(p) _mm256_loadu_si256 ((const __m256i *) (p))
+#define S64_STORE(p, a) _mm256_storeu_si256 ((__m256i *) (p), a)
+#define S64_ADD(a, b) _mm256_add_epi64 (a, b)
+#define S64_XOR(a, b) _mm256_xor_si256 (a, b)
+#define S64_XOR3(a, b, c) _mm256_xor_si256 (_mm256_xor_si256 (a, b), c)
+#define S64_ROR(a, n) _mm256_or_si256 (_mm256_srli_epi64 (a, n), _mm256_slli_epi64 (a, 64 - (n)))
+#define S64_SHR(a, n) _mm256_srli_epi64 (a, n)
+#define S64_CH(e, f, g) _mm256_xor_si256 (g, _mm256_and_si256 (e, _mm256_xor_si256 (f, g)))
+#define S64_MAJ(a, b, c) _mm256_or_si256 (_mm256_and_si256 (a, b), _mm256_and_si256 (c, _mm256_or_si256 (a, b)))
+#define S64_SET1(x) _mm256_set1_epi64x ((long long) (x))
+
+#define S32_VEC __m256i
+#define S32_LOAD(p) _mm256_loadu_si256 ((const __m256i *) (p))
+#define S32_STORE(p, a) _mm256_storeu_si256 ((__m256i *) (p), a)
+#define S32_ADD(a, b) _mm256_add_epi32 (a, b)
+#define S32_XOR(a, b) _mm256_xor_si256 (a, b)
+#define S32_XOR3(a, b, c) _mm256_xor_si256 (_mm256_xor_si256 (a, b), c)
+#define S32_ROR(a, n) _mm256_or_si256 (_mm256_srli_epi32 (a, n), _mm256_slli_epi32 (a, 32 - (n)))
+#define S32_SHR(a, n) _mm256_srli_epi32 (a, n)
+#define S32_CH(e, f, g) _mm256_xor_si256 (g, _mm256_and_si256 (e, _mm256_xor_si256 (f, g)))
+#define S32_MAJ(a, b, c) _mm256_or_si256 (_mm256_and_si256 (a, b), _mm256_and_si256 (c, _mm256_or_si256 (a, b)))
+#define S32_SET1(x) _mm256_set1_epi32 ((int) (x))
+
+#include "Sha2_simd.h"
+
+void sha512_avx2_pbkdf2 (const uint_64t *inner, const uint_64t *outer, uint_64t *uBlock, uint_64t *block, uint_32t iterations)
+{
+	sha512_simd_pbkdf2 (inner, outer, uBlock, block, SHA512_PBKDF2_LANES, iterations);
+}
+
+void sha256_avx2_pbkdf2 (const uint_32t *inner, const uint_32t *outer, uint_32t *uBlock, uint_32t *block, uint_32t iterations)
+{
+	sha256_simd_pbkdf2 (inner, outer, uBlock, block, SHA256_PBKDF2_LANES, iterations);
+}
+
+#else // The compiler does not support AVX2
+
+#include "Sha2_simd.h"
+
+void sha512_avx2_pbkdf2 (const uint_64t *inner, const uint_64t *outer, uint_64t *uBlock, uint_64t *block, uint_32t iterations)
+{
+	int lane;
+
+	for (lane = 0; lane < SHA512_PBKDF2_LANES; lane++)
+		sha512_simd_pbkdf2 (inner + lane, outer + lane, uBlock + lane, block + lane, SHA512_PBKDF2_LANES, iterations);
+}
+
+void sha256_avx2_pbkdf2 (const uint_32t *inner, const uint_32t *outer, uint_32t *uBlock, uint_32t *block, uint_32t iterations)
+{
+	int lane;
+
+	for (lane = 0; lane < SHA256_PBKDF2_LANES; lane++)
+		sha256_simd_pbkdf2 (inner + lane, outer + lane, uBlock + lane, block + lane, SHA256_PBKDF2_LANES, iterations);
+}
+
+#endif
+
+#endif // SHA2_PBKDF2_LANES_SUPPORTED
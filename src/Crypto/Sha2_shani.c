@@ -0,0 +1,95 @@
+/*
+ Copyright (c) 2013-2018 IDRIX. All rights reserved.
+
+ Governed by the Apache License 2.0 the full text of which is
+ contained in the file License.txt included in VeraCrypt binary and source
+ code distribution packages.
+*/
+
+#include "Sha2.h"
+
+#ifdef SHA256_SHANI_SUPPORTED
+
+#if defined (__SHA__) && defined (__SSE4_1__)
+
+#include <immintrin.h>
+
+/* Message words W[i..i+3] are kept in m[i & 3]. Each SHA256RNDS2 performs two rounds with
+   the state split into the ABEF and CDGH halves. */
+#define SHA256_SHANI_4ROUNDS(i) \
+	msg = _mm_add_epi32 (m[(i) & 3], _mm_load_si128 ((const __m128i *) (SHA256_K + 4 * (i)))); \
+	state1 = _mm_sha256rnds2_epu32 (state1, state0, msg); \
+	state0 = _mm_sha256rnds2_epu32 (state0, state1, _mm_shuffle_epi32 (msg, 0x0E));
+
+#define SHA256_SHANI_SCHEDULE_4ROUNDS(i) \
+	m[(i) & 3] = _mm_sha256msg2_epu32 (_mm_add_epi32 (_mm_sha256msg1_epu32 (m[(i) & 3], m[((i) + 1) & 3]), \
+		_mm_alignr_epi8 (m[((i) + 3) & 3], m[((i) + 2) & 3], 4)), m[((i) + 3) & 3]); \
+	SHA256_SHANI_4ROUNDS (i)
+
+void sha256_shani (const void *input_data, uint_32t digest[8], uint_64t num_blks)
+{
+	const __m128i byteSwap = _mm_set_epi64x (LL(0x0c0d0e0f08090a0b), LL(0x0405060700010203));
+	const __m128i *data = (const __m128i *) input_data;
+	__m128i state0, state1, abef, cdgh, msg, tmp, m[4];
+
+	/* DCBA, HGFE -> ABEF, CDGH */
+	tmp = _mm_shuffle_epi32 (_mm_loadu_si128 ((const __m128i *) digest), 0xB1);
+	state1 = _mm_shuffle_epi32 (_mm_loadu_si128 ((const __m128i *) (digest + 4)), 0x1B);
+	state0 = _mm_alignr_epi8 (tmp, state1, 8);
+	state1 = _mm_blend_epi16 (state1, tmp, 0xF0);
+
+	while (num_blks-- > 0)
+	{
+		abef = state0;
+		cdgh = state1;
+
+		m[0] = _mm_shuffle_epi8 (_mm_loadu_si128 (data), byteSwap);
+		m[1] = _mm_shuffle_epi8 (_mm_loadu_si128 (data + 1), byteSwap);
+		m[2] = _mm_shuffle_epi8 (_mm_loadu_si128 (data + 2), byteSwap);
+		m[3] = _mm_shuffle_epi8 (_mm_loadu_si128 (data + 3), byteSwap);
+
+		SHA256_SHANI_4ROUNDS (0);
+		SHA256_SHANI_4ROUNDS (1);
+		SHA256_SHANI_4ROUNDS (2);
+		SHA256_SHANI_4ROUNDS (3);
+		SHA256_SHANI_SCHEDULE_4ROUNDS (4);
+		SHA256_SHANI_SCHEDULE_4ROUNDS (5);
+		SHA256_SHANI_SCHEDULE_4ROUNDS (6);
+		SHA256_SHANI_SCHEDULE_4ROUNDS (7);
+		SHA256_SHANI_SCHEDULE_4ROUNDS (8);
+		SHA256_SHANI_SCHEDULE_4ROUNDS (9);
+		SHA256_SHANI_SCHEDULE_4ROUNDS (10);
+		SHA256_SHANI_SCHEDULE_4ROUNDS (11);
+		SHA256_SHANI_SCHEDULE_4ROUNDS (12);
+		SHA256_SHANI_SCHEDULE_4ROUNDS (13);
+		SHA256_SHANI_SCHEDULE_4ROUNDS (14);
+		SHA256_SHANI_SCHEDULE_4ROUNDS (15);
+
+		state0 = _mm_add_epi32 (state0, abef);
+		state1 = _mm_add_epi32 (state1, cdgh);
+		data += 4;
+	}
+
+	/* ABEF, CDGH -> DCBA, HGFE */
+	tmp = _mm_shuffle_epi32 (state0, 0x1B);
+	state1 = _mm_shuffle_epi32 (state1, 0xB1);
+	_mm_storeu_si128 ((__m128i *) digest, _mm_blend_epi16 (tmp, state1, 0xF0));
+	_mm_storeu_si128 ((__m128i *) (digest + 4), _mm_alignr_epi8 (state1, tmp, 8));
+}
+
+#else // The compiler does not support the SHA extensions
+
+void StdSha256Transform (sha256_ctx* ctx, void* mp, uint_64t num_blks);
+
+void sha256_shani (const void *input_data, uint_32t digest[8], uint_64t num_blks)
+{
+	sha256_ctx ctx;
+
+	memcpy (ctx.hash, digest, sizeof (ctx.hash));
+	StdSha256Transform (&ctx, (void *) input_data, num_blks);
+	memcpy (digest, ctx.hash, sizeof (ctx.hash));
+}
+
+#endif
+
+#endif // SHA256_SHANI_SUPPORTED
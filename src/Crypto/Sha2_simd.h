@@ -0,0 +1,176 @@
+/*
+ Copyright (c) 2013-2018 IDRIX. All rights reserved.
+
+ Governed by the Apache License 2.0 the full text of which is
+ contained in the file License.txt included in VeraCrypt binary and source
+ code distribution packages.
+*/
+
+/* PBKDF2-HMAC-SHA-512 and PBKDF2-HMAC-SHA-256 iterations on vectors of 64-bit and 32-bit
+   words, each lane computing an independent output block. Every iteration hashes a single
+   padded block on top of the precomputed inner and outer chaining values, so the message
+   words are built directly from the previous digest. The including file defines the vector
+   primitives S64_VEC, S64_LOAD, S64_STORE, S64_ADD, S64_XOR, S64_XOR3, S64_ROR, S64_SHR,
+   S64_CH, S64_MAJ, S64_SET1 and their 32-bit counterparts S32_*; if it does not, the
+   functions operate on plain words, one lane at a time. */
+
+#ifndef TC_HEADER_Crypto_Sha2_simd
+#define TC_HEADER_Crypto_Sha2_simd
+
+#include "Sha2.h"
+#include "misc.h"
+
+#ifndef S64_VEC
+#define S64_VEC uint_64t
+#define S64_LOAD(p) (*(p))
+#define S64_STORE(p, a) (*(p) = (a))
+#define S64_ADD(a, b) ((a) + (b))
+#define S64_XOR(a, b) ((a) ^ (b))
+#define S64_XOR3(a, b, c) ((a) ^ (b) ^ (c))
+#define S64_ROR(a, n) rotr64 (a, n)
+#define S64_SHR(a, n) ((a) >> (n))
+#define S64_CH(e, f, g) ((g) ^ ((e) & ((f) ^ (g))))
+#define S64_MAJ(a, b, c) (((a) & (b)) | ((c) & ((a) | (b))))
+#define S64_SET1(x) ((uint_64t) (x))
+
+#define S32_VEC uint_32t
+#define S32_LOAD(p) (*(p))
+#define S32_STORE(p, a) (*(p) = (a))
+#define S32_ADD(a, b) ((a) + (b))
+#define S32_XOR(a, b) ((a) ^ (b))
+#define S32_XOR3(a, b, c) ((a) ^ (b) ^ (c))
+#define S32_ROR(a, n) rotr32 (a, n)
+#define S32_SHR(a, n) ((a) >> (n))
+#define S32_CH(e, f, g) ((g) ^ ((e) & ((f) ^ (g))))
+#define S32_MAJ(a, b, c) (((a) & (b)) | ((c) & ((a) | (b))))
+#define S32_SET1(x) ((uint_32t) (x))
+#endif
+
+#define SHA2_SIMD_ROUND(T, a, b, c, d, e, f, g, h, k, w) \
+	t = T##_ADD (T##_ADD (h, SUM1 (e)), T##_ADD (T##_CH (e, f, g), T##_ADD (T##_SET1 (k), w))); \
+	d = T##_ADD (d, t); \
+	h = T##_ADD (t, T##_ADD (SUM0 (a), T##_MAJ (a, b, c)));
+
+#define SHA2_SIMD_8ROUNDS(T, K, i) \
+	SHA2_SIMD_ROUND (T, a, b, c, d, e, f, g, h, K[(i) + 0], w[((i) + 0) & 15]) \
+	SHA2_SIMD_ROUND (T, h, a, b, c, d, e, f, g, K[(i) + 1], w[((i) + 1) & 15]) \
+	SHA2_SIMD_ROUND (T, g, h, a, b, c, d, e, f, K[(i) + 2], w[((i) + 2) & 15]) \
+	SHA2_SIMD_ROUND (T, f, g, h, a, b, c, d, e, K[(i) + 3], w[((i) + 3) & 15]) \
+	SHA2_SIMD_ROUND (T, e, f, g, h, a, b, c, d, K[(i) + 4], w[((i) + 4) & 15]) \
+	SHA2_SIMD_ROUND (T, d, e, f, g, h, a, b, c, K[(i) + 5], w[((i) + 5) & 15]) \
+	SHA2_SIMD_ROUND (T, c, d, e, f, g, h, a, b, K[(i) + 6], w[((i) + 6) & 15]) \
+	SHA2_SIMD_ROUND (T, b, c, d, e, f, g, h, a, K[(i) + 7], w[((i) + 7) & 15])
+
+/* Updates the chaining values s with the message block w. The message schedule is expanded
+   in place, 16 words at a time. */
+#define SHA2_SIMD_COMPRESS(T, K, ROUNDS) \
+	T##_VEC a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7], t; \
+	int i, j; \
+	\
+	for (i = 0; i < (ROUNDS); i += 16) \
+	{ \
+		if (i > 0) \
+		{ \
+			for (j = 0; j < 16; j++) \
+				w[j] = T##_ADD (T##_ADD (w[j], SIGMA1 (w[(j + 14) & 15])), T##_ADD (w[(j + 9) & 15], SIGMA0 (w[(j + 1) & 15]))); \
+		} \
+		\
+		SHA2_SIMD_8ROUNDS (T, K, i); \
+		SHA2_SIMD_8ROUNDS (T, K, i + 8); \
+	} \
+	\
+	s[0] = T##_ADD (s[0], a); \
+	s[1] = T##_ADD (s[1], b); \
+	s[2] = T##_ADD (s[2], c); \
+	s[3] = T##_ADD (s[3], d); \
+	s[4] = T##_ADD (s[4], e); \
+	s[5] = T##_ADD (s[5], f); \
+	s[6] = T##_ADD (s[6], g); \
+	s[7] = T##_ADD (s[7], h);
+
+/* The message hashed by each compression is the 8-word digest of the previous step, followed
+   by the padding of a message of one key block plus one digest. */
+#define SHA2_SIMD_MESSAGE(T, digest, padding, bitLength) \
+	for (i = 0; i < 8; i++) \
+		w[i] = digest[i]; \
+	\
+	w[8] = T##_SET1 (padding); \
+	for (i = 9; i < 15; i++) \
+		w[i] = T##_SET1 (0); \
+	w[15] = T##_SET1 (bitLength);
+
+#define SHA2_SIMD_PBKDF2(T, COMPRESS, padding, bitLength) \
+	T##_VEC u[8], dk[8], s[8], w[16]; \
+	uint_32t c; \
+	int i; \
+	\
+	for (i = 0; i < 8; i++) \
+	{ \
+		u[i] = T##_LOAD (uBlock + i * stride); \
+		dk[i] = T##_LOAD (block + i * stride); \
+	} \
+	\
+	for (c = 0; c < iterations; c++) \
+	{ \
+		SHA2_SIMD_MESSAGE (T, u, padding, bitLength); \
+		for (i = 0; i < 8; i++) \
+			s[i] = T##_LOAD (inner + i * stride); \
+		COMPRESS (s, w); \
+		\
+		SHA2_SIMD_MESSAGE (T, s, padding, bitLength); \
+		for (i = 0; i < 8; i++) \
+			u[i] = T##_LOAD (outer + i * stride); \
+		COMPRESS (u, w); \
+		\
+		for (i = 0; i < 8; i++) \
+			dk[i] = T##_XOR (dk[i], u[i]); \
+	} \
+	\
+	for (i = 0; i < 8; i++) \
+	{ \
+		T##_STORE (uBlock + i * stride, u[i]); \
+		T##_STORE (block + i * stride, dk[i]); \
+	}
+
+#define SUM0(x) S64_XOR3 (S64_ROR (x, 28), S64_ROR (x, 34), S64_ROR (x, 39))
+#define SUM1(x) S64_XOR3 (S64_ROR (x, 14), S64_ROR (x, 18), S64_ROR (x, 41))
+#define SIGMA0(x) S64_XOR3 (S64_ROR (x, 1), S64_ROR (x, 8), S64_SHR (x, 7))
+#define SIGMA1(x) S64_XOR3 (S64_ROR (x, 19), S64_ROR (x, 61), S64_SHR (x, 6))
+
+VC_INLINE void sha512_simd_compress (S64_VEC s[8], S64_VEC w[16])
+{
+	SHA2_SIMD_COMPRESS (S64, SHA512_K, 80);
+}
+
+/* Word i of the lanes to process starts at index i * stride of inner, outer and block */
+VC_INLINE void sha512_simd_pbkdf2 (const uint_64t *inner, const uint_64t *outer, uint_64t *uBlock, uint_64t *block, size_t stride, uint_32t iterations)
+{
+	SHA2_SIMD_PBKDF2 (S64, sha512_simd_compress, LL(0x8000000000000000), (SHA512_BLOCK_SIZE + SHA512_DIGEST_SIZE) * 8);
+}
+
+#undef SUM0
+#undef SUM1
+#undef SIGMA0
+#undef SIGMA1
+
+#define SUM0(x) S32_XOR3 (S32_ROR (x, 2), S32_ROR (x, 13), S32_ROR (x, 22))
+#define SUM1(x) S32_XOR3 (S32_ROR (x, 6), S32_ROR (x, 11), S32_ROR (x, 25))
+#define SIGMA0(x) S32_XOR3 (S32_ROR (x, 7), S32_ROR (x, 18), S32_SHR (x, 3))
+#define SIGMA1(x) S32_XOR3 (S32_ROR (x, 17), S32_ROR (x, 19), S32_SHR (x, 10))
+
+VC_INLINE void sha256_simd_compress (S32_VEC s[8], S32_VEC w[16])
+{
+	SHA2_SIMD_COMPRESS (S32, SHA256_K, 64);
+}
+
+VC_INLINE void sha256_simd_pbkdf2 (const uint_32t *inner, const uint_32t *outer, uint_32t *uBlock, uint_32t *block, size_t stride, uint_32t iterations)
+{
+	SHA2_SIMD_PBKDF2 (S32, sha256_simd_compress, 0x80000000, (SHA256_BLOCK_SIZE + SHA256_DIGEST_SIZE) * 8);
+}
+
+#undef SUM0
+#undef SUM1
+#undef SIGMA0
+#undef SIGMA1
+
+#endif // TC_HEADER_Crypto_Sha2_simd
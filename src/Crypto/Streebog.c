@@ -2132,6 +2132,11 @@ VC_INLINE __m128i _mm_set_epi64x_a(uint64 i0, uint64 i1) {
 static void
 g(unsigned long long *h, const unsigned long long *N, const unsigned char *m)
 {
+#ifdef STREEBOG_AVX512_SUPPORTED
+	if (HasAVX512F() && HasAVX512BW() && HasAVX512VBMI() && HasGFNI() && streebog_has_avx512())
+		streebog_g_avx512(h, N, m, C);
+	else
+#endif
 #if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE
 #if CRYPTOPP_BOOL_SSE41_INTRINSICS_AVAILABLE
 	if (HasSSE41()) {
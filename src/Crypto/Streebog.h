@@ -34,6 +34,13 @@ void STREEBOG_init256(STREEBOG_CTX *ctx);
 void STREEBOG_add(STREEBOG_CTX *ctx, const byte *msg, size_t len);
 void STREEBOG_finalize(STREEBOG_CTX *ctx, byte *out);
 
+#if defined (TC_UNIX) && CRYPTOPP_BOOL_X64 && !defined (CRYPTOPP_DISABLE_ASM)
+#define STREEBOG_AVX512_SUPPORTED
+/* Compression function using AVX-512 VBMI and GFNI, available when streebog_has_avx512 returns 1 */
+int streebog_has_avx512 ();
+void streebog_g_avx512 (unsigned long long *h, const unsigned long long *N, const unsigned char *m, const unsigned long long roundConstants[12][8]);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
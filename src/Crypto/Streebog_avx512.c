@@ -0,0 +1,125 @@
+/*
+ Copyright (c) 2013-2018 IDRIX. All rights reserved.
+
+ Governed by the Apache License 2.0 the full text of which is
+ contained in the file License.txt included in VeraCrypt binary and source
+ code distribution packages.
+*/
+
+/* Streebog compression function using AVX-512 VBMI and GFNI. The 512-bit state is kept in one
+   ZMM register in transposed form: quadword k holds byte k of the eight state words. The S
+   transformation is a byte substitution with VPERMI2B. P followed by L maps byte i of the input
+   words to word i of the output, and byte k of each output word is a sum of GF(2) linear
+   functions A(k, j) of byte i of the input words j. Broadcasting input word j to all quadwords
+   with VPERMB and evaluating A(k, j) in quadword k with GF2P8AFFINEQB therefore yields the
+   output directly in transposed form. */
+
+#include "Streebog.h"
+
+#ifdef STREEBOG_AVX512_SUPPORTED
+
+#if defined (__AVX512F__) && defined (__AVX512BW__) && defined (__AVX512VBMI__) && defined (__GFNI__)
+
+#include <immintrin.h>
+
+/* Defined in kuznyechik_simd.c: Streebog uses the same S-box as Kuznyechik */
+extern const uint_8t Pi[256];
+
+/* Quadword k of entry j is the GF2P8AFFINEQB matrix of A(k, j), derived from the precomputed
+   tables Ax of Streebog.c */
+CRYPTOPP_ALIGN_DATA(64) static const uint_64t streebogAffineMatrices[8][8] CRYPTOPP_SECTION_ALIGN16 = {
+	{ LL(0x63c7ecba162c58b1), LL(0xae5c1682aa55ab57), LL(0x0205091120408001), LL(0x29538e3542850a14), LL(0x65cbf28166cc9932), LL(0x9932fc6059b366cc), LL(0x70e0b11357ae5cb8), LL(0x0c183d76e0c18306) },
+	{ LL(0x3060f0d193264c98), LL(0x56ac0f49c58a152b), LL(0xfffe03f80f1f3f7f), LL(0x122559a151a24489), LL(0x254bb343a2448912), LL(0x050b132240800102), LL(0x43874cdbf4e8d0a1), LL(0x2a54832c72e5ca95) },
+	{ LL(0xa85008b9dab56ad4), LL(0x9d3beb4a0913274e), LL(0x18317aecc183060c), LL(0x428548d3e4c89021), LL(0x172e4a831122458b), LL(0x2245a970c2840811), LL(0x3d7ac9af63c78f1e), LL(0x9f3ee25b2953a74f) },
+	{ LL(0x122559a151a24489), LL(0x4a94628f54a952a5), LL(0x102050b071e2c488), LL(0x3060f0d193264c98), LL(0x0d1a397ef0e1c386), LL(0x82048b95a850a041), LL(0xc081c3464c983060), LL(0x75eba231172e5dba) },
+	{ LL(0xb8705809ab57ae5c), LL(0x274eba5282040913), LL(0x73e7bc0a67ce9c39), LL(0xdab5b0bbad5bb66d), LL(0x82048b95a850a041), LL(0x0d1a397ef0e1c386), LL(0x8912acd02851a244), LL(0x8103868c983060c0) },
+	{ LL(0xd4a884dc6ddab56a), LL(0xc386ce5f7cf8f0e1), LL(0x428548d3e4c89021), LL(0x18317aecc183060c), LL(0x4b96668744891225), LL(0x9224db25d9b264c9), LL(0x468c5ff9b468d1a3), LL(0x0a14234d90214285) },
+	{ LL(0x0205091120408001), LL(0xd2a49ae71d3a74e9), LL(0x63c7ecba162c58b1), LL(0xb06172551b366cd8), LL(0x0102040810204080), LL(0xe1c3672fbe7cf8f0), LL(0xba7551188b172e5d), LL(0x0409172a50a04182) },
+	{ LL(0x0c183d76e0c18306), LL(0x2347ad78d2a44891), LL(0x0409172a50a04182), LL(0xfaf510da4f9f3e7d), LL(0xc183c74e5cb870e0), LL(0x43874cdbf4e8d0a1), LL(0x050b132240800102), LL(0x63c7ecba162c58b1) }
+};
+
+/* Byte index 8 * k + i of the transposed state holds byte k of word i */
+#define TRANSPOSE(v) _mm512_permutexvar_epi8 (transpose, v)
+
+/* Word j of the transposed state, broadcast to all quadwords */
+#define BROADCAST_WORD(v, j) _mm512_permutexvar_epi8 (_mm512_or_si512 (wordBytes, _mm512_set1_epi8 (j)), v)
+
+#define LINEAR_TERM(v, j) \
+	_mm512_gf2p8affine_epi64_epi8 (BROADCAST_WORD (v, j), _mm512_load_si512 ((const __m512i *) streebogAffineMatrices[j]), 0)
+
+/* VPERMI2B indexes 128 bytes of the table with the low seven bits of each byte; the high bit
+   selects between the two halves of the table */
+#define XLPS(x, y) \
+	{ \
+		__m512i v = _mm512_xor_si512 (x, y); \
+		v = _mm512_mask_blend_epi8 (_mm512_movepi8_mask (v), \
+			_mm512_permutex2var_epi8 (sbox[0], v, sbox[1]), \
+			_mm512_permutex2var_epi8 (sbox[2], v, sbox[3])); \
+		\
+		y = _mm512_xor_si512 ( \
+			_mm512_ternarylogic_epi64 (LINEAR_TERM (v, 0), LINEAR_TERM (v, 1), LINEAR_TERM (v, 2), 0x96), \
+			_mm512_ternarylogic_epi64 ( \
+				_mm512_ternarylogic_epi64 (LINEAR_TERM (v, 3), LINEAR_TERM (v, 4), LINEAR_TERM (v, 5), 0x96), \
+				LINEAR_TERM (v, 6), LINEAR_TERM (v, 7), 0x96)); \
+	}
+
+int streebog_has_avx512 ()
+{
+	return 1;
+}
+
+void streebog_g_avx512 (unsigned long long *h, const unsigned long long *N, const unsigned char *m, const unsigned long long roundConstants[12][8])
+{
+	const __m512i transpose = _mm512_set_epi8 (
+		63, 55, 47, 39, 31, 23, 15, 7, 62, 54, 46, 38, 30, 22, 14, 6,
+		61, 53, 45, 37, 29, 21, 13, 5, 60, 52, 44, 36, 28, 20, 12, 4,
+		59, 51, 43, 35, 27, 19, 11, 3, 58, 50, 42, 34, 26, 18, 10, 2,
+		57, 49, 41, 33, 25, 17, 9, 1, 56, 48, 40, 32, 24, 16, 8, 0);
+	const __m512i wordBytes = _mm512_and_si512 (transpose, _mm512_set1_epi8 (0x38));
+	__m512i sbox[4], hv, mv, key, state;
+	int i;
+
+	sbox[0] = _mm512_loadu_si512 ((const __m512i *) Pi);
+	sbox[1] = _mm512_loadu_si512 ((const __m512i *) Pi + 1);
+	sbox[2] = _mm512_loadu_si512 ((const __m512i *) Pi + 2);
+	sbox[3] = _mm512_loadu_si512 ((const __m512i *) Pi + 3);
+
+	hv = _mm512_loadu_si512 ((const __m512i *) h);
+	mv = _mm512_loadu_si512 ((const __m512i *) m);
+
+	/* K = LPS (h ^ N) */
+	key = TRANSPOSE (_mm512_loadu_si512 ((const __m512i *) N));
+	XLPS (TRANSPOSE (hv), key);
+
+	/* E (K, m) */
+	state = TRANSPOSE (mv);
+	XLPS (key, state);
+
+	for (i = 0; i < 11; i++)
+	{
+		XLPS (TRANSPOSE (_mm512_loadu_si512 ((const __m512i *) roundConstants[i])), key);
+		XLPS (key, state);
+	}
+
+	XLPS (TRANSPOSE (_mm512_loadu_si512 ((const __m512i *) roundConstants[11])), key);
+	state = _mm512_xor_si512 (state, key);
+
+	/* h = E (K, m) ^ h ^ m */
+	_mm512_storeu_si512 ((__m512i *) h, _mm512_ternarylogic_epi64 (TRANSPOSE (state), hv, mv, 0x96));
+}
+
+#else // The compiler does not support AVX-512 VBMI and GFNI
+
+int streebog_has_avx512 ()
+{
+	return 0;
+}
+
+void streebog_g_avx512 (unsigned long long *h, const unsigned long long *N, const unsigned char *m, const unsigned long long roundConstants[12][8])
+{
+	/* Never called since streebog_has_avx512 returns 0 */
+}
+
+#endif
+
+#endif // STREEBOG_AVX512_SUPPORTED
@@ -89,7 +89,7 @@ void twofish_encrypt_blocks(TwofishInstance *instance, const byte* in_blk, byte*
 	{
 		twofish_enc_blk2 (instance, out_blk, in_blk);
 	}
-	else
+	else if (blockCount == 1)
 	{
 		twofish_enc_blk (instance, out_blk, in_blk);
 	}
@@ -110,7 +110,7 @@ void twofish_decrypt_blocks(TwofishInstance *instance, const byte* in_blk, byte*
 	{
 		twofish_dec_blk2 (instance, out_blk, in_blk);
 	}
-	else
+	else if (blockCount == 1)
 	{
 		twofish_dec_blk (instance, out_blk, in_blk);
 	}
@@ -1102,6 +1102,127 @@ void twofish_decrypt(TwofishInstance *ks, const u4byte in_blk[4], u4byte out_blk
 	out_blk[2] = x0;
 	out_blk[3] = x1;
 };
+
+/* Two blocks are interleaved so that their independent table lookups overlap */
+
+#define ROUNDT2(x0, x1, y0, y1, r) \
+	f0 = ks->mk_tab[0][x0 & 0xFF] ^ ks->mk_tab[1][(x0 >> 8) & 0xFF] ^ ks->mk_tab[2][(x0 >> 16) & 0xFF] ^ ks->mk_tab[3][(x0 >> 24) & 0xFF]; \
+	g0 = ks->mk_tab[0][y0 & 0xFF] ^ ks->mk_tab[1][(y0 >> 8) & 0xFF] ^ ks->mk_tab[2][(y0 >> 16) & 0xFF] ^ ks->mk_tab[3][(y0 >> 24) & 0xFF]; \
+	f1 = ks->mk_tab[0][(x1 >> 24) & 0xFF] ^ ks->mk_tab[1][x1 & 0xFF] ^ ks->mk_tab[2][(x1 >> 8) & 0xFF] ^ ks->mk_tab[3][(x1 >> 16) & 0xFF]; \
+	g1 = ks->mk_tab[0][(y1 >> 24) & 0xFF] ^ ks->mk_tab[1][y1 & 0xFF] ^ ks->mk_tab[2][(y1 >> 8) & 0xFF] ^ ks->mk_tab[3][(y1 >> 16) & 0xFF]; \
+	f0 += f1; \
+	g0 += g1; \
+	f1 += f0 + rk[2 * (r) + 9]; \
+	g1 += g0 + rk[2 * (r) + 9]; \
+	f0 += rk[2 * (r) + 8]; \
+	g0 += rk[2 * (r) + 8];
+
+#define ROUNDA2(r) \
+	ROUNDT2(x0, x1, y0, y1, r) \
+	x2 = rotr32(x2 ^ f0, 1); \
+	y2 = rotr32(y2 ^ g0, 1); \
+	x3 = rotl32(x3, 1) ^ f1; \
+	y3 = rotl32(y3, 1) ^ g1;
+
+#define ROUNDB2(r) \
+	ROUNDT2(x2, x3, y2, y3, r) \
+	x0 = rotr32(x0 ^ f0, 1); \
+	y0 = rotr32(y0 ^ g0, 1); \
+	x1 = rotl32(x1, 1) ^ f1; \
+	y1 = rotl32(y1, 1) ^ g1;
+
+#define RROUNDA2(r) \
+	ROUNDT2(x0, x1, y0, y1, r) \
+	x2 = rotl32(x2, 1) ^ f0; \
+	y2 = rotl32(y2, 1) ^ g0; \
+	x3 = rotr32(x3 ^ f1, 1); \
+	y3 = rotr32(y3 ^ g1, 1);
+
+#define RROUNDB2(r) \
+	ROUNDT2(x2, x3, y2, y3, r) \
+	x0 = rotl32(x0, 1) ^ f0; \
+	y0 = rotl32(y0, 1) ^ g0; \
+	x1 = rotr32(x1 ^ f1, 1); \
+	y1 = rotr32(y1 ^ g1, 1);
+
+void twofish_encrypt_blocks(TwofishInstance *ks, const byte* in_blk, byte* out_blk, uint32 blockCount)
+{
+	uint32* rk = ks->l_key;
+
+	while (blockCount >= 2)
+	{
+		const u4byte* in = (const u4byte*) in_blk;
+		u4byte* out = (u4byte*) out_blk;
+		uint32 x0 = in[0] ^ rk[0], y0 = in[4] ^ rk[0];
+		uint32 x1 = in[1] ^ rk[1], y1 = in[5] ^ rk[1];
+		uint32 x2 = in[2] ^ rk[2], y2 = in[6] ^ rk[2];
+		uint32 x3 = in[3] ^ rk[3], y3 = in[7] ^ rk[3];
+		uint32 f0, f1, g0, g1;
+
+#ifdef UNROLL_TWOFISH
+		ROUNDA2(0); ROUNDB2(1); ROUNDA2(2); ROUNDB2(3); ROUNDA2(4); ROUNDB2(5); ROUNDA2(6); ROUNDB2(7); ROUNDA2(8); ROUNDB2(9); ROUNDA2(10); ROUNDB2(11); ROUNDA2(12); ROUNDB2(13); ROUNDA2(14); ROUNDB2(15);
+#else
+		size_t j;
+		for (j = 0; j != 16; j += 2)
+		{
+			ROUNDA2 (j);
+			ROUNDB2 (j + 1);
+		}
+#endif
+
+		out[0] = x2 ^ rk[4]; out[4] = y2 ^ rk[4];
+		out[1] = x3 ^ rk[5]; out[5] = y3 ^ rk[5];
+		out[2] = x0 ^ rk[6]; out[6] = y0 ^ rk[6];
+		out[3] = x1 ^ rk[7]; out[7] = y1 ^ rk[7];
+
+		in_blk += 2 * 16;
+		out_blk += 2 * 16;
+		blockCount -= 2;
+	}
+
+	if (blockCount)
+		twofish_encrypt (ks, (const u4byte*) in_blk, (u4byte*) out_blk);
+}
+
+void twofish_decrypt_blocks(TwofishInstance *ks, const byte* in_blk, byte* out_blk, uint32 blockCount)
+{
+	uint32* rk = ks->l_key;
+
+	while (blockCount >= 2)
+	{
+		const u4byte* in = (const u4byte*) in_blk;
+		u4byte* out = (u4byte*) out_blk;
+		uint32 x0 = in[0] ^ rk[4], y0 = in[4] ^ rk[4];
+		uint32 x1 = in[1] ^ rk[5], y1 = in[5] ^ rk[5];
+		uint32 x2 = in[2] ^ rk[6], y2 = in[6] ^ rk[6];
+		uint32 x3 = in[3] ^ rk[7], y3 = in[7] ^ rk[7];
+		uint32 f0, f1, g0, g1;
+
+#ifdef UNROLL_TWOFISH
+		RROUNDA2(15); RROUNDB2(14); RROUNDA2(13); RROUNDB2(12); RROUNDA2(11); RROUNDB2(10); RROUNDA2(9); RROUNDB2(8); RROUNDA2(7); RROUNDB2(6); RROUNDA2(5); RROUNDB2(4); RROUNDA2(3); RROUNDB2(2); RROUNDA2(1); RROUNDB2(0);
+#else
+		int j;
+		for (j = 15; j != -1; j -= 2)
+		{
+			RROUNDA2 (j);
+			RROUNDB2 (j - 1);
+		}
+#endif
+
+		out[0] = x2 ^ rk[0]; out[4] = y2 ^ rk[0];
+		out[1] = x3 ^ rk[1]; out[5] = y3 ^ rk[1];
+		out[2] = x0 ^ rk[2]; out[6] = y0 ^ rk[2];
+		out[3] = x1 ^ rk[3]; out[7] = y1 ^ rk[3];
+
+		in_blk += 2 * 16;
+		out_blk += 2 * 16;
+		blockCount -= 2;
+	}
+
+	if (blockCount)
+		twofish_decrypt (ks, (const u4byte*) in_blk, (u4byte*) out_blk);
+}
+
 #endif
 #else // TC_MINIMIZE_CODE_SIZE
 
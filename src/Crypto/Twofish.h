@@ -62,6 +62,20 @@ void twofish_decrypt_blocks(TwofishInstance *instance, const byte* in_blk, byte*
 #else
 void twofish_encrypt(TwofishInstance *instance, const u4byte in_blk[4], u4byte out_blk[4]);
 void twofish_decrypt(TwofishInstance *instance, const u4byte in_blk[4], u4byte out_blk[4]);
+#ifndef TC_MINIMIZE_CODE_SIZE
+void twofish_encrypt_blocks(TwofishInstance *instance, const byte* in_blk, byte* out_blk, uint32 blockCount);
+void twofish_decrypt_blocks(TwofishInstance *instance, const byte* in_blk, byte* out_blk, uint32 blockCount);
+#endif
+#endif
+
+#ifndef TC_MINIMIZE_CODE_SIZE
+/* Process 8 (AVX2) or 16 (AVX-512) blocks at once using table gathers. The AVX2 variants may
+   only be called if HasSAVX2() is true, the AVX-512 variants if HasAVX512F(), HasAVX512BW()
+   and HasAVX512VL() are true. */
+void twofish_avx2_encrypt_blocks(TwofishInstance *instance, const byte* in_blk, byte* out_blk, size_t blockCount);
+void twofish_avx2_decrypt_blocks(TwofishInstance *instance, const byte* in_blk, byte* out_blk, size_t blockCount);
+void twofish_avx512_encrypt_blocks(TwofishInstance *instance, const byte* in_blk, byte* out_blk, size_t blockCount);
+void twofish_avx512_decrypt_blocks(TwofishInstance *instance, const byte* in_blk, byte* out_blk, size_t blockCount);
 #endif
 
 #if defined(__cplusplus)
@@ -0,0 +1,98 @@
+/*
+ Copyright (c) 2013-2018 IDRIX. All rights reserved.
+
+ Governed by the Apache License 2.0 the full text of which is
+ contained in the file License.txt included in VeraCrypt binary and source
+ code distribution packages.
+*/
+
+#include "Twofish.h"
+
+#if defined (__AVX2__)
+
+#include <immintrin.h>
+
+#define TF_VEC __m256i
+#define TF_XOR(a, b) _mm256_xor_si256 (a, b)
+#define TF_ADD(a, b) _mm256_add_epi32 (a, b)
+#define TF_AND(a, b) _mm256_and_si256 (a, b)
+#define TF_SRLI(a, n) _mm256_srli_epi32 (a, n)
+#define TF_ROTL(a, n) _mm256_or_si256 (_mm256_slli_epi32 (a, n), _mm256_srli_epi32 (a, 32 - (n)))
+#define TF_ROTR(a, n) _mm256_or_si256 (_mm256_srli_epi32 (a, n), _mm256_slli_epi32 (a, 32 - (n)))
+#define TF_SET1(x) _mm256_set1_epi32 ((int) (x))
+#define TF_GATHER(table, indices) _mm256_i32gather_epi32 ((const int *) (table), indices, 4)
+
+#include "Twofish_simd.h"
+
+#define TWOFISH_AVX2_PARALLEL_BLOCKS 8
+
+/* Transposes the words of the four blocks in each 128-bit lane of a..d, so that a holds
+   the first words, b the second words, and so on. The transposition is its own inverse. */
+#define TWOFISH_AVX2_TRANSPOSE(a, b, c, d) \
+	{ \
+		TF_VEC t0 = _mm256_unpacklo_epi32 (a, b); \
+		TF_VEC t1 = _mm256_unpackhi_epi32 (a, b); \
+		TF_VEC t2 = _mm256_unpacklo_epi32 (c, d); \
+		TF_VEC t3 = _mm256_unpackhi_epi32 (c, d); \
+		a = _mm256_unpacklo_epi64 (t0, t2); \
+		b = _mm256_unpackhi_epi64 (t0, t2); \
+		c = _mm256_unpacklo_epi64 (t1, t3); \
+		d = _mm256_unpackhi_epi64 (t1, t3); \
+	}
+
+#define TWOFISH_AVX2_BLOCKS(CRYPT, BLOCKS_FUNCTION) \
+	const uint32 *rk = TWOFISH_SIMD_ROUND_KEYS (instance); \
+	const u4byte (*mk_tab)[256] = instance->mk_tab; \
+	const TF_VEC byteMask = _mm256_set1_epi32 (0xFF); \
+	TF_VEC x0, x1, x2, x3, f0, f1; \
+	int r; \
+	\
+	while (blockCount >= TWOFISH_AVX2_PARALLEL_BLOCKS) \
+	{ \
+		x0 = _mm256_loadu_si256 ((const __m256i *) in_blk); \
+		x1 = _mm256_loadu_si256 ((const __m256i *) in_blk + 1); \
+		x2 = _mm256_loadu_si256 ((const __m256i *) in_blk + 2); \
+		x3 = _mm256_loadu_si256 ((const __m256i *) in_blk + 3); \
+		TWOFISH_AVX2_TRANSPOSE (x0, x1, x2, x3); \
+		\
+		CRYPT(); \
+		\
+		TWOFISH_AVX2_TRANSPOSE (x2, x3, x0, x1); \
+		_mm256_storeu_si256 ((__m256i *) out_blk, x2); \
+		_mm256_storeu_si256 ((__m256i *) out_blk + 1, x3); \
+		_mm256_storeu_si256 ((__m256i *) out_blk + 2, x0); \
+		_mm256_storeu_si256 ((__m256i *) out_blk + 3, x1); \
+		\
+		in_blk += TWOFISH_AVX2_PARALLEL_BLOCKS * 16; \
+		out_blk += TWOFISH_AVX2_PARALLEL_BLOCKS * 16; \
+		blockCount -= TWOFISH_AVX2_PARALLEL_BLOCKS; \
+	} \
+	\
+	if (blockCount > 0) \
+		BLOCKS_FUNCTION (instance, in_blk, out_blk, (uint32) blockCount);
+
+void twofish_avx2_encrypt_blocks (TwofishInstance *instance, const byte *in_blk, byte *out_blk, size_t blockCount)
+{
+	TWOFISH_AVX2_BLOCKS (TWOFISH_SIMD_ENCRYPT, twofish_encrypt_blocks);
+}
+
+void twofish_avx2_decrypt_blocks (TwofishInstance *instance, const byte *in_blk, byte *out_blk, size_t blockCount)
+{
+	TWOFISH_AVX2_BLOCKS (TWOFISH_SIMD_DECRYPT, twofish_decrypt_blocks);
+}
+
+#else // The compiler does not support AVX2
+
+void twofish_avx2_encrypt_blocks (TwofishInstance *instance, const byte *in_blk, byte *out_blk, size_t blockCount)
+{
+	if (blockCount > 0)
+		twofish_encrypt_blocks (instance, in_blk, out_blk, (uint32) blockCount);
+}
+
+void twofish_avx2_decrypt_blocks (TwofishInstance *instance, const byte *in_blk, byte *out_blk, size_t blockCount)
+{
+	if (blockCount > 0)
+		twofish_decrypt_blocks (instance, in_blk, out_blk, (uint32) blockCount);
+}
+
+#endif
@@ -0,0 +1,98 @@
+/*
+ Copyright (c) 2013-2018 IDRIX. All rights reserved.
+
+ Governed by the Apache License 2.0 the full text of which is
+ contained in the file License.txt included in VeraCrypt binary and source
+ code distribution packages.
+*/
+
+#include "Twofish.h"
+
+#if defined (__AVX512F__)
+
+#include <immintrin.h>
+
+#define TF_VEC __m512i
+#define TF_XOR(a, b) _mm512_xor_si512 (a, b)
+#define TF_ADD(a, b) _mm512_add_epi32 (a, b)
+#define TF_AND(a, b) _mm512_and_si512 (a, b)
+#define TF_SRLI(a, n) _mm512_srli_epi32 (a, n)
+#define TF_ROTL(a, n) _mm512_rol_epi32 (a, n)
+#define TF_ROTR(a, n) _mm512_ror_epi32 (a, n)
+#define TF_SET1(x) _mm512_set1_epi32 ((int) (x))
+#define TF_GATHER(table, indices) _mm512_i32gather_epi32 (indices, (const int *) (table), 4)
+
+#include "Twofish_simd.h"
+
+#define TWOFISH_AVX512_PARALLEL_BLOCKS 16
+
+/* Transposes the words of the four blocks in each 128-bit lane of a..d, so that a holds
+   the first words, b the second words, and so on. The transposition is its own inverse. */
+#define TWOFISH_AVX512_TRANSPOSE(a, b, c, d) \
+	{ \
+		TF_VEC t0 = _mm512_unpacklo_epi32 (a, b); \
+		TF_VEC t1 = _mm512_unpackhi_epi32 (a, b); \
+		TF_VEC t2 = _mm512_unpacklo_epi32 (c, d); \
+		TF_VEC t3 = _mm512_unpackhi_epi32 (c, d); \
+		a = _mm512_unpacklo_epi64 (t0, t2); \
+		b = _mm512_unpackhi_epi64 (t0, t2); \
+		c = _mm512_unpacklo_epi64 (t1, t3); \
+		d = _mm512_unpackhi_epi64 (t1, t3); \
+	}
+
+#define TWOFISH_AVX512_BLOCKS(CRYPT, BLOCKS_FUNCTION) \
+	const uint32 *rk = TWOFISH_SIMD_ROUND_KEYS (instance); \
+	const u4byte (*mk_tab)[256] = instance->mk_tab; \
+	const TF_VEC byteMask = _mm512_set1_epi32 (0xFF); \
+	TF_VEC x0, x1, x2, x3, f0, f1; \
+	int r; \
+	\
+	while (blockCount >= TWOFISH_AVX512_PARALLEL_BLOCKS) \
+	{ \
+		x0 = _mm512_loadu_si512 ((const __m512i *) in_blk); \
+		x1 = _mm512_loadu_si512 ((const __m512i *) in_blk + 1); \
+		x2 = _mm512_loadu_si512 ((const __m512i *) in_blk + 2); \
+		x3 = _mm512_loadu_si512 ((const __m512i *) in_blk + 3); \
+		TWOFISH_AVX512_TRANSPOSE (x0, x1, x2, x3); \
+		\
+		CRYPT(); \
+		\
+		TWOFISH_AVX512_TRANSPOSE (x2, x3, x0, x1); \
+		_mm512_storeu_si512 ((__m512i *) out_blk, x2); \
+		_mm512_storeu_si512 ((__m512i *) out_blk + 1, x3); \
+		_mm512_storeu_si512 ((__m512i *) out_blk + 2, x0); \
+		_mm512_storeu_si512 ((__m512i *) out_blk + 3, x1); \
+		\
+		in_blk += TWOFISH_AVX512_PARALLEL_BLOCKS * 16; \
+		out_blk += TWOFISH_AVX512_PARALLEL_BLOCKS * 16; \
+		blockCount -= TWOFISH_AVX512_PARALLEL_BLOCKS; \
+	} \
+	\
+	if (blockCount > 0) \
+		BLOCKS_FUNCTION (instance, in_blk, out_blk, (uint32) blockCount);
+
+void twofish_avx512_encrypt_blocks (TwofishInstance *instance, const byte *in_blk, byte *out_blk, size_t blockCount)
+{
+	TWOFISH_AVX512_BLOCKS (TWOFISH_SIMD_ENCRYPT, twofish_encrypt_blocks);
+}
+
+void twofish_avx512_decrypt_blocks (TwofishInstance *instance, const byte *in_blk, byte *out_blk, size_t blockCount)
+{
+	TWOFISH_AVX512_BLOCKS (TWOFISH_SIMD_DECRYPT, twofish_decrypt_blocks);
+}
+
+#else // The compiler does not support AVX-512
+
+void twofish_avx512_encrypt_blocks (TwofishInstance *instance, const byte *in_blk, byte *out_blk, size_t blockCount)
+{
+	if (blockCount > 0)
+		twofish_encrypt_blocks (instance, in_blk, out_blk, (uint32) blockCount);
+}
+
+void twofish_avx512_decrypt_blocks (TwofishInstance *instance, const byte *in_blk, byte *out_blk, size_t blockCount)
+{
+	if (blockCount > 0)
+		twofish_decrypt_blocks (instance, in_blk, out_blk, (uint32) blockCount);
+}
+
+#endif
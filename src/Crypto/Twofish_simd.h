@@ -0,0 +1,97 @@
+/*
+ Copyright (c) 2013-2018 IDRIX. All rights reserved.
+
+ Governed by the Apache License 2.0 the full text of which is
+ contained in the file License.txt included in VeraCrypt binary and source
+ code distribution packages.
+*/
+
+/* Twofish rounds on vectors of 32-bit words, each lane holding the corresponding word
+   of a different block. The g function is evaluated by gathering from the key-dependent
+   tables mk_tab. The including file defines the vector primitives TF_VEC, TF_XOR, TF_ADD,
+   TF_AND, TF_SRLI, TF_ROTL, TF_ROTR, TF_SET1 and TF_GATHER (table, indices). */
+
+#ifndef TC_HEADER_Crypto_Twofish_simd
+#define TC_HEADER_Crypto_Twofish_simd
+
+#include "Twofish.h"
+
+/* The whitening and round subkeys are stored contiguously in both key layouts */
+#if CRYPTOPP_BOOL_X64 && !defined(CRYPTOPP_DISABLE_ASM)
+#	define TWOFISH_SIMD_ROUND_KEYS(instance) ((instance)->w)
+#else
+#	define TWOFISH_SIMD_ROUND_KEYS(instance) ((instance)->l_key)
+#endif
+
+#define TWOFISH_SIMD_G0(x) \
+	TF_XOR (TF_XOR (TF_GATHER (mk_tab[0], TF_AND (x, byteMask)), TF_GATHER (mk_tab[1], TF_AND (TF_SRLI (x, 8), byteMask))), \
+		TF_XOR (TF_GATHER (mk_tab[2], TF_AND (TF_SRLI (x, 16), byteMask)), TF_GATHER (mk_tab[3], TF_SRLI (x, 24))))
+
+#define TWOFISH_SIMD_G1(x) \
+	TF_XOR (TF_XOR (TF_GATHER (mk_tab[0], TF_SRLI (x, 24)), TF_GATHER (mk_tab[1], TF_AND (x, byteMask))), \
+		TF_XOR (TF_GATHER (mk_tab[2], TF_AND (TF_SRLI (x, 8), byteMask)), TF_GATHER (mk_tab[3], TF_AND (TF_SRLI (x, 16), byteMask))))
+
+#define TWOFISH_SIMD_ROUNDT(a, b, r) \
+	f0 = TWOFISH_SIMD_G0 (a); \
+	f1 = TWOFISH_SIMD_G1 (b); \
+	f0 = TF_ADD (f0, f1); \
+	f1 = TF_ADD (TF_ADD (f1, f0), TF_SET1 (rk[2 * (r) + 9])); \
+	f0 = TF_ADD (f0, TF_SET1 (rk[2 * (r) + 8]));
+
+#define TWOFISH_SIMD_ROUNDA(r) \
+	TWOFISH_SIMD_ROUNDT (x0, x1, r) \
+	x2 = TF_ROTR (TF_XOR (x2, f0), 1); \
+	x3 = TF_XOR (TF_ROTL (x3, 1), f1);
+
+#define TWOFISH_SIMD_ROUNDB(r) \
+	TWOFISH_SIMD_ROUNDT (x2, x3, r) \
+	x0 = TF_ROTR (TF_XOR (x0, f0), 1); \
+	x1 = TF_XOR (TF_ROTL (x1, 1), f1);
+
+#define TWOFISH_SIMD_RROUNDA(r) \
+	TWOFISH_SIMD_ROUNDT (x0, x1, r) \
+	x2 = TF_XOR (TF_ROTL (x2, 1), f0); \
+	x3 = TF_ROTR (TF_XOR (x3, f1), 1);
+
+#define TWOFISH_SIMD_RROUNDB(r) \
+	TWOFISH_SIMD_ROUNDT (x2, x3, r) \
+	x0 = TF_XOR (TF_ROTL (x0, 1), f0); \
+	x1 = TF_ROTR (TF_XOR (x1, f1), 1);
+
+/* Encrypts or decrypts the words x0..x3 in place. The output words are x2, x3, x0, x1.
+   Requires rk, mk_tab, byteMask, f0, f1 and the round counter r in scope. */
+#define TWOFISH_SIMD_ENCRYPT() \
+	x0 = TF_XOR (x0, TF_SET1 (rk[0])); \
+	x1 = TF_XOR (x1, TF_SET1 (rk[1])); \
+	x2 = TF_XOR (x2, TF_SET1 (rk[2])); \
+	x3 = TF_XOR (x3, TF_SET1 (rk[3])); \
+	\
+	for (r = 0; r < 16; r += 2) \
+	{ \
+		TWOFISH_SIMD_ROUNDA (r); \
+		TWOFISH_SIMD_ROUNDB (r + 1); \
+	} \
+	\
+	x2 = TF_XOR (x2, TF_SET1 (rk[4])); \
+	x3 = TF_XOR (x3, TF_SET1 (rk[5])); \
+	x0 = TF_XOR (x0, TF_SET1 (rk[6])); \
+	x1 = TF_XOR (x1, TF_SET1 (rk[7]));
+
+#define TWOFISH_SIMD_DECRYPT() \
+	x0 = TF_XOR (x0, TF_SET1 (rk[4])); \
+	x1 = TF_XOR (x1, TF_SET1 (rk[5])); \
+	x2 = TF_XOR (x2, TF_SET1 (rk[6])); \
+	x3 = TF_XOR (x3, TF_SET1 (rk[7])); \
+	\
+	for (r = 15; r > 0; r -= 2) \
+	{ \
+		TWOFISH_SIMD_RROUNDA (r); \
+		TWOFISH_SIMD_RROUNDB (r - 1); \
+	} \
+	\
+	x2 = TF_XOR (x2, TF_SET1 (rk[0])); \
+	x3 = TF_XOR (x3, TF_SET1 (rk[1])); \
+	x0 = TF_XOR (x0, TF_SET1 (rk[2])); \
+	x1 = TF_XOR (x1, TF_SET1 (rk[3]));
+
+#endif // TC_HEADER_Crypto_Twofish_simd
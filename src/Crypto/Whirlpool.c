@@ -655,7 +655,12 @@ void WhirlpoolTransform(uint64 *digest, const uint64 *block)
 	}
 #endif
 #endif
-	
+
+#ifdef WHIRLPOOL_AVX512_SUPPORTED
+	if (HasAVX512F() && HasAVX512BW() && HasAVX512VBMI() && HasGFNI() && whirlpool_has_avx512())
+		whirlpool_avx512_transform(digest, block);
+	else
+#endif
 #if CRYPTOPP_BOOL_SSE2_ASM_AVAILABLE
 	if (HasISSE())
 	{
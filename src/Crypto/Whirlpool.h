@@ -20,6 +20,13 @@ void WHIRLPOOL_add(const unsigned char * source, unsigned __int32 sourceBytes, W
 void WHIRLPOOL_finalize(WHIRLPOOL_CTX* const ctx, unsigned char * result);
 void WHIRLPOOL_init(WHIRLPOOL_CTX* const ctx);
 
+#if defined (TC_UNIX) && CRYPTOPP_BOOL_X64 && !defined (CRYPTOPP_DISABLE_ASM)
+#define WHIRLPOOL_AVX512_SUPPORTED
+/* Transformation using AVX-512 VBMI and GFNI, available when whirlpool_has_avx512 returns 1 */
+int whirlpool_has_avx512 ();
+void whirlpool_avx512_transform (uint64 *digest, const uint64 *block);
+#endif
+
 #if defined(__cplusplus)
 }
 #endif
@@ -0,0 +1,141 @@
+/*
+ Copyright (c) 2013-2018 IDRIX. All rights reserved.
+
+ Governed by the Apache License 2.0 the full text of which is
+ contained in the file License.txt included in VeraCrypt binary and source
+ code distribution packages.
+*/
+
+/* Whirlpool transformation using AVX-512 VBMI and GFNI. The 8 x 8 byte state is kept in one ZMM
+   register with column k of the matrix in quadword k, row i being byte i of the quadword. The
+   S-box layer is a byte substitution with VPERMI2B. Byte (i, k) of the output of the ShiftColumns
+   and MixRows layers is the sum over j of the products of byte (i - j, j) of the input with the
+   circulant coefficient of (j, k). For each j, VPERMB gathers the input bytes (i - j, j) into all
+   columns, and GF2P8AFFINEQB multiplies column k by its coefficient. */
+
+#include "Whirlpool.h"
+
+#ifdef WHIRLPOOL_AVX512_SUPPORTED
+
+#if defined (__AVX512F__) && defined (__AVX512BW__) && defined (__AVX512VBMI__) && defined (__GFNI__)
+
+#include <immintrin.h>
+
+CRYPTOPP_ALIGN_DATA(64) static const byte whirlpoolSbox[256] CRYPTOPP_SECTION_ALIGN16 = {
+	0x18, 0x23, 0xc6, 0xe8, 0x87, 0xb8, 0x01, 0x4f, 0x36, 0xa6, 0xd2, 0xf5, 0x79, 0x6f, 0x91, 0x52,
+	0x60, 0xbc, 0x9b, 0x8e, 0xa3, 0x0c, 0x7b, 0x35, 0x1d, 0xe0, 0xd7, 0xc2, 0x2e, 0x4b, 0xfe, 0x57,
+	0x15, 0x77, 0x37, 0xe5, 0x9f, 0xf0, 0x4a, 0xda, 0x58, 0xc9, 0x29, 0x0a, 0xb1, 0xa0, 0x6b, 0x85,
+	0xbd, 0x5d, 0x10, 0xf4, 0xcb, 0x3e, 0x05, 0x67, 0xe4, 0x27, 0x41, 0x8b, 0xa7, 0x7d, 0x95, 0xd8,
+	0xfb, 0xee, 0x7c, 0x66, 0xdd, 0x17, 0x47, 0x9e, 0xca, 0x2d, 0xbf, 0x07, 0xad, 0x5a, 0x83, 0x33,
+	0x63, 0x02, 0xaa, 0x71, 0xc8, 0x19, 0x49, 0xd9, 0xf2, 0xe3, 0x5b, 0x88, 0x9a, 0x26, 0x32, 0xb0,
+	0xe9, 0x0f, 0xd5, 0x80, 0xbe, 0xcd, 0x34, 0x48, 0xff, 0x7a, 0x90, 0x5f, 0x20, 0x68, 0x1a, 0xae,
+	0xb4, 0x54, 0x93, 0x22, 0x64, 0xf1, 0x73, 0x12, 0x40, 0x08, 0xc3, 0xec, 0xdb, 0xa1, 0x8d, 0x3d,
+	0x97, 0x00, 0xcf, 0x2b, 0x76, 0x82, 0xd6, 0x1b, 0xb5, 0xaf, 0x6a, 0x50, 0x45, 0xf3, 0x30, 0xef,
+	0x3f, 0x55, 0xa2, 0xea, 0x65, 0xba, 0x2f, 0xc0, 0xde, 0x1c, 0xfd, 0x4d, 0x92, 0x75, 0x06, 0x8a,
+	0xb2, 0xe6, 0x0e, 0x1f, 0x62, 0xd4, 0xa8, 0x96, 0xf9, 0xc5, 0x25, 0x59, 0x84, 0x72, 0x39, 0x4c,
+	0x5e, 0x78, 0x38, 0x8c, 0xd1, 0xa5, 0xe2, 0x61, 0xb3, 0x21, 0x9c, 0x1e, 0x43, 0xc7, 0xfc, 0x04,
+	0x51, 0x99, 0x6d, 0x0d, 0xfa, 0xdf, 0x7e, 0x24, 0x3b, 0xab, 0xce, 0x11, 0x8f, 0x4e, 0xb7, 0xeb,
+	0x3c, 0x81, 0x94, 0xf7, 0xb9, 0x13, 0x2c, 0xd3, 0xe7, 0x6e, 0xc4, 0x03, 0x56, 0x44, 0x7f, 0xa9,
+	0x2a, 0xbb, 0xc1, 0x53, 0xdc, 0x0b, 0x9d, 0x6c, 0x31, 0x74, 0xf6, 0x46, 0xac, 0x89, 0x14, 0xe1,
+	0x16, 0x3a, 0x69, 0x09, 0x70, 0xb6, 0xd0, 0xed, 0xcc, 0x42, 0x98, 0xa4, 0x28, 0x5c, 0xf8, 0x86
+};
+
+/* Quadword k of entry j multiplies by coefficient (k - j) mod 8 of the circulant matrix
+   cir (1, 1, 4, 1, 8, 5, 2, 9) over GF(2^8) modulo x^8 + x^4 + x^3 + x^2 + 1 */
+CRYPTOPP_ALIGN_DATA(64) static const uint64 whirlpoolAffineMatrices[8][8] CRYPTOPP_SECTION_ALIGN16 = {
+	{ LL(0x0102040810204080), LL(0x0102040810204080), LL(0x408041c2c4881020), LL(0x0102040810204080), LL(0x2040a061e2c48810), LL(0x418245cad4a850a0), LL(0x8001828488102040), LL(0x2142a469f2e4c890) },
+	{ LL(0x2142a469f2e4c890), LL(0x0102040810204080), LL(0x0102040810204080), LL(0x408041c2c4881020), LL(0x0102040810204080), LL(0x2040a061e2c48810), LL(0x418245cad4a850a0), LL(0x8001828488102040) },
+	{ LL(0x8001828488102040), LL(0x2142a469f2e4c890), LL(0x0102040810204080), LL(0x0102040810204080), LL(0x408041c2c4881020), LL(0x0102040810204080), LL(0x2040a061e2c48810), LL(0x418245cad4a850a0) },
+	{ LL(0x418245cad4a850a0), LL(0x8001828488102040), LL(0x2142a469f2e4c890), LL(0x0102040810204080), LL(0x0102040810204080), LL(0x408041c2c4881020), LL(0x0102040810204080), LL(0x2040a061e2c48810) },
+	{ LL(0x2040a061e2c48810), LL(0x418245cad4a850a0), LL(0x8001828488102040), LL(0x2142a469f2e4c890), LL(0x0102040810204080), LL(0x0102040810204080), LL(0x408041c2c4881020), LL(0x0102040810204080) },
+	{ LL(0x0102040810204080), LL(0x2040a061e2c48810), LL(0x418245cad4a850a0), LL(0x8001828488102040), LL(0x2142a469f2e4c890), LL(0x0102040810204080), LL(0x0102040810204080), LL(0x408041c2c4881020) },
+	{ LL(0x408041c2c4881020), LL(0x0102040810204080), LL(0x2040a061e2c48810), LL(0x418245cad4a850a0), LL(0x8001828488102040), LL(0x2142a469f2e4c890), LL(0x0102040810204080), LL(0x0102040810204080) },
+	{ LL(0x0102040810204080), LL(0x408041c2c4881020), LL(0x0102040810204080), LL(0x2040a061e2c48810), LL(0x418245cad4a850a0), LL(0x8001828488102040), LL(0x2142a469f2e4c890), LL(0x0102040810204080) }
+};
+
+/* Gathers byte (i - j, j) of the state into byte (i, k) for all k */
+#define SHIFTED_COLUMN(v, j) _mm512_permutexvar_epi8 (shiftedColumn[j], v)
+
+#define MIXED_COLUMN(v, j) \
+	_mm512_gf2p8affine_epi64_epi8 (SHIFTED_COLUMN (v, j), _mm512_load_si512 ((const __m512i *) whirlpoolAffineMatrices[j]), 0)
+
+/* y = MixRows (ShiftColumns (SubBytes (x))) ^ k. VPERMI2B indexes 128 bytes of the table with
+   the low seven bits of each byte; the high bit selects between the two halves of the table. */
+#define WHIRLPOOL_ROUND(x, k, y) \
+	{ \
+		__m512i v = _mm512_mask_blend_epi8 (_mm512_movepi8_mask (x), \
+			_mm512_permutex2var_epi8 (sbox[0], x, sbox[1]), \
+			_mm512_permutex2var_epi8 (sbox[2], x, sbox[3])); \
+		\
+		y = _mm512_ternarylogic_epi64 ( \
+			_mm512_ternarylogic_epi64 (MIXED_COLUMN (v, 0), MIXED_COLUMN (v, 1), MIXED_COLUMN (v, 2), 0x96), \
+			_mm512_ternarylogic_epi64 (MIXED_COLUMN (v, 3), MIXED_COLUMN (v, 4), MIXED_COLUMN (v, 5), 0x96), \
+			_mm512_ternarylogic_epi64 (MIXED_COLUMN (v, 6), MIXED_COLUMN (v, 7), k, 0x96), 0x96); \
+	}
+
+int whirlpool_has_avx512 ()
+{
+	return 1;
+}
+
+void whirlpool_avx512_transform (uint64 *digest, const uint64 *block)
+{
+	/* Byte 8 * i + m of the words is column 7 - m of row i */
+	const __m512i toColumns = _mm512_set_epi8 (
+		56, 48, 40, 32, 24, 16, 8, 0, 57, 49, 41, 33, 25, 17, 9, 1,
+		58, 50, 42, 34, 26, 18, 10, 2, 59, 51, 43, 35, 27, 19, 11, 3,
+		60, 52, 44, 36, 28, 20, 12, 4, 61, 53, 45, 37, 29, 21, 13, 5,
+		62, 54, 46, 38, 30, 22, 14, 6, 63, 55, 47, 39, 31, 23, 15, 7);
+	const __m512i toRows = _mm512_set_epi8 (
+		7, 15, 23, 31, 39, 47, 55, 63, 6, 14, 22, 30, 38, 46, 54, 62,
+		5, 13, 21, 29, 37, 45, 53, 61, 4, 12, 20, 28, 36, 44, 52, 60,
+		3, 11, 19, 27, 35, 43, 51, 59, 2, 10, 18, 26, 34, 42, 50, 58,
+		1, 9, 17, 25, 33, 41, 49, 57, 0, 8, 16, 24, 32, 40, 48, 56);
+	const __m512i rowIndex = _mm512_set1_epi64 (LL(0x0706050403020100));
+	__m512i sbox[4], shiftedColumn[8], blockVector, key, state;
+	int r, j;
+
+	/* Row i - j of column j in byte i of all quadwords */
+	for (j = 0; j < 8; j++)
+	{
+		shiftedColumn[j] = _mm512_or_si512 (_mm512_set1_epi8 (8 * j),
+			_mm512_and_si512 (_mm512_add_epi8 (rowIndex, _mm512_set1_epi8 (8 - j)), _mm512_set1_epi8 (7)));
+	}
+
+	sbox[0] = _mm512_load_si512 ((const __m512i *) whirlpoolSbox);
+	sbox[1] = _mm512_load_si512 ((const __m512i *) whirlpoolSbox + 1);
+	sbox[2] = _mm512_load_si512 ((const __m512i *) whirlpoolSbox + 2);
+	sbox[3] = _mm512_load_si512 ((const __m512i *) whirlpoolSbox + 3);
+
+	blockVector = _mm512_loadu_si512 ((const __m512i *) block);
+	key = _mm512_permutexvar_epi8 (toColumns, _mm512_loadu_si512 ((const __m512i *) digest));
+	state = _mm512_xor_si512 (key, _mm512_permutexvar_epi8 (toColumns, blockVector));
+
+	for (r = 0; r < 10; r++)
+	{
+		/* The round constant of round r is row 0 of bytes 8r to 8r + 7 of the S-box */
+		__m512i roundConstant = _mm512_cvtepu8_epi64 (_mm_loadl_epi64 ((const __m128i *) (whirlpoolSbox + 8 * r)));
+
+		WHIRLPOOL_ROUND (key, roundConstant, key);
+		WHIRLPOOL_ROUND (state, key, state);
+	}
+
+	state = _mm512_permutexvar_epi8 (toRows, state);
+	_mm512_storeu_si512 ((__m512i *) digest, _mm512_ternarylogic_epi64 (_mm512_loadu_si512 ((const __m512i *) digest), state, blockVector, 0x96));
+}
+
+#else // The compiler does not support AVX-512 VBMI and GFNI
+
+int whirlpool_has_avx512 ()
+{
+	return 0;
+}
+
+void whirlpool_avx512_transform (uint64 *digest, const uint64 *block)
+{
+	/* Never called since whirlpool_has_avx512 returns 0 */
+}
+
+#endif
+
+#endif // WHIRLPOOL_AVX512_SUPPORTED
@@ -0,0 +1,190 @@
+/*
+ Copyright (c) 2013-2018 IDRIX. All rights reserved.
+
+ Governed by the Apache License 2.0 the full text of which is
+ contained in the file License.txt included in VeraCrypt binary and source
+ code distribution packages.
+*/
+
+#include "Common/Endian.h"
+#include "Xts_simd.h"
+
+/* Whitening values are elements of GF(2^128) stored as little-endian 128-bit integers.
+   The value of each block is the value of the previous block multiplied by x, reduced
+   by the modulus x^128 + x^7 + x^2 + x + 1. */
+
+#if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE
+
+/* Multiplication by x: shift both 64-bit halves left and carry bit 63 into bit 64 and
+   bit 127 into the reduction constant 135 */
+VC_INLINE __m128i xts_mul_x (__m128i t)
+{
+	__m128i carry = _mm_shuffle_epi32 (_mm_srai_epi32 (t, 31), _MM_SHUFFLE (1, 1, 3, 3));
+	carry = _mm_and_si128 (carry, _mm_set_epi32 (0, 1, 0, 135));
+
+	return _mm_xor_si128 (_mm_add_epi64 (t, t), carry);
+}
+
+/* Multiplication by x^8: a byte shift, with the overflowing byte b reduced to
+   b * (x^7 + x^2 + x + 1). Unlike repeated doubling, this has no dependency on the
+   whitening values of the preceding blocks. */
+VC_INLINE __m128i xts_mul_x8 (__m128i t)
+{
+	__m128i overflow = _mm_srli_si128 (t, 15);
+	__m128i reduction = _mm_xor_si128 (_mm_xor_si128 (overflow, _mm_slli_epi16 (overflow, 1)),
+		_mm_xor_si128 (_mm_slli_epi16 (overflow, 2), _mm_slli_epi16 (overflow, 7)));
+
+	return _mm_xor_si128 (_mm_slli_si128 (t, 1), reduction);
+}
+
+void xts_whiten_blocks (byte *data, byte *whiteningValues, byte *tweak, size_t blockCount)
+{
+	__m128i t = _mm_loadu_si128 ((const __m128i *) tweak);
+
+	while (blockCount-- > 0)
+	{
+		_mm_storeu_si128 ((__m128i *) whiteningValues, t);
+		_mm_storeu_si128 ((__m128i *) data, _mm_xor_si128 (_mm_loadu_si128 ((const __m128i *) data), t));
+
+		t = xts_mul_x (t);
+		data += 16;
+		whiteningValues += 16;
+	}
+
+	_mm_storeu_si128 ((__m128i *) tweak, t);
+}
+
+void xts_xor_blocks (byte *data, const byte *whiteningValues, size_t blockCount)
+{
+	while (blockCount >= 2)
+	{
+		__m128i d0 = _mm_loadu_si128 ((const __m128i *) data);
+		__m128i d1 = _mm_loadu_si128 ((const __m128i *) (data + 16));
+
+		_mm_storeu_si128 ((__m128i *) data, _mm_xor_si128 (d0, _mm_loadu_si128 ((const __m128i *) whiteningValues)));
+		_mm_storeu_si128 ((__m128i *) (data + 16), _mm_xor_si128 (d1, _mm_loadu_si128 ((const __m128i *) (whiteningValues + 16))));
+
+		data += 32;
+		whiteningValues += 32;
+		blockCount -= 2;
+	}
+
+	if (blockCount)
+		_mm_storeu_si128 ((__m128i *) data, _mm_xor_si128 (_mm_loadu_si128 ((const __m128i *) data), _mm_loadu_si128 ((const __m128i *) whiteningValues)));
+}
+
+#else
+
+void xts_whiten_blocks (byte *data, byte *whiteningValues, byte *tweak, size_t blockCount)
+{
+	uint64 *dataPtr = (uint64 *) data;
+	uint64 *whiteningValuesPtr = (uint64 *) whiteningValues;
+	uint64 low = LE64 (((uint64 *) tweak)[0]);
+	uint64 high = LE64 (((uint64 *) tweak)[1]);
+
+	while (blockCount-- > 0)
+	{
+		uint64 carry = (high & 0x8000000000000000ULL) ? 135 : 0;
+
+		*whiteningValuesPtr = LE64 (low);
+		*dataPtr++ ^= *whiteningValuesPtr++;
+		*whiteningValuesPtr = LE64 (high);
+		*dataPtr++ ^= *whiteningValuesPtr++;
+
+		high = (high << 1) | (low >> 63);
+		low = (low << 1) ^ carry;
+	}
+
+	((uint64 *) tweak)[0] = LE64 (low);
+	((uint64 *) tweak)[1] = LE64 (high);
+}
+
+void xts_xor_blocks (byte *data, const byte *whiteningValues, size_t blockCount)
+{
+	uint64 *dataPtr = (uint64 *) data;
+	const uint64 *whiteningValuesPtr = (const uint64 *) whiteningValues;
+
+	while (blockCount-- > 0)
+	{
+		*dataPtr++ ^= *whiteningValuesPtr++;
+		*dataPtr++ ^= *whiteningValuesPtr++;
+	}
+}
+
+#endif
+
+#ifdef TC_XTS_AES_HW_CPU
+
+#define XTS_AES_ROUND_KEY_COUNT 15
+#define XTS_AES_PARALLEL_BLOCKS 8
+
+/* Eight blocks are processed in parallel to hide the latency of the AES round instructions.
+   The whitening value is XORed with the first round key before and with the last round key
+   after the rounds, so that whitening costs no additional pass. */
+#define XTS_AES_HW_CPU_BLOCKS(ROUND, LAST_ROUND) \
+	__m128i roundKeys[XTS_AES_ROUND_KEY_COUNT]; \
+	__m128i t[XTS_AES_PARALLEL_BLOCKS]; \
+	__m128i b[XTS_AES_PARALLEL_BLOCKS]; \
+	int i, round; \
+	\
+	for (round = 0; round < XTS_AES_ROUND_KEY_COUNT; ++round) \
+		roundKeys[round] = _mm_loadu_si128 ((const __m128i *) ks + round); \
+	\
+	t[0] = _mm_loadu_si128 ((const __m128i *) tweak); \
+	\
+	if (blockCount >= XTS_AES_PARALLEL_BLOCKS) \
+	{ \
+		for (i = 1; i < XTS_AES_PARALLEL_BLOCKS; ++i) \
+			t[i] = xts_mul_x (t[i - 1]); \
+		\
+		while (1) \
+		{ \
+			for (i = 0; i < XTS_AES_PARALLEL_BLOCKS; ++i) \
+				b[i] = _mm_xor_si128 (_mm_loadu_si128 ((const __m128i *) data + i), _mm_xor_si128 (t[i], roundKeys[0])); \
+			\
+			for (round = 1; round < XTS_AES_ROUND_KEY_COUNT - 1; ++round) \
+			{ \
+				for (i = 0; i < XTS_AES_PARALLEL_BLOCKS; ++i) \
+					b[i] = ROUND (b[i], roundKeys[round]); \
+			} \
+			\
+			for (i = 0; i < XTS_AES_PARALLEL_BLOCKS; ++i) \
+			{ \
+				_mm_storeu_si128 ((__m128i *) data + i, LAST_ROUND (b[i], _mm_xor_si128 (t[i], roundKeys[XTS_AES_ROUND_KEY_COUNT - 1]))); \
+				t[i] = xts_mul_x8 (t[i]); \
+			} \
+			\
+			data += XTS_AES_PARALLEL_BLOCKS * 16; \
+			blockCount -= XTS_AES_PARALLEL_BLOCKS; \
+			\
+			if (blockCount < XTS_AES_PARALLEL_BLOCKS) \
+				break; \
+		} \
+	} \
+	\
+	while (blockCount-- > 0) \
+	{ \
+		b[0] = _mm_xor_si128 (_mm_loadu_si128 ((const __m128i *) data), _mm_xor_si128 (t[0], roundKeys[0])); \
+		\
+		for (round = 1; round < XTS_AES_ROUND_KEY_COUNT - 1; ++round) \
+			b[0] = ROUND (b[0], roundKeys[round]); \
+		\
+		_mm_storeu_si128 ((__m128i *) data, LAST_ROUND (b[0], _mm_xor_si128 (t[0], roundKeys[XTS_AES_ROUND_KEY_COUNT - 1]))); \
+		\
+		t[0] = xts_mul_x (t[0]); \
+		data += 16; \
+	} \
+	\
+	_mm_storeu_si128 ((__m128i *) tweak, t[0]);
+
+void xts_aes_hw_cpu_decrypt_blocks (const byte *ks, byte *data, byte *tweak, size_t blockCount)
+{
+	XTS_AES_HW_CPU_BLOCKS (_mm_aesdec_si128, _mm_aesdeclast_si128);
+}
+
+void xts_aes_hw_cpu_encrypt_blocks (const byte *ks, byte *data, byte *tweak, size_t blockCount)
+{
+	XTS_AES_HW_CPU_BLOCKS (_mm_aesenc_si128, _mm_aesenclast_si128);
+}
+
+#endif
@@ -0,0 +1,45 @@
+/*
+ Copyright (c) 2013-2018 IDRIX. All rights reserved.
+
+ Governed by the Apache License 2.0 the full text of which is
+ contained in the file License.txt included in VeraCrypt binary and source
+ code distribution packages.
+*/
+
+#ifndef TC_HEADER_Crypto_Xts_simd
+#define TC_HEADER_Crypto_Xts_simd
+
+#include "Common/Tcdefs.h"
+#include "config.h"
+#include "cpu.h"
+
+#if defined (TC_AES_HW_CPU) && CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
+#	define TC_XTS_AES_HW_CPU
+#endif
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+/* Generates the whitening values of blockCount consecutive XTS blocks, the first of which
+   is passed in tweak, stores them in whiteningValues and XORs them into data. On return,
+   tweak holds the whitening value of the block following the last one. */
+void xts_whiten_blocks (byte *data, byte *whiteningValues, byte *tweak, size_t blockCount);
+
+/* XORs previously generated whitening values into data */
+void xts_xor_blocks (byte *data, const byte *whiteningValues, size_t blockCount);
+
+#ifdef TC_XTS_AES_HW_CPU
+/* AES-XTS with tweak generation, whitening and AES-NI rounds fused in a single pass.
+   ks points to the 15 round keys of the respective direction. There are no fused kernels
+   for the other ciphers, which use xts_whiten_blocks and xts_xor_blocks. */
+void xts_aes_hw_cpu_decrypt_blocks (const byte *ks, byte *data, byte *tweak, size_t blockCount);
+void xts_aes_hw_cpu_encrypt_blocks (const byte *ks, byte *data, byte *tweak, size_t blockCount);
+#endif
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // TC_HEADER_Crypto_Xts_simd
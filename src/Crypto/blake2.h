@@ -18,6 +18,7 @@
 #ifndef BLAKE2_H
 #define BLAKE2_H
 #include "Common/Tcdefs.h"
+#include "Crypto/config.h"
 
 #if defined(_MSC_VER)
 #ifdef TC_WINDOWS_BOOT
@@ -95,6 +96,19 @@ extern "C" {
   /* Simple API */
   int blake2s( void *out, const void *in, size_t inlen );
 
+  /* Multi-lane PBKDF2 kernel, built by the Unix makefiles for x64 */
+#if defined (TC_UNIX) && CRYPTOPP_BOOL_X64 && !defined (CRYPTOPP_DISABLE_ASM)
+#define BLAKE2S_PBKDF2_LANES_SUPPORTED
+#define BLAKE2S_PBKDF2_LANES 8
+
+  /* Runs the next iterations PBKDF2-HMAC iterations for BLAKE2S_PBKDF2_LANES independent output
+     blocks at once. Word i of lane j is stored at index i * BLAKE2S_PBKDF2_LANES + j.
+     inner and outer hold the chaining values after compressing the padded HMAC key of each
+     lane. uBlock holds the last U_c and block the XOR of U_1 to U_c, and both are updated, so
+     that a derivation can be run in several calls. May only be called if HasSAVX2() is true. */
+  void blake2s_avx2_pbkdf2( const uint32 *inner, const uint32 *outer, uint32 *uBlock, uint32 *block, uint32 iterations );
+#endif
+
 #if defined(__cplusplus)
 }
 #endif
@@ -0,0 +1,172 @@
+/*
+ Copyright (c) 2013-2018 IDRIX. All rights reserved.
+
+ Governed by the Apache License 2.0 the full text of which is
+ contained in the file License.txt included in VeraCrypt binary and source
+ code distribution packages.
+*/
+
+/* PBKDF2-HMAC-BLAKE2s iterations with one output block in each 32-bit lane of an AVX2 vector.
+   Every iteration hashes one key block and one digest; the key block is compressed once by
+   the caller, so each HMAC step is a single compression of the digest padded with zeros,
+   flagged as the last block of a 96-byte message. */
+
+#include "blake2.h"
+#include "Crypto/misc.h"
+
+#ifdef BLAKE2S_PBKDF2_LANES_SUPPORTED
+
+extern const uint32 blake2s_IV[8];
+
+#if defined (__AVX2__)
+
+#include <immintrin.h>
+
+#define B2S_VEC __m256i
+#define B2S_LOAD(p) _mm256_loadu_si256 ((const __m256i *) (p))
+#define B2S_STORE(p, a) _mm256_storeu_si256 ((__m256i *) (p), a)
+#define B2S_ADD(a, b) _mm256_add_epi32 (a, b)
+#define B2S_XOR(a, b) _mm256_xor_si256 (a, b)
+#define B2S_ROR(a, n) _mm256_or_si256 (_mm256_srli_epi32 (a, n), _mm256_slli_epi32 (a, 32 - (n)))
+#define B2S_ROR16(a) _mm256_shuffle_epi8 (a, _mm256_set_epi8 ( \
+	13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2, 13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2))
+#define B2S_ROR8(a) _mm256_shuffle_epi8 (a, _mm256_set_epi8 ( \
+	12, 15, 14, 13, 8, 11, 10, 9, 4, 7, 6, 5, 0, 3, 2, 1, 12, 15, 14, 13, 8, 11, 10, 9, 4, 7, 6, 5, 0, 3, 2, 1))
+#define B2S_SET1(x) _mm256_set1_epi32 ((int) (x))
+
+#else // The compiler does not support AVX2: the lanes are processed one at a time
+
+#define B2S_VEC uint32
+#define B2S_LOAD(p) (*(p))
+#define B2S_STORE(p, a) (*(p) = (a))
+#define B2S_ADD(a, b) ((a) + (b))
+#define B2S_XOR(a, b) ((a) ^ (b))
+#define B2S_ROR(a, n) rotr32 (a, n)
+#define B2S_ROR16(a) rotr32 (a, 16)
+#define B2S_ROR8(a) rotr32 (a, 8)
+#define B2S_SET1(x) ((uint32) (x))
+
+#endif
+
+/* Local copy so that the message word indexes are compile-time constants */
+static const uint8 blake2s_lanes_sigma[10][16] =
+{
+	{  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+	{ 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 },
+	{ 11,  8, 12,  0,  5,  2, 15, 13, 10, 14,  3,  6,  7,  1,  9,  4 },
+	{  7,  9,  3,  1, 13, 12, 11, 14,  2,  6,  5, 10,  4,  0, 15,  8 },
+	{  9,  0,  5,  7,  2,  4, 10, 15, 14,  1, 11, 12,  6,  8,  3, 13 },
+	{  2, 12,  6, 10,  0, 11,  8,  3,  4, 13,  7,  5, 15, 14,  1,  9 },
+	{ 12,  5,  1, 15, 14, 13,  4, 10,  0,  7,  6,  3,  9,  2,  8, 11 },
+	{ 13, 11,  7, 14, 12,  1,  3,  9,  5,  0, 15,  4,  8,  6,  2, 10 },
+	{  6, 15, 14,  9, 11,  3,  0,  8, 12,  2, 13,  7,  1,  4, 10,  5 },
+	{ 10,  2,  8,  4,  7,  6,  1,  5, 15, 11,  9, 14,  3, 12, 13,  0 },
+};
+
+#define G(r, i, a, b, c, d) \
+	a = B2S_ADD (B2S_ADD (a, b), m[blake2s_lanes_sigma[r][2 * i + 0]]); \
+	d = B2S_ROR16 (B2S_XOR (d, a)); \
+	c = B2S_ADD (c, d); \
+	b = B2S_ROR (B2S_XOR (b, c), 12); \
+	a = B2S_ADD (B2S_ADD (a, b), m[blake2s_lanes_sigma[r][2 * i + 1]]); \
+	d = B2S_ROR8 (B2S_XOR (d, a)); \
+	c = B2S_ADD (c, d); \
+	b = B2S_ROR (B2S_XOR (b, c), 7);
+
+#define ROUND(r) \
+	G (r, 0, v[ 0], v[ 4], v[ 8], v[12]) \
+	G (r, 1, v[ 1], v[ 5], v[ 9], v[13]) \
+	G (r, 2, v[ 2], v[ 6], v[10], v[14]) \
+	G (r, 3, v[ 3], v[ 7], v[11], v[15]) \
+	G (r, 4, v[ 0], v[ 5], v[10], v[15]) \
+	G (r, 5, v[ 1], v[ 6], v[11], v[12]) \
+	G (r, 6, v[ 2], v[ 7], v[ 8], v[13]) \
+	G (r, 7, v[ 3], v[ 4], v[ 9], v[14])
+
+/* Compresses the last block of a message made of one key block and one digest */
+VC_INLINE void blake2s_lanes_compress (B2S_VEC h[8], const B2S_VEC m[16])
+{
+	B2S_VEC v[16];
+	int i;
+
+	for (i = 0; i < 8; i++)
+		v[i] = h[i];
+
+	v[ 8] = B2S_SET1 (blake2s_IV[0]);
+	v[ 9] = B2S_SET1 (blake2s_IV[1]);
+	v[10] = B2S_SET1 (blake2s_IV[2]);
+	v[11] = B2S_SET1 (blake2s_IV[3]);
+	v[12] = B2S_SET1 (blake2s_IV[4] ^ (BLAKE2S_BLOCKBYTES + BLAKE2S_OUTBYTES));
+	v[13] = B2S_SET1 (blake2s_IV[5]);
+	v[14] = B2S_SET1 (~blake2s_IV[6]);
+	v[15] = B2S_SET1 (blake2s_IV[7]);
+
+	ROUND (0);
+	ROUND (1);
+	ROUND (2);
+	ROUND (3);
+	ROUND (4);
+	ROUND (5);
+	ROUND (6);
+	ROUND (7);
+	ROUND (8);
+	ROUND (9);
+
+	for (i = 0; i < 8; i++)
+		h[i] = B2S_XOR (h[i], B2S_XOR (v[i], v[i + 8]));
+}
+
+/* Word i of the lanes to process starts at index i * stride of inner, outer and block */
+VC_INLINE void blake2s_lanes_pbkdf2 (const uint32 *inner, const uint32 *outer, uint32 *uBlock, uint32 *block, size_t stride, uint32 iterations)
+{
+	B2S_VEC u[8], dk[8], m[16];
+	uint32 c;
+	int i;
+
+	for (i = 0; i < 8; i++)
+	{
+		u[i] = B2S_LOAD (uBlock + i * stride);
+		dk[i] = B2S_LOAD (block + i * stride);
+		m[i + 8] = B2S_SET1 (0);
+	}
+
+	for (c = 0; c < iterations; c++)
+	{
+		for (i = 0; i < 8; i++)
+		{
+			m[i] = u[i];
+			u[i] = B2S_LOAD (inner + i * stride);
+		}
+		blake2s_lanes_compress (u, m);
+
+		for (i = 0; i < 8; i++)
+		{
+			m[i] = u[i];
+			u[i] = B2S_LOAD (outer + i * stride);
+		}
+		blake2s_lanes_compress (u, m);
+
+		for (i = 0; i < 8; i++)
+			dk[i] = B2S_XOR (dk[i], u[i]);
+	}
+
+	for (i = 0; i < 8; i++)
+	{
+		B2S_STORE (uBlock + i * stride, u[i]);
+		B2S_STORE (block + i * stride, dk[i]);
+	}
+}
+
+void blake2s_avx2_pbkdf2 (const uint32 *inner, const uint32 *outer, uint32 *uBlock, uint32 *block, uint32 iterations)
+{
+#if defined (__AVX2__)
+	blake2s_lanes_pbkdf2 (inner, outer, uBlock, block, BLAKE2S_PBKDF2_LANES, iterations);
+#else
+	int lane;
+
+	for (lane = 0; lane < BLAKE2S_PBKDF2_LANES; lane++)
+		blake2s_lanes_pbkdf2 (inner + lane, outer + lane, uBlock + lane, block + lane, BLAKE2S_PBKDF2_LANES, iterations);
+#endif
+}
+
+#endif // BLAKE2S_PBKDF2_LANES_SUPPORTED
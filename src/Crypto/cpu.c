@@ -207,6 +207,8 @@ volatile int g_x86DetectionDone = 0;
 volatile int g_hasISSE = 0, g_hasSSE2 = 0, g_hasSSSE3 = 0, g_hasMMX = 0, g_hasAESNI = 0, g_hasCLMUL = 0, g_isP4 = 0;
 volatile int g_hasAVX = 0, g_hasAVX2 = 0, g_hasBMI2 = 0, g_hasSSE42 = 0, g_hasSSE41 = 0, g_isIntel = 0, g_isAMD = 0;
 volatile int g_hasRDRAND = 0, g_hasRDSEED = 0;
+volatile int g_hasAVX512F = 0, g_hasAVX512BW = 0, g_hasAVX512VL = 0, g_hasVAES = 0, g_hasVPCLMULQDQ = 0;
+volatile int g_hasAVX512VBMI = 0, g_hasGFNI = 0, g_hasSHANI = 0;
 volatile uint32 g_cacheLineSize = CRYPTOPP_L1_CACHE_LINE_SIZE;
 
 VC_INLINE int IsIntel(const uint32 output[4])
@@ -309,6 +311,7 @@ static int Detect_MS_HyperV_AES ()
 void DetectX86Features()
 {
 	uint32 cpuid[4] = {0}, cpuid1[4] = {0}, cpuid2[4] = {0};
+	uint64 xcrFeatureMask = 0;
 	if (!CpuId(0, cpuid))
 		return;
 	if (!CpuId(1, cpuid1))
@@ -322,7 +325,7 @@ void DetectX86Features()
 		g_hasSSE2 = (cpuid1[2] & (1 << 27)) || TrySSE2();
 	if (g_hasSSE2 && (cpuid1[2] & (1 << 28)) && (cpuid1[2] & (1 << 27)) && (cpuid1[2] & (1 << 26))) /* CPU has AVX and OS supports XSAVE/XRSTORE */
 	{
-      uint64 xcrFeatureMask = xgetbv();
+      xcrFeatureMask = xgetbv();
       g_hasAVX = (xcrFeatureMask & 0x6) == 0x6;
 	}
 	g_hasAVX2 = g_hasAVX && (cpuid1[1] & (1 << 5));
@@ -344,6 +347,28 @@ void DetectX86Features()
 	}
 #endif
 
+	if (cpuid[0] >= 7 && CpuId(7, cpuid2))
+	{
+		// The SHA extensions only use XMM registers and do not require AVX
+		g_hasSHANI = g_hasSSE41 && (cpuid2[1] & (1 << 29));
+	}
+
+	if (g_hasAVX && cpuid[0] >= 7)
+	{
+		g_hasVAES = g_hasAESNI && (cpuid2[2] & (1 << 9));
+		g_hasVPCLMULQDQ = g_hasCLMUL && (cpuid2[2] & (1 << 10));
+		g_hasGFNI = (cpuid2[2] & (1 << 8)) != 0;
+
+		// AVX-512 additionally requires the OS to save the opmask and upper ZMM register state
+		if ((xcrFeatureMask & 0xE6) == 0xE6)
+		{
+			g_hasAVX512F = (cpuid2[1] & (1 << 16)) != 0;
+			g_hasAVX512BW = g_hasAVX512F && (cpuid2[1] & (1 << 30));
+			g_hasAVX512VL = g_hasAVX512F && (cpuid2[1] & (1 << 31));
+			g_hasAVX512VBMI = g_hasAVX512F && (cpuid2[2] & (1 << 1));
+		}
+	}
+
 	if ((cpuid1[3] & (1 << 25)) != 0)
 		g_hasISSE = 1;
 	else
@@ -369,7 +394,7 @@ void DetectX86Features()
 			if (CpuId(7, cpuid2))
 			{
 				g_hasRDSEED = (cpuid2[1] & (1 << 18)) != 0;
-				g_hasAVX2 = (cpuid2[1] & (1 <<  5)) != 0;
+				g_hasAVX2 = g_hasAVX && (cpuid2[1] & (1 <<  5)) != 0;
 				g_hasBMI2 = (cpuid2[1] & (1 <<  8)) != 0;
 			}
 		}
@@ -386,7 +411,7 @@ void DetectX86Features()
 			if (CpuId(7, cpuid2))
 			{
 				g_hasRDSEED = (cpuid2[1] & (1 << 18)) != 0;
-				g_hasAVX2 = (cpuid2[1] & (1 <<  5)) != 0;
+				g_hasAVX2 = g_hasAVX && (cpuid2[1] & (1 <<  5)) != 0;
 				g_hasBMI2 = (cpuid2[1] & (1 <<  8)) != 0;
 			}
 		}
@@ -440,6 +465,14 @@ void DisableCPUExtendedFeatures ()
 	g_hasSSSE3 = 0;
 	g_hasAESNI = 0;
 	g_hasCLMUL = 0;
+	g_hasAVX512F = 0;
+	g_hasAVX512BW = 0;
+	g_hasAVX512VL = 0;
+	g_hasVAES = 0;
+	g_hasVPCLMULQDQ = 0;
+	g_hasAVX512VBMI = 0;
+	g_hasGFNI = 0;
+	g_hasSHANI = 0;
 }
 
 #endif
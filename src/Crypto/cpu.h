@@ -231,6 +231,14 @@ extern volatile int g_hasSSE41;
 extern volatile int g_hasSSSE3;
 extern volatile int g_hasAESNI;
 extern volatile int g_hasCLMUL;
+extern volatile int g_hasAVX512F;
+extern volatile int g_hasAVX512BW;
+extern volatile int g_hasAVX512VL;
+extern volatile int g_hasVAES;
+extern volatile int g_hasVPCLMULQDQ;
+extern volatile int g_hasAVX512VBMI;
+extern volatile int g_hasGFNI;
+extern volatile int g_hasSHANI;
 extern volatile int g_isP4;
 extern volatile int g_hasRDRAND;
 extern volatile int g_hasRDSEED;
@@ -259,6 +267,14 @@ void DisableCPUExtendedFeatures ();
 #define HasSSSE3() g_hasSSSE3
 #define HasAESNI() g_hasAESNI
 #define HasCLMUL() g_hasCLMUL
+#define HasAVX512F() g_hasAVX512F
+#define HasAVX512BW() g_hasAVX512BW
+#define HasAVX512VL() g_hasAVX512VL
+#define HasVAES() g_hasVAES
+#define HasVPCLMULQDQ() g_hasVPCLMULQDQ
+#define HasAVX512VBMI() g_hasAVX512VBMI
+#define HasGFNI() g_hasGFNI
+#define HasSHANI() g_hasSHANI
 #define IsP4() g_isP4
 #define HasRDRAND() g_hasRDRAND
 #define HasRDSEED() g_hasRDSEED
@@ -284,6 +300,14 @@ void DisableCPUExtendedFeatures ();
 #define HasSSSE3() 0
 #define HasAESNI() 0
 #define HasCLMUL() 0
+#define HasAVX512F() 0
+#define HasAVX512BW() 0
+#define HasAVX512VL() 0
+#define HasVAES() 0
+#define HasVPCLMULQDQ() 0
+#define HasAVX512VBMI() 0
+#define HasGFNI() 0
+#define HasSHANI() 0
 #define IsP4() 0
 #define HasRDRAND() 0
 #define HasRDSEED() 0
@@ -28,6 +28,12 @@ void kuznyechik_decrypt_block(byte* out, const byte* in, kuznyechik_kds* kds);
 void kuznyechik_decrypt_blocks(byte* out, const byte* in, size_t blocks, kuznyechik_kds* kds);
 void kuznyechik_set_key(const byte* key, kuznyechik_kds *kds);
 
+/* Process 32 blocks at once using AVX-512 VBMI and GFNI; remaining blocks are passed to
+   kuznyechik_encrypt_blocks/kuznyechik_decrypt_blocks. May only be called if HasAVX512F(),
+   HasAVX512BW(), HasAVX512VBMI() and HasGFNI() are true. */
+void kuznyechik_avx512_encrypt_blocks(byte* out, const byte* in, size_t blocks, kuznyechik_kds* kds);
+void kuznyechik_avx512_decrypt_blocks(byte* out, const byte* in, size_t blocks, kuznyechik_kds* kds);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,196 @@
+/*
+ Copyright (c) 2013-2018 IDRIX. All rights reserved.
+
+ Governed by the Apache License 2.0 the full text of which is
+ contained in the file License.txt included in VeraCrypt binary and source
+ code distribution packages.
+*/
+
+/* Byte-sliced Kuznyechik using AVX-512 VBMI and GFNI. Thirty-two blocks are held in eight ZMM
+   registers x[0..7] so that each 128-bit lane of register m contains byte 2m of eight blocks in
+   its low quadword and byte 2m + 1 of the same blocks in its high quadword. The S transformation
+   is a byte substitution with VPERMI2B, and the L transformation reduces to multiplications of
+   whole registers by constants in GF(2^8), which are GF(2) affine transformations evaluated by
+   GF2P8AFFINEQB. Since the two quadwords of a lane may be multiplied by different constants,
+   each register contributes to an output byte with a single instruction. */
+
+#include "kuznyechik.h"
+#include "cpu.h"
+
+#if defined (__AVX512F__) && defined (__AVX512BW__) && defined (__AVX512VBMI__) && defined (__GFNI__)
+
+#include <immintrin.h>
+
+/* Defined in kuznyechik_simd.c */
+extern const uint_8t Pi[256];
+extern const uint_8t InversedPi[256];
+extern const uint_64t LTransformationAffineMatrices[16][16];
+extern const uint_64t inversedLTransformationAffineMatrices[16][16];
+
+#define KUZNYECHIK_AVX512_REGISTER_COUNT 8
+#define KUZNYECHIK_AVX512_PARALLEL_BLOCKS (KUZNYECHIK_AVX512_REGISTER_COUNT * 4)
+
+/* Selects bytes 2m and 2m + 1 of a broadcast round key for register m */
+CRYPTOPP_ALIGN_DATA(16) static const uint_8t keyShuffle[KUZNYECHIK_AVX512_REGISTER_COUNT][16] CRYPTOPP_SECTION_ALIGN16 = {
+	{ 0,  0,  0,  0,  0,  0,  0,  0,  1,  1,  1,  1,  1,  1,  1,  1},
+	{ 2,  2,  2,  2,  2,  2,  2,  2,  3,  3,  3,  3,  3,  3,  3,  3},
+	{ 4,  4,  4,  4,  4,  4,  4,  4,  5,  5,  5,  5,  5,  5,  5,  5},
+	{ 6,  6,  6,  6,  6,  6,  6,  6,  7,  7,  7,  7,  7,  7,  7,  7},
+	{ 8,  8,  8,  8,  8,  8,  8,  8,  9,  9,  9,  9,  9,  9,  9,  9},
+	{10, 10, 10, 10, 10, 10, 10, 10, 11, 11, 11, 11, 11, 11, 11, 11},
+	{12, 12, 12, 12, 12, 12, 12, 12, 13, 13, 13, 13, 13, 13, 13, 13},
+	{14, 14, 14, 14, 14, 14, 14, 14, 15, 15, 15, 15, 15, 15, 15, 15},
+};
+
+#define BROADCAST128(p) _mm512_broadcast_i32x4 (_mm_loadu_si128 ((const __m128i *) (p)))
+#define AFFINE(v, matrix) _mm512_gf2p8affine_epi64_epi8 (v, BROADCAST128 (matrix), 0)
+
+/* Expands OP for each register index. The registers are only indexed by constants, so that
+   the compiler can keep x and y in registers. */
+#define FOR_EACH_REGISTER(OP) \
+	OP (0) OP (1) OP (2) OP (3) OP (4) OP (5) OP (6) OP (7)
+
+/* Viewing each 128-bit lane of x[0..7] as an 8 x 16 byte matrix with a 7-bit byte index, one step
+   rotates the index left by one bit. Three steps convert eight registers of whole blocks into the
+   byte-sliced layout; four further steps convert them back. */
+#define TRANSPOSE_STEP() \
+	{ \
+		__m512i t0 = _mm512_unpacklo_epi8 (x[0], x[4]); \
+		__m512i t1 = _mm512_unpackhi_epi8 (x[0], x[4]); \
+		__m512i t2 = _mm512_unpacklo_epi8 (x[1], x[5]); \
+		__m512i t3 = _mm512_unpackhi_epi8 (x[1], x[5]); \
+		__m512i t4 = _mm512_unpacklo_epi8 (x[2], x[6]); \
+		__m512i t5 = _mm512_unpackhi_epi8 (x[2], x[6]); \
+		__m512i t6 = _mm512_unpacklo_epi8 (x[3], x[7]); \
+		__m512i t7 = _mm512_unpackhi_epi8 (x[3], x[7]); \
+		x[0] = t0; x[1] = t1; x[2] = t2; x[3] = t3; \
+		x[4] = t4; x[5] = t5; x[6] = t6; x[7] = t7; \
+	}
+
+#define ADD_KEY_BYTES(m) \
+	x[m] = _mm512_xor_si512 (x[m], _mm512_shuffle_epi8 (key, BROADCAST128 (keyShuffle[m])));
+
+#define ADD_ROUND_KEY(roundKey) \
+	{ \
+		__m512i key = BROADCAST128 (roundKey); \
+		FOR_EACH_REGISTER (ADD_KEY_BYTES) \
+	}
+
+/* VPERMI2B indexes 128 bytes of the table with the low seven bits of each byte; the high bit
+   selects between the two halves of the table. */
+#define SUBSTITUTE_BYTES(m) \
+	x[m] = _mm512_mask_blend_epi8 (_mm512_movepi8_mask (x[m]), \
+		_mm512_permutex2var_epi8 (sbox[0], x[m], sbox[1]), \
+		_mm512_permutex2var_epi8 (sbox[2], x[m], sbox[3]));
+
+/* Output byte j of each block, with the products of the even input bytes in the low and those
+   of the odd input bytes in the high quadwords of the lanes */
+#define LINEAR_ROW(row) \
+	_mm512_xor_si512 ( \
+		_mm512_xor_si512 ( \
+			_mm512_xor_si512 (AFFINE (x[0], row), AFFINE (x[1], row + 2)), \
+			_mm512_xor_si512 (AFFINE (x[2], row + 4), AFFINE (x[3], row + 6))), \
+		_mm512_xor_si512 ( \
+			_mm512_xor_si512 (AFFINE (x[4], row + 8), AFFINE (x[5], row + 10)), \
+			_mm512_xor_si512 (AFFINE (x[6], row + 12), AFFINE (x[7], row + 14))))
+
+#define LINEAR_BYTES(m) \
+	{ \
+		__m512i even = LINEAR_ROW (matrices[2 * (m)]); \
+		__m512i odd = LINEAR_ROW (matrices[2 * (m) + 1]); \
+		y[m] = _mm512_xor_si512 (_mm512_unpacklo_epi64 (even, odd), _mm512_unpackhi_epi64 (even, odd)); \
+	}
+
+#define COPY_BYTES(m) \
+	x[m] = y[m];
+
+/* Applies the L transformation or its inverse to x[0..7] */
+#define LINEAR(lMatrices) \
+	{ \
+		const uint_64t (*matrices)[16] = lMatrices; \
+		FOR_EACH_REGISTER (LINEAR_BYTES) \
+		FOR_EACH_REGISTER (COPY_BYTES) \
+	}
+
+/* The first round key is added before the blocks are sliced */
+#define ENCRYPT_ROUNDS() \
+	for (round = 1; round < 10; ++round) \
+	{ \
+		FOR_EACH_REGISTER (SUBSTITUTE_BYTES) \
+		LINEAR (LTransformationAffineMatrices); \
+		ADD_ROUND_KEY (roundKeys + 2 * round); \
+	}
+
+/* Decryption uses the encryption round keys in reverse order; the last one is added before the
+   blocks are sliced */
+#define DECRYPT_ROUNDS() \
+	for (round = 8; round >= 0; --round) \
+	{ \
+		LINEAR (inversedLTransformationAffineMatrices); \
+		FOR_EACH_REGISTER (SUBSTITUTE_BYTES) \
+		ADD_ROUND_KEY (roundKeys + 2 * round); \
+	}
+
+#define LOAD_BLOCKS(m) \
+	x[m] = _mm512_xor_si512 (_mm512_loadu_si512 ((const __m512i *) in + (m)), firstKey);
+
+#define STORE_BLOCKS(m) \
+	_mm512_storeu_si512 ((__m512i *) out + (m), x[m]);
+
+#define KUZNYECHIK_AVX512_BLOCKS(ROUNDS, FIRST_ROUND_KEY, TABLE, BLOCKS_FUNCTION) \
+	const uint_64t *roundKeys = kds->rke; \
+	__m512i x[KUZNYECHIK_AVX512_REGISTER_COUNT], y[KUZNYECHIK_AVX512_REGISTER_COUNT], sbox[4], firstKey; \
+	int round; \
+	\
+	sbox[0] = _mm512_loadu_si512 ((const __m512i *) TABLE); \
+	sbox[1] = _mm512_loadu_si512 ((const __m512i *) TABLE + 1); \
+	sbox[2] = _mm512_loadu_si512 ((const __m512i *) TABLE + 2); \
+	sbox[3] = _mm512_loadu_si512 ((const __m512i *) TABLE + 3); \
+	firstKey = BROADCAST128 (roundKeys + 2 * (FIRST_ROUND_KEY)); \
+	\
+	while (blocks >= KUZNYECHIK_AVX512_PARALLEL_BLOCKS) \
+	{ \
+		FOR_EACH_REGISTER (LOAD_BLOCKS) \
+		TRANSPOSE_STEP(); \
+		TRANSPOSE_STEP(); \
+		TRANSPOSE_STEP(); \
+		\
+		ROUNDS(); \
+		\
+		TRANSPOSE_STEP(); \
+		TRANSPOSE_STEP(); \
+		TRANSPOSE_STEP(); \
+		TRANSPOSE_STEP(); \
+		FOR_EACH_REGISTER (STORE_BLOCKS) \
+		\
+		in += KUZNYECHIK_AVX512_PARALLEL_BLOCKS * 16; \
+		out += KUZNYECHIK_AVX512_PARALLEL_BLOCKS * 16; \
+		blocks -= KUZNYECHIK_AVX512_PARALLEL_BLOCKS; \
+	} \
+	\
+	if (blocks > 0) \
+		BLOCKS_FUNCTION (out, in, blocks, kds);
+
+void kuznyechik_avx512_encrypt_blocks (byte* out, const byte* in, size_t blocks, kuznyechik_kds* kds)
+{
+	KUZNYECHIK_AVX512_BLOCKS (ENCRYPT_ROUNDS, 0, Pi, kuznyechik_encrypt_blocks);
+}
+
+void kuznyechik_avx512_decrypt_blocks (byte* out, const byte* in, size_t blocks, kuznyechik_kds* kds)
+{
+	KUZNYECHIK_AVX512_BLOCKS (DECRYPT_ROUNDS, 9, InversedPi, kuznyechik_decrypt_blocks);
+}
+
+#else // The compiler does not support AVX-512 VBMI and GFNI
+
+void kuznyechik_avx512_encrypt_blocks (byte* out, const byte* in, size_t blocks, kuznyechik_kds* kds)
+{
+	kuznyechik_encrypt_blocks (out, in, blocks, kds);
+}
+
+void kuznyechik_avx512_decrypt_blocks (byte* out, const byte* in, size_t blocks, kuznyechik_kds* kds)
+{
+	kuznyechik_decrypt_blocks (out, in, blocks, kds);
+}
+
+#endif
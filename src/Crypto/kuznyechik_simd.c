@@ -184,6 +184,80 @@ CRYPTOPP_ALIGN_DATA(16) const uint_8t inversedLTransformationMatrix[16][16] CRYP
 	{0x94, 0x84, 0xdd, 0x10, 0xbd, 0x27, 0x5d, 0xb8, 0x7a, 0x48, 0x6c, 0x72, 0x76, 0xa2, 0x6e, 0xcf,},
 };
 
+/** GF(2) affine transformation matrices (in the operand format of GF2P8AFFINEQB) of the multiplications
+    by the coefficients of the L transformation. Row j holds the matrices applied to the input bytes
+    0..15 that contribute to output byte j, so that output byte j is the XOR of all 16 products. */
+CRYPTOPP_ALIGN_DATA(16) const uint_64t LTransformationAffineMatrices[16][16] CRYPTOPP_SECTION_ALIGN16 = {
+	{LL(0xfb0d1b376edc437d), LL(0x66aa54a953a62a33), LL(0xc44c993265cb5362), LL(0xff0103070f1fc07f), LL(0x878912244992a2c3), LL(0x96bb77efdebcee4b), LL(0x3257ae5cb973d599), LL(0x3355aa54a9539519),
+	 LL(0xe02142850a14c870), LL(0xff0103070f1fc07f), LL(0xf2172f5ebd7b05f9), LL(0x0f10204182050407), LL(0xe2274e9d3a7509f1), LL(0x96bb77efdebcee4b), LL(0xcd56ad5bb66c15e6), LL(0x94bd7bf7eedd2fca)},
+	{LL(0x94bd7bf7eedd2fca), LL(0xd868d0a04081da6c), LL(0x9aaf5fbe7cf86b4d), LL(0x8a9f3e7dfbf66745), LL(0x060a142851a24283), LL(0x0c142851a2448506), LL(0xd778f0e1c284de6b), LL(0xa6ead5ab57aefa53),
+	 LL(0xdb6cd8b060c05b6d), LL(0x749c3972e4c9e7ba), LL(0xbec284091327f05f), LL(0x798a152b56ad223c), LL(0xf61b376edcb886fb), LL(0xacf4e9d2a4483dd6), LL(0x6abe7cf8f1e2af35), LL(0xee3366cc98318cf7)},
+	{LL(0xee3366cc98318cf7), LL(0xbace9c3972e4735d), LL(0xf7193366cc98c67b), LL(0x040c183061c38302), LL(0xd47cf8f1e2c55f6a), LL(0xed376edcb8700df6), LL(0x103061c3870e0c08), LL(0x394b962d5ab5529c),
+	 LL(0x6fb060c080016cb7), LL(0x355fbe7cf8f1d79a), LL(0x68b870e0c1836eb4), LL(0x55fffefdfaf5bf2a), LL(0x2769d3a74f9e1a13), LL(0x68b870e0c1836eb4), LL(0x83850a14285121c1), LL(0x44cd9b366ddbf3a2)},
+	{LL(0x44cd9b366ddbf3a2), LL(0xe93b76ecd9b38ef4), LL(0xb0d0a0408102b4d8), LL(0xa0e0c183060cb8d0), LL(0x103061c3870e0c08), LL(0xb1d2a4489122f458), LL(0x2a7ffffefdfadf95), LL(0x54fdfaf5ead5ffaa),
+	 LL(0x2e73e7ce9c395c97), LL(0x2b7dfbf6edda9f15), LL(0xf2172f5ebd7b05f9), LL(0x0d162c59b264c586), LL(0x41c3870e1c383020), LL(0x70902142850a64b8), LL(0x62a64c993265a931), LL(0x848d1a3469d323c2)},
+	{LL(0x848d1a3469d323c2), LL(0x3257ae5cb973d599), LL(0x55fffefdfaf5bf2a), LL(0x3a4f9e3d7af4d39d), LL(0xd868d0a04081da6c), LL(0xe3254a952a554971), LL(0x808102040810a0c0), LL(0xaef2e5ca9429fc57),
+	 LL(0x173871e3c68c0e0b), LL(0xaafefdfaf5ea7f55), LL(0x1a2e5dba74e8cb8d), LL(0x0102040810204080), LL(0x759e3d7af4e9a73a), LL(0xcb5cb973e7ce5765), LL(0xcc54a953a64c5566), LL(0x143c79f3e6cd8f0a)},
+	{LL(0x143c79f3e6cd8f0a), LL(0x44cd9b366ddbf3a2), LL(0xa2e6cd9b366d7951), LL(0xa0e0c183060cb8d0), LL(0x1b2c59b264c88b0d), LL(0x7e82050b172f203f), LL(0x4fd1a3478e1d74a7), LL(0x94bd7bf7eedd2fca),
+	 LL(0xef3162c48811cc77), LL(0x0304081020418101), LL(0x060a142851a24283), LL(0xbcc48811234631de), LL(0x2061c3870e1c1810), LL(0x808102040810a0c0), LL(0x5beddab468d0fbad), LL(0x0c142851a2448506)},
+	{LL(0x0c142851a2448506), LL(0xabfcf9f2e5ca3fd5), LL(0x345dba74e8d1971a), LL(0xf113274e9d3a84f8), LL(0x40c183060c1870a0), LL(0x798a152b56ad223c), LL(0x1a2e5dba74e8cb8d), LL(0x43c58b162c59f1a1),
+	 LL(0xabfcf9f2e5ca3fd5), LL(0xe3254a952a554971), LL(0x67a850a143866ab3), LL(0x64ac58b163c7ebb2), LL(0x5ce5ca942952f9ae), LL(0x73942952a54be5b9), LL(0xf01123468d1ac478), LL(0xe42d5ab56bd74b72)},
+	{LL(0xe42d5ab56bd74b72), LL(0x42c78f1e3c79b121), LL(0x4cd5ab57ae5cf5a6), LL(0x50f1e2c58b167ca8), LL(0x3f4182050b17101f), LL(0xf80913274e9dc27c), LL(0xb3d4a850a14335d9), LL(0xfe03070f1f3f80ff),
+	 LL(0xaafefdfaf5ea7f55), LL(0x4fd1a3478e1d74a7), LL(0x297bf7eeddbb5e94), LL(0xdf60c0800103d86f), LL(0xaafefdfaf5ea7f55), LL(0x384992254a95121c), LL(0x94bd7bf7eedd2fca), LL(0xbec284091327f05f)},
+	{LL(0xbec284091327f05f), LL(0x0d162c59b264c586), LL(0xf7193366cc98c67b), LL(0x70902142850a64b8), LL(0x3b4d9a356ad4931d), LL(0x173871e3c68c0e0b), LL(0x8f9122458a15a4c7), LL(0x0d162c59b264c586),
+	 LL(0x61a2448912242830), LL(0x143c79f3e6cd8f0a), LL(0x384992254a95121c), LL(0x0102040810204080), LL(0xb4dcb870e0c137da), LL(0x96bb77efdebcee4b), LL(0x8d972e5dba746546), LL(0x7d860d1b376ea13e)},
+	{LL(0x7d860d1b376ea13e), LL(0xaafefdfaf5ea7f55), LL(0xbec284091327f05f), LL(0xf90b172f5ebd82fc), LL(0x173871e3c68c0e0b), LL(0x3051a24489121418), LL(0x2267cf9f3e7dd991), LL(0xf2172f5ebd7b05f9),
+	 LL(0x60a04081020468b0), LL(0x1c244992254a890e), LL(0x2163c78f1e3c5890), LL(0x3355aa54a9539519), LL(0x66aa54a953a62a33), LL(0xbace9c3972e4735d), LL(0x256fdfbf7fffdb92), LL(0x99ab57ae5cb9ea4c)},
+	{LL(0x99ab57ae5cb9ea4c), LL(0x2769d3a74f9e1a13), LL(0xfe03070f1f3f80ff), LL(0xd47cf8f1e2c55f6a), LL(0x50f1e2c58b167ca8), LL(0xa4ecd9b367cf3bd2), LL(0xcf50a143860dd467), LL(0xbbcc983162c433dd),
+	 LL(0x769a356ad4a8263b), LL(0xf90b172f5ebd82fc), LL(0xe3254a952a554971), LL(0x92b76fdfbf7f6d49), LL(0x9aaf5fbe7cf86b4d), LL(0x0c142851a2448506), LL(0xee3366cc98318cf7), LL(0x7f800103070f60bf)},
+	{LL(0x7f800103070f60bf), LL(0xc7489122458ad263), LL(0xfc050b172f5e417e), LL(0x68b870e0c1836eb4), LL(0x63a448912245e9b1), LL(0xb4dcb870e0c137da), LL(0xff0103070f1fc07f), LL(0xb0d0a0408102b4d8),
+	 LL(0x2365cb972e5d9911), LL(0x091a3469d3a74684), LL(0xa2e6cd9b366d7951), LL(0x0708102041820203), LL(0x256fdfbf7fffdb92), LL(0x0c142851a2448506), LL(0xd778f0e1c284de6b), LL(0xb0d0a0408102b4d8)},
+	{LL(0xb0d0a0408102b4d8), LL(0x63a448912245e9b1), LL(0x6abe7cf8f1e2af35), LL(0x0b1c3871e3c68705), LL(0x3355aa54a9539519), LL(0xc64a952a55aa92e3), LL(0xc95ab56bd7af96e4), LL(0x4fd1a3478e1d74a7),
+	 LL(0xe52f5ebd7bf70bf2), LL(0x93b56bd7af5f2dc9), LL(0x749c3972e4c9e7ba), LL(0x0708102041820203), LL(0x5ce5ca942952f9ae), LL(0xd276ecd9b3671de9), LL(0xa1e2c58b162cf850), LL(0xcb5cb973e7ce5765)},
+	{LL(0xcb5cb973e7ce5765), LL(0x67a850a143866ab3), LL(0xc54e9d3a75eb13e2), LL(0x3a4f9e3d7af4d39d), LL(0x47c993264d9a72a3), LL(0xacf4e9d2a4483dd6), LL(0x3c458a152b56911e), LL(0x02060c183061c181),
+	 LL(0x68b870e0c1836eb4), LL(0x2e73e7ce9c395c97), LL(0x69ba74e8d1a32e34), LL(0xeb3d7af4e9d24f75), LL(0x4bddbb77efdef7a5), LL(0x0c142851a2448506), LL(0x749c3972e4c9e7ba), LL(0x769a356ad4a8263b)},
+	{LL(0x769a356ad4a8263b), LL(0x798a152b56ad223c), LL(0xc44c993265cb5362), LL(0x46cb972e5dba3223), LL(0x7d860d1b376ea13e), LL(0x45cf9f3e7dfbb322), LL(0x95bf7ffffefd6f4a), LL(0x4adfbf7ffffeb725),
+	 LL(0x1c244992254a890e), LL(0x1e22458a152b488f), LL(0x173871e3c68c0e0b), LL(0x6bbc78f0e1c2efb5), LL(0xacf4e9d2a4483dd6), LL(0xc858b163c78fd664), LL(0xaff0e1c28409bcd7), LL(0xc64a952a55aa92e3)},
+	{LL(0xc64a952a55aa92e3), LL(0xd868d0a04081da6c), LL(0x77983162c48866bb), LL(0xb0d0a0408102b4d8), LL(0x5aefdebc78f0bb2d), LL(0xda6edcb870e01bed), LL(0x0102040810204080), LL(0x53f5ead5ab57fda9),
+	 LL(0x0102040810204080), LL(0xda6edcb870e01bed), LL(0x5aefdebc78f0bb2d), LL(0xb0d0a0408102b4d8), LL(0x77983162c48866bb), LL(0xd868d0a04081da6c), LL(0xc64a952a55aa92e3), LL(0x0102040810204080)},
+};
+
+/** GF(2) affine transformation matrices of the multiplications by the coefficients of the inversed L transformation. */
+CRYPTOPP_ALIGN_DATA(16) const uint_64t inversedLTransformationAffineMatrices[16][16] CRYPTOPP_SECTION_ALIGN16 = {
+	{LL(0x0102040810204080), LL(0xc64a952a55aa92e3), LL(0xd868d0a04081da6c), LL(0x77983162c48866bb), LL(0xb0d0a0408102b4d8), LL(0x5aefdebc78f0bb2d), LL(0xda6edcb870e01bed), LL(0x0102040810204080),
+	 LL(0x53f5ead5ab57fda9), LL(0x0102040810204080), LL(0xda6edcb870e01bed), LL(0x5aefdebc78f0bb2d), LL(0xb0d0a0408102b4d8), LL(0x77983162c48866bb), LL(0xd868d0a04081da6c), LL(0xc64a952a55aa92e3)},
+	{LL(0xc64a952a55aa92e3), LL(0xaff0e1c28409bcd7), LL(0xc858b163c78fd664), LL(0xacf4e9d2a4483dd6), LL(0x6bbc78f0e1c2efb5), LL(0x173871e3c68c0e0b), LL(0x1e22458a152b488f), LL(0x1c244992254a890e),
+	 LL(0x4adfbf7ffffeb725), LL(0x95bf7ffffefd6f4a), LL(0x45cf9f3e7dfbb322), LL(0x7d860d1b376ea13e), LL(0x46cb972e5dba3223), LL(0xc44c993265cb5362), LL(0x798a152b56ad223c), LL(0x769a356ad4a8263b)},
+	{LL(0x769a356ad4a8263b), LL(0x749c3972e4c9e7ba), LL(0x0c142851a2448506), LL(0x4bddbb77efdef7a5), LL(0xeb3d7af4e9d24f75), LL(0x69ba74e8d1a32e34), LL(0x2e73e7ce9c395c97), LL(0x68b870e0c1836eb4),
+	 LL(0x02060c183061c181), LL(0x3c458a152b56911e), LL(0xacf4e9d2a4483dd6), LL(0x47c993264d9a72a3), LL(0x3a4f9e3d7af4d39d), LL(0xc54e9d3a75eb13e2), LL(0x67a850a143866ab3), LL(0xcb5cb973e7ce5765)},
+	{LL(0xcb5cb973e7ce5765), LL(0xa1e2c58b162cf850), LL(0xd276ecd9b3671de9), LL(0x5ce5ca942952f9ae), LL(0x0708102041820203), LL(0x749c3972e4c9e7ba), LL(0x93b56bd7af5f2dc9), LL(0xe52f5ebd7bf70bf2),
+	 LL(0x4fd1a3478e1d74a7), LL(0xc95ab56bd7af96e4), LL(0xc64a952a55aa92e3), LL(0x3355aa54a9539519), LL(0x0b1c3871e3c68705), LL(0x6abe7cf8f1e2af35), LL(0x63a448912245e9b1), LL(0xb0d0a0408102b4d8)},
+	{LL(0xb0d0a0408102b4d8), LL(0xd778f0e1c284de6b), LL(0x0c142851a2448506), LL(0x256fdfbf7fffdb92), LL(0x0708102041820203), LL(0xa2e6cd9b366d7951), LL(0x091a3469d3a74684), LL(0x2365cb972e5d9911),
+	 LL(0xb0d0a0408102b4d8), LL(0xff0103070f1fc07f), LL(0xb4dcb870e0c137da), LL(0x63a448912245e9b1), LL(0x68b870e0c1836eb4), LL(0xfc050b172f5e417e), LL(0xc7489122458ad263), LL(0x7f800103070f60bf)},
+	{LL(0x7f800103070f60bf), LL(0xee3366cc98318cf7), LL(0x0c142851a2448506), LL(0x9aaf5fbe7cf86b4d), LL(0x92b76fdfbf7f6d49), LL(0xe3254a952a554971), LL(0xf90b172f5ebd82fc), LL(0x769a356ad4a8263b),
+	 LL(0xbbcc983162c433dd), LL(0xcf50a143860dd467), LL(0xa4ecd9b367cf3bd2), LL(0x50f1e2c58b167ca8), LL(0xd47cf8f1e2c55f6a), LL(0xfe03070f1f3f80ff), LL(0x2769d3a74f9e1a13), LL(0x99ab57ae5cb9ea4c)},
+	{LL(0x99ab57ae5cb9ea4c), LL(0x256fdfbf7fffdb92), LL(0xbace9c3972e4735d), LL(0x66aa54a953a62a33), LL(0x3355aa54a9539519), LL(0x2163c78f1e3c5890), LL(0x1c244992254a890e), LL(0x60a04081020468b0),
+	 LL(0xf2172f5ebd7b05f9), LL(0x2267cf9f3e7dd991), LL(0x3051a24489121418), LL(0x173871e3c68c0e0b), LL(0xf90b172f5ebd82fc), LL(0xbec284091327f05f), LL(0xaafefdfaf5ea7f55), LL(0x7d860d1b376ea13e)},
+	{LL(0x7d860d1b376ea13e), LL(0x8d972e5dba746546), LL(0x96bb77efdebcee4b), LL(0xb4dcb870e0c137da), LL(0x0102040810204080), LL(0x384992254a95121c), LL(0x143c79f3e6cd8f0a), LL(0x61a2448912242830),
+	 LL(0x0d162c59b264c586), LL(0x8f9122458a15a4c7), LL(0x173871e3c68c0e0b), LL(0x3b4d9a356ad4931d), LL(0x70902142850a64b8), LL(0xf7193366cc98c67b), LL(0x0d162c59b264c586), LL(0xbec284091327f05f)},
+	{LL(0xbec284091327f05f), LL(0x94bd7bf7eedd2fca), LL(0x384992254a95121c), LL(0xaafefdfaf5ea7f55), LL(0xdf60c0800103d86f), LL(0x297bf7eeddbb5e94), LL(0x4fd1a3478e1d74a7), LL(0xaafefdfaf5ea7f55),
+	 LL(0xfe03070f1f3f80ff), LL(0xb3d4a850a14335d9), LL(0xf80913274e9dc27c), LL(0x3f4182050b17101f), LL(0x50f1e2c58b167ca8), LL(0x4cd5ab57ae5cf5a6), LL(0x42c78f1e3c79b121), LL(0xe42d5ab56bd74b72)},
+	{LL(0xe42d5ab56bd74b72), LL(0xf01123468d1ac478), LL(0x73942952a54be5b9), LL(0x5ce5ca942952f9ae), LL(0x64ac58b163c7ebb2), LL(0x67a850a143866ab3), LL(0xe3254a952a554971), LL(0xabfcf9f2e5ca3fd5),
+	 LL(0x43c58b162c59f1a1), LL(0x1a2e5dba74e8cb8d), LL(0x798a152b56ad223c), LL(0x40c183060c1870a0), LL(0xf113274e9d3a84f8), LL(0x345dba74e8d1971a), LL(0xabfcf9f2e5ca3fd5), LL(0x0c142851a2448506)},
+	{LL(0x0c142851a2448506), LL(0x5beddab468d0fbad), LL(0x808102040810a0c0), LL(0x2061c3870e1c1810), LL(0xbcc48811234631de), LL(0x060a142851a24283), LL(0x0304081020418101), LL(0xef3162c48811cc77),
+	 LL(0x94bd7bf7eedd2fca), LL(0x4fd1a3478e1d74a7), LL(0x7e82050b172f203f), LL(0x1b2c59b264c88b0d), LL(0xa0e0c183060cb8d0), LL(0xa2e6cd9b366d7951), LL(0x44cd9b366ddbf3a2), LL(0x143c79f3e6cd8f0a)},
+	{LL(0x143c79f3e6cd8f0a), LL(0xcc54a953a64c5566), LL(0xcb5cb973e7ce5765), LL(0x759e3d7af4e9a73a), LL(0x0102040810204080), LL(0x1a2e5dba74e8cb8d), LL(0xaafefdfaf5ea7f55), LL(0x173871e3c68c0e0b),
+	 LL(0xaef2e5ca9429fc57), LL(0x808102040810a0c0), LL(0xe3254a952a554971), LL(0xd868d0a04081da6c), LL(0x3a4f9e3d7af4d39d), LL(0x55fffefdfaf5bf2a), LL(0x3257ae5cb973d599), LL(0x848d1a3469d323c2)},
+	{LL(0x848d1a3469d323c2), LL(0x62a64c993265a931), LL(0x70902142850a64b8), LL(0x41c3870e1c383020), LL(0x0d162c59b264c586), LL(0xf2172f5ebd7b05f9), LL(0x2b7dfbf6edda9f15), LL(0x2e73e7ce9c395c97),
+	 LL(0x54fdfaf5ead5ffaa), LL(0x2a7ffffefdfadf95), LL(0xb1d2a4489122f458), LL(0x103061c3870e0c08), LL(0xa0e0c183060cb8d0), LL(0xb0d0a0408102b4d8), LL(0xe93b76ecd9b38ef4), LL(0x44cd9b366ddbf3a2)},
+	{LL(0x44cd9b366ddbf3a2), LL(0x83850a14285121c1), LL(0x68b870e0c1836eb4), LL(0x2769d3a74f9e1a13), LL(0x55fffefdfaf5bf2a), LL(0x68b870e0c1836eb4), LL(0x355fbe7cf8f1d79a), LL(0x6fb060c080016cb7),
+	 LL(0x394b962d5ab5529c), LL(0x103061c3870e0c08), LL(0xed376edcb8700df6), LL(0xd47cf8f1e2c55f6a), LL(0x040c183061c38302), LL(0xf7193366cc98c67b), LL(0xbace9c3972e4735d), LL(0xee3366cc98318cf7)},
+	{LL(0xee3366cc98318cf7), LL(0x6abe7cf8f1e2af35), LL(0xacf4e9d2a4483dd6), LL(0xf61b376edcb886fb), LL(0x798a152b56ad223c), LL(0xbec284091327f05f), LL(0x749c3972e4c9e7ba), LL(0xdb6cd8b060c05b6d),
+	 LL(0xa6ead5ab57aefa53), LL(0xd778f0e1c284de6b), LL(0x0c142851a2448506), LL(0x060a142851a24283), LL(0x8a9f3e7dfbf66745), LL(0x9aaf5fbe7cf86b4d), LL(0xd868d0a04081da6c), LL(0x94bd7bf7eedd2fca)},
+	{LL(0x94bd7bf7eedd2fca), LL(0xcd56ad5bb66c15e6), LL(0x96bb77efdebcee4b), LL(0xe2274e9d3a7509f1), LL(0x0f10204182050407), LL(0xf2172f5ebd7b05f9), LL(0xff0103070f1fc07f), LL(0xe02142850a14c870),
+	 LL(0x3355aa54a9539519), LL(0x3257ae5cb973d599), LL(0x96bb77efdebcee4b), LL(0x878912244992a2c3), LL(0xff0103070f1fc07f), LL(0xc44c993265cb5362), LL(0x66aa54a953a62a33), LL(0xfb0d1b376edc437d)},
+};
+
 CRYPTOPP_ALIGN_DATA(16) const uint_8t bitmask[16] CRYPTOPP_SECTION_ALIGN16 = {
 	0x00, 0xff, 0x00, 0xff, 0x00, 0xff, 0x00, 0xff, 0x00, 0xff, 0x00, 0xff, 0x00, 0xff, 0x00, 0xff,
 };
@@ -0,0 +1,270 @@
+/*
+ Copyright (c) 2013-2017 IDRIX. All rights reserved.
+
+ Governed by the Apache License 2.0 the full text of which is
+ contained in the file License.txt included in VeraCrypt binary and source
+ code distribution packages.
+*/
+
+#include <string.h>
+#include <sys/mman.h>
+#include "FuseReadAhead.h"
+
+namespace VeraCrypt
+{
+	FuseReadAhead::FuseReadAhead (shared_ptr <Volume> volume, size_t windowSize)
+		: HitCount (0), MemoryLocked (false), SequentialReadCount (0), StopPending (false), StreamEnd (0), MountedVolume (volume)
+	{
+		if (!MountedVolume)
+			throw ParameterIncorrect (SRC_POS);
+
+		VolumeSize = MountedVolume->GetSize();
+		BlockCount = (VolumeSize + BlockSize - 1) / BlockSize;
+
+		Slots.resize (max ((size_t) 2, windowSize / BlockSize));
+		WindowSize = Slots.size() * BlockSize;
+
+		// Blocks are read into the ring without copying if the volume file is opened for direct I/O
+		Ring.Allocate (WindowSize, File::MaxDirectIoAlignment);
+
+		// Plaintext of the volume must not be written to the swap space
+		MemoryLocked = (mlock (Ring.Ptr(), Ring.Size()) == 0);
+
+		for (size_t i = 0; i < Slots.size(); ++i)
+			Slots[i].Data = Ring.Ptr() + i * BlockSize;
+
+		struct LoaderFunctor : public Functor
+		{
+			LoaderFunctor (FuseReadAhead &readAhead) : ReadAhead (readAhead) { }
+
+			virtual void operator() ()
+			{
+				ReadAhead.LoaderThreadProc();
+			}
+
+			FuseReadAhead &ReadAhead;
+		};
+
+		LoaderThread.Start (new LoaderFunctor (*this));
+	}
+
+	FuseReadAhead::~FuseReadAhead ()
+	{
+		try
+		{
+			{
+				ScopeLock lock (SlotMutex);
+				StopPending = true;
+			}
+
+			LoadQueueEvent.Signal();
+			LoaderThread.Join();
+		}
+		catch (...) { }
+
+		if (MemoryLocked)
+			munlock (Ring.Ptr(), Ring.Size());
+	}
+
+	void FuseReadAhead::Invalidate (uint64 byteOffset, uint64 length)
+	{
+		ScopeLock lock (SlotMutex);
+
+		for (size_t i = 0; i < Slots.size(); ++i)
+		{
+			Slot &slot = Slots[i];
+			uint64 slotOffset = slot.Block * BlockSize;
+
+			if (slot.State == SlotState::Empty || slotOffset >= byteOffset + length || slotOffset + slot.DataSize <= byteOffset)
+				continue;
+
+			// Data of a block being loaded may precede the write, and queued blocks are loaded later
+			if (slot.State == SlotState::Loading)
+				slot.Invalidated = true;
+			else if (slot.State == SlotState::Ready)
+				slot.State = SlotState::Empty;
+		}
+	}
+
+	void FuseReadAhead::LoaderThreadProc ()
+	{
+		ScopeLock lock (SlotMutex);
+
+		while (!StopPending)
+		{
+			if (LoadQueue.empty())
+			{
+				SlotMutex.Unlock();
+				LoadQueueEvent.Wait();
+				SlotMutex.Lock();
+				continue;
+			}
+
+			uint64 block = LoadQueue.front();
+			LoadQueue.pop_front();
+
+			Slot &slot = GetSlot (block);
+			if (slot.Block != block || slot.State != SlotState::Queued)
+				continue;
+
+			slot.State = SlotState::Loading;
+			slot.Invalidated = false;
+
+			bool loaded = false;
+			SlotMutex.Unlock();
+
+			try
+			{
+				MountedVolume->ReadSectors (BufferPtr (slot.Data, slot.DataSize), block * BlockSize);
+				loaded = true;
+			}
+			catch (...)
+			{
+				// Reads of the block are left to the consumer, which reports the error
+			}
+
+			SlotMutex.Lock();
+
+			slot.State = (loaded && !slot.Invalidated) ? SlotState::Ready : SlotState::Empty;
+			SignalWaiters (slot);
+		}
+	}
+
+	void FuseReadAhead::QueueBlocks (uint64 firstBlock, uint64 endBlock)
+	{
+		bool blocksQueued = false;
+
+		for (uint64 block = firstBlock; block < endBlock; ++block)
+		{
+			Slot &slot = GetSlot (block);
+
+			if (slot.Block == block && slot.State != SlotState::Empty)
+				continue;
+
+			// The slot cannot be reused until the load of its previous block completes and
+			// readers copying from it finish. The block is queued again by a later read.
+			if (slot.State == SlotState::Loading || slot.ReaderCount > 0)
+				continue;
+
+			if (slot.State == SlotState::Queued)
+				SignalWaiters (slot);
+
+			slot.Block = block;
+			slot.DataSize = (size_t) min ((uint64) BlockSize, VolumeSize - block * BlockSize);
+			slot.State = SlotState::Queued;
+
+			LoadQueue.push_back (block);
+			blocksQueued = true;
+		}
+
+		if (blocksQueued)
+			LoadQueueEvent.Signal();
+	}
+
+	bool FuseReadAhead::Read (const BufferPtr &buffer, uint64 byteOffset)
+	{
+		uint64 endOffset = byteOffset + buffer.Size();
+
+		if (buffer.Size() == 0 || endOffset > VolumeSize)
+			return false;
+
+		uint64 firstBlock = byteOffset / BlockSize;
+		uint64 lastBlock = (endOffset - 1) / BlockSize;
+
+		ScopeLock lock (SlotMutex);
+
+		// Requests of a sequential stream may be served out of order by concurrent threads
+		if (byteOffset + WindowSize >= StreamEnd && byteOffset <= StreamEnd + BlockSize)
+		{
+			if (SequentialReadCount < MinSequentialReads)
+				++SequentialReadCount;
+
+			StreamEnd = max (StreamEnd, endOffset);
+		}
+		else
+		{
+			SequentialReadCount = 1;
+			StreamEnd = endOffset;
+		}
+
+		if (SequentialReadCount >= MinSequentialReads)
+			QueueBlocks (StreamEnd / BlockSize, min (firstBlock + Slots.size(), BlockCount));
+
+		if (lastBlock - firstBlock >= Slots.size())
+			return false;
+
+		for (uint64 block = firstBlock; block <= lastBlock; ++block)
+		{
+			Slot &slot = GetSlot (block);
+
+			while (slot.Block == block && (slot.State == SlotState::Queued || slot.State == SlotState::Loading))
+				WaitForSlot (slot);
+
+			if (slot.Block != block || slot.State != SlotState::Ready)
+				return false;
+		}
+
+		// Blocks checked before waiting for a later block may have been replaced or invalidated
+		for (uint64 block = firstBlock; block <= lastBlock; ++block)
+		{
+			Slot &slot = GetSlot (block);
+
+			if (slot.Block != block || slot.State != SlotState::Ready)
+				return false;
+		}
+
+		// Pinned slots are not reused, which allows other readers and the loader to proceed during the copy
+		for (uint64 block = firstBlock; block <= lastBlock; ++block)
+			++GetSlot (block).ReaderCount;
+
+		SlotMutex.Unlock();
+
+		for (uint64 block = firstBlock; block <= lastBlock; ++block)
+		{
+			Slot &slot = GetSlot (block);
+			uint64 blockOffset = block * BlockSize;
+			uint64 copyStart = max (byteOffset, blockOffset);
+			uint64 copyEnd = min (endOffset, blockOffset + slot.DataSize);
+
+			memcpy (buffer.Get() + (copyStart - byteOffset), slot.Data + (copyStart - blockOffset), (size_t) (copyEnd - copyStart));
+		}
+
+		SlotMutex.Lock();
+
+		for (uint64 block = firstBlock; block <= lastBlock; ++block)
+			--GetSlot (block).ReaderCount;
+
+		++HitCount;
+		return true;
+	}
+
+	void FuseReadAhead::SignalWaiters (Slot &slot)
+	{
+		foreach (SyncEvent *waiter, slot.Waiters)
+			waiter->Signal();
+
+		slot.Waiters.clear();
+	}
+
+	void FuseReadAhead::WaitForSlot (Slot &slot)
+	{
+		// Every waiter has its own event since several readers may wait for the same block
+		SyncEvent loadedEvent;
+		slot.Waiters.push_back (&loadedEvent);
+
+		SlotMutex.Unlock();
+
+		try
+		{
+			loadedEvent.Wait();
+		}
+		catch (...)
+		{
+			SlotMutex.Lock();
+			slot.Waiters.remove (&loadedEvent);
+			throw;
+		}
+
+		SlotMutex.Lock();
+	}
+}
@@ -0,0 +1,91 @@
+/*
+ Copyright (c) 2013-2017 IDRIX. All rights reserved.
+
+ Governed by the Apache License 2.0 the full text of which is
+ contained in the file License.txt included in VeraCrypt binary and source
+ code distribution packages.
+*/
+
+#ifndef TC_HEADER_Driver_Fuse_FuseReadAhead
+#define TC_HEADER_Driver_Fuse_FuseReadAhead
+
+#include <atomic>
+#include "Platform/Platform.h"
+#include "Volume/Volume.h"
+
+namespace VeraCrypt
+{
+	// Reads ahead of sequential reads of the volume image. The window following a sequential
+	// stream is divided into blocks, which a separate thread reads with Volume::ReadSectors,
+	// overlapping host reads with decryption on the encryption thread pool. Each block is
+	// loaded into the slot of a ring of memory-locked buffers selected by its number, and
+	// reads covered by loaded blocks are served from the ring.
+	class FuseReadAhead
+	{
+	public:
+		FuseReadAhead (shared_ptr <Volume> volume, size_t windowSize);
+		virtual ~FuseReadAhead ();
+
+		uint64 GetHitCount () const { return HitCount; }
+		void Invalidate (uint64 byteOffset, uint64 length);
+		bool Read (const BufferPtr &buffer, uint64 byteOffset);
+
+		static const size_t BlockSize = 512 * 1024;
+
+		// Number of consecutive sequential reads after which the window is read ahead
+		static const size_t MinSequentialReads = 2;
+
+	protected:
+		struct SlotState
+		{
+			enum Enum
+			{
+				Empty,
+				Queued,
+				Loading,
+				Ready
+			};
+		};
+
+		struct Slot
+		{
+			Slot () : Block (0), Data (nullptr), DataSize (0), Invalidated (false), ReaderCount (0), State (SlotState::Empty) { }
+
+			uint64 Block;
+			byte *Data;
+			size_t DataSize;
+			bool Invalidated;
+			size_t ReaderCount;
+			SlotState::Enum State;
+			list <SyncEvent *> Waiters;
+		};
+
+		Slot &GetSlot (uint64 block) { return Slots[block % Slots.size()]; }
+		void LoaderThreadProc ();
+		void QueueBlocks (uint64 firstBlock, uint64 endBlock);
+		void SignalWaiters (Slot &slot);
+		void WaitForSlot (Slot &slot);
+
+		uint64 BlockCount;
+		atomic <uint64> HitCount;
+		list <uint64> LoadQueue;
+		SyncEvent LoadQueueEvent;
+		Thread LoaderThread;
+		bool MemoryLocked;
+		SecureBuffer Ring;
+		size_t SequentialReadCount;
+		vector <Slot> Slots;
+		Mutex SlotMutex;
+		bool StopPending;
+		uint64 StreamEnd;
+		shared_ptr <Volume> MountedVolume;
+		uint64 VolumeSize;
+		size_t WindowSize;
+
+	private:
+		FuseReadAhead (const FuseReadAhead &);
+		FuseReadAhead &operator= (const FuseReadAhead &);
+	};
+}
+
+#endif // TC_HEADER_Driver_Fuse_FuseReadAhead
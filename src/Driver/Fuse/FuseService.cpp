@@ -10,7 +10,11 @@
  code distribution packages.
 */
 
-#ifdef TC_OPENBSD
+#if defined (TC_FUSE3) && defined (TC_FUSE3_LOOP_CFG)
+#define FUSE_USE_VERSION  312
+#elif defined (TC_FUSE3)
+#define FUSE_USE_VERSION  32
+#elif defined (TC_OPENBSD)
 #define FUSE_USE_VERSION  26
 #else
 #define FUSE_USE_VERSION  25
@@ -18,7 +22,11 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#ifdef TC_FUSE3
+#include <fuse_lowlevel.h>
+#else
 #include <fuse.h>
+#endif
 #include <iostream>
 #include <signal.h>
 #include <string.h>
@@ -29,6 +37,7 @@
 #include <sys/time.h>
 #include <sys/wait.h>
 
+#include "FuseReadAhead.h"
 #include "FuseService.h"
 #include "Platform/FileStream.h"
 #include "Platform/MemoryStream.h"
@@ -41,26 +50,7 @@
 
 namespace VeraCrypt
 {
-	static int fuse_service_access (const char *path, int mask)
-	{
-		try
-		{
-			if (!FuseService::CheckAccessRights())
-				return -EACCES;
-		}
-		catch (...)
-		{
-			return FuseService::ExceptionToErrorCode();
-		}
-
-		return 0;
-	}
-
-#ifdef TC_OPENBSD
-	static void *fuse_service_init (struct fuse_conn_info *)
-#else
-	static void *fuse_service_init ()
-#endif
+	static void fuse_service_start ()
 	{
 		try
 		{
@@ -73,8 +63,8 @@ namespace VeraCrypt
 			sigaction (SIGQUIT, &action, nullptr);
 			sigaction (SIGTERM, &action, nullptr);
 
-			if (!EncryptionThreadPool::IsRunning())
-				EncryptionThreadPool::Start();
+			FuseService::StartEncryptionThreadPool();
+			FuseService::StartReadAhead();
 		}
 		catch (exception &e)
 		{
@@ -84,8 +74,6 @@ namespace VeraCrypt
 		{
 			SystemLog::WriteException (UnknownException (SRC_POS));
 		}
-
-		return nullptr;
 	}
 
 	static void fuse_service_destroy (void *userdata)
@@ -104,6 +92,497 @@ namespace VeraCrypt
 		}
 	}
 
+	// Returns the number of bytes read, which is less than size at the end of the volume
+	static size_t fuse_service_read_volume_image (byte *buf, size_t size, uint64 offset)
+	{
+		try
+		{
+			// Test for read beyond the end of the volume
+			if (offset >= FuseService::GetVolumeSize())
+				return 0;
+
+			if (offset + size > FuseService::GetVolumeSize())
+				size = FuseService::GetVolumeSize() - offset;
+
+			size_t sectorSize = FuseService::GetVolumeSectorSize();
+			if (size % sectorSize != 0 || offset % sectorSize != 0)
+			{
+				// Support for non-sector-aligned read operations is required by some loop device tools
+				// which may analyze the volume image before attaching it as a device
+
+				uint64 alignedOffset = offset - (offset % sectorSize);
+				uint64 alignedSize = size + (offset % sectorSize);
+
+				if (alignedSize % sectorSize != 0)
+					alignedSize += sectorSize - (alignedSize % sectorSize);
+
+				PooledSecureBuffer alignedBuffer ((size_t) alignedSize);
+
+				FuseService::ReadVolumeSectors (alignedBuffer, alignedOffset);
+				BufferPtr (buf, size).CopyFrom (alignedBuffer.GetRange (offset % sectorSize, size));
+			}
+			else
+			{
+				FuseService::ReadVolumeSectors (BufferPtr (buf, size), offset);
+			}
+		}
+		catch (MissingVolumeData&)
+		{
+			return 0;
+		}
+
+		return size;
+	}
+
+#ifdef TC_FUSE3
+
+	// Inode numbers of the files in the root directory of the low-level file system
+	static const fuse_ino_t FuseVolumeImageInode = FUSE_ROOT_ID + 1;
+	static const fuse_ino_t FuseControlInode = FUSE_ROOT_ID + 2;
+
+	// Largest size of read and write requests. The kernel limits the pages of a request to max_write
+	// negotiated by libfuse, which is bounded by the buffer size of the session.
+	static const unsigned int FuseMaxRequestSize = 1024 * 1024;
+
+	static bool fuse_service_ll_check_access (fuse_req_t req)
+	{
+		return FuseService::CheckAccessRights (fuse_req_ctx (req)->uid);
+	}
+
+	// The size of the control file changes when auxiliary device information is received
+	static double fuse_service_ll_attr_timeout (fuse_ino_t ino)
+	{
+		return ino == FuseControlInode ? 0.0 : 1.0;
+	}
+
+	static bool fuse_service_ll_stat (fuse_ino_t ino, struct stat *statData)
+	{
+		Memory::Zero (statData, sizeof(*statData));
+
+		statData->st_ino = ino;
+		statData->st_uid = FuseService::GetUserId();
+		statData->st_gid = FuseService::GetGroupId();
+		statData->st_atime = time (NULL);
+		statData->st_ctime = time (NULL);
+		statData->st_mtime = time (NULL);
+
+		if (ino == FUSE_ROOT_ID)
+		{
+			statData->st_mode = S_IFDIR | 0500;
+			statData->st_nlink = 2;
+		}
+		else if (ino == FuseVolumeImageInode)
+		{
+			statData->st_mode = S_IFREG | 0600;
+			statData->st_nlink = 1;
+			statData->st_size = FuseService::GetVolumeSize();
+		}
+		else if (ino == FuseControlInode)
+		{
+			statData->st_mode = S_IFREG | 0600;
+			statData->st_nlink = 1;
+			statData->st_size = FuseService::GetVolumeInfo()->Size();
+		}
+		else
+		{
+			return false;
+		}
+
+		return true;
+	}
+
+	static void fuse_service_ll_access (fuse_req_t req, fuse_ino_t ino, int mask)
+	{
+		try
+		{
+			fuse_reply_err (req, fuse_service_ll_check_access (req) ? 0 : EACCES);
+		}
+		catch (...)
+		{
+			fuse_reply_err (req, -FuseService::ExceptionToErrorCode());
+		}
+	}
+
+	static void fuse_service_ll_init (void *userdata, struct fuse_conn_info *conn)
+	{
+		fuse_service_start();
+
+		// Read replies are sent from the decrypted data in memory and written data must be copied to
+		// memory for encryption, so splicing the device would not save any copies
+		conn->want &= ~(FUSE_CAP_SPLICE_READ | FUSE_CAP_SPLICE_WRITE | FUSE_CAP_SPLICE_MOVE);
+
+		conn->max_write = FuseMaxRequestSize;
+	}
+
+	static void fuse_service_ll_getattr (fuse_req_t req, fuse_ino_t ino, struct fuse_file_info *fi)
+	{
+		try
+		{
+			if (ino != FUSE_ROOT_ID && !fuse_service_ll_check_access (req))
+			{
+				fuse_reply_err (req, EACCES);
+				return;
+			}
+
+			struct stat statData;
+			if (!fuse_service_ll_stat (ino, &statData))
+			{
+				fuse_reply_err (req, ENOENT);
+				return;
+			}
+
+			fuse_reply_attr (req, &statData, fuse_service_ll_attr_timeout (ino));
+		}
+		catch (...)
+		{
+			fuse_reply_err (req, -FuseService::ExceptionToErrorCode());
+		}
+	}
+
+	static void fuse_service_ll_lookup (fuse_req_t req, fuse_ino_t parent, const char *name)
+	{
+		try
+		{
+			if (!fuse_service_ll_check_access (req))
+			{
+				fuse_reply_err (req, EACCES);
+				return;
+			}
+
+			struct fuse_entry_param entry;
+			Memory::Zero (&entry, sizeof (entry));
+
+			if (parent == FUSE_ROOT_ID && strcmp (name, FuseService::GetVolumeImagePath() + 1) == 0)
+			{
+				entry.ino = FuseVolumeImageInode;
+			}
+			else if (parent == FUSE_ROOT_ID && strcmp (name, FuseService::GetControlPath() + 1) == 0)
+			{
+				entry.ino = FuseControlInode;
+			}
+			else
+			{
+				fuse_reply_err (req, ENOENT);
+				return;
+			}
+
+			fuse_service_ll_stat (entry.ino, &entry.attr);
+			entry.attr_timeout = fuse_service_ll_attr_timeout (entry.ino);
+			entry.entry_timeout = entry.attr_timeout;
+
+			fuse_reply_entry (req, &entry);
+		}
+		catch (...)
+		{
+			fuse_reply_err (req, -FuseService::ExceptionToErrorCode());
+		}
+	}
+
+	static void fuse_service_ll_opendir (fuse_req_t req, fuse_ino_t ino, struct fuse_file_info *fi)
+	{
+		try
+		{
+			if (!fuse_service_ll_check_access (req))
+			{
+				fuse_reply_err (req, EACCES);
+				return;
+			}
+
+			if (ino != FUSE_ROOT_ID)
+			{
+				fuse_reply_err (req, ENOENT);
+				return;
+			}
+
+			fuse_reply_open (req, fi);
+		}
+		catch (...)
+		{
+			fuse_reply_err (req, -FuseService::ExceptionToErrorCode());
+		}
+	}
+
+	static void fuse_service_ll_open (fuse_req_t req, fuse_ino_t ino, struct fuse_file_info *fi)
+	{
+		try
+		{
+			if (!fuse_service_ll_check_access (req))
+			{
+				fuse_reply_err (req, EACCES);
+				return;
+			}
+
+			if (ino == FuseVolumeImageInode)
+			{
+				fuse_reply_open (req, fi);
+				return;
+			}
+
+			if (ino == FuseControlInode)
+			{
+				fi->direct_io = 1;
+				fuse_reply_open (req, fi);
+				return;
+			}
+
+			fuse_reply_err (req, ENOENT);
+		}
+		catch (...)
+		{
+			fuse_reply_err (req, -FuseService::ExceptionToErrorCode());
+		}
+	}
+
+	static void fuse_service_ll_read (fuse_req_t req, fuse_ino_t ino, size_t size, off_t offset, struct fuse_file_info *fi)
+	{
+		try
+		{
+			if (!fuse_service_ll_check_access (req))
+			{
+				fuse_reply_err (req, EACCES);
+				return;
+			}
+
+			if (ino == FuseVolumeImageInode)
+			{
+				if (size == 0)
+				{
+					fuse_reply_buf (req, nullptr, 0);
+					return;
+				}
+
+				PooledSecureBuffer buffer (size);
+				size = fuse_service_read_volume_image (buffer.Ptr(), size, offset);
+
+				fuse_reply_buf (req, (const char *) buffer.Ptr(), size);
+				return;
+			}
+
+			if (ino == FuseControlInode)
+			{
+				shared_ptr <Buffer> infoBuf = FuseService::GetVolumeInfo();
+
+				if ((uint64) offset >= infoBuf->Size())
+				{
+					fuse_reply_buf (req, nullptr, 0);
+					return;
+				}
+
+				if (offset + size > infoBuf->Size())
+					size = infoBuf->Size () - offset;
+
+				fuse_reply_buf (req, (const char *) infoBuf->Ptr() + offset, size);
+				return;
+			}
+
+			fuse_reply_err (req, ENOENT);
+		}
+		catch (...)
+		{
+			fuse_reply_err (req, -FuseService::ExceptionToErrorCode());
+		}
+	}
+
+	static void fuse_service_ll_readdir (fuse_req_t req, fuse_ino_t ino, size_t size, off_t offset, struct fuse_file_info *fi)
+	{
+		try
+		{
+			if (!fuse_service_ll_check_access (req))
+			{
+				fuse_reply_err (req, EACCES);
+				return;
+			}
+
+			if (ino != FUSE_ROOT_ID)
+			{
+				fuse_reply_err (req, ENOENT);
+				return;
+			}
+
+			const char *names[] = { ".", "..", FuseService::GetVolumeImagePath() + 1, FuseService::GetControlPath() + 1 };
+			const fuse_ino_t inodes[] = { FUSE_ROOT_ID, FUSE_ROOT_ID, FuseVolumeImageInode, FuseControlInode };
+
+			// The offset of each entry is the offset of the next entry in the complete listing
+			vector <char> listing;
+			for (size_t i = 0; i < array_capacity (names); ++i)
+			{
+				struct stat statData;
+				Memory::Zero (&statData, sizeof (statData));
+				statData.st_ino = inodes[i];
+				statData.st_mode = (inodes[i] == FUSE_ROOT_ID ? S_IFDIR : S_IFREG);
+
+				size_t entryOffset = listing.size();
+				listing.resize (entryOffset + fuse_add_direntry (req, nullptr, 0, names[i], nullptr, 0));
+				fuse_add_direntry (req, &listing[entryOffset], listing.size() - entryOffset, names[i], &statData, listing.size());
+			}
+
+			if ((uint64) offset >= listing.size())
+			{
+				fuse_reply_buf (req, nullptr, 0);
+				return;
+			}
+
+			fuse_reply_buf (req, &listing[offset], min (size, listing.size() - (size_t) offset));
+		}
+		catch (...)
+		{
+			fuse_reply_err (req, -FuseService::ExceptionToErrorCode());
+		}
+	}
+
+	static void fuse_service_ll_write (fuse_req_t req, fuse_ino_t ino, const char *buf, size_t size, off_t offset, struct fuse_file_info *fi)
+	{
+		try
+		{
+			if (!fuse_service_ll_check_access (req))
+			{
+				fuse_reply_err (req, EACCES);
+				return;
+			}
+
+			if (ino == FuseVolumeImageInode)
+			{
+				FuseService::WriteVolumeSectors (ConstBufferPtr ((const byte *) buf, size), offset);
+				fuse_reply_write (req, size);
+				return;
+			}
+
+			if (ino == FuseControlInode)
+			{
+				if (FuseService::AuxDeviceInfoReceived())
+				{
+					fuse_reply_err (req, EACCES);
+					return;
+				}
+
+				FuseService::ReceiveAuxDeviceInfo (ConstBufferPtr ((const byte *) buf, size));
+				fuse_reply_write (req, size);
+				return;
+			}
+
+			fuse_reply_err (req, ENOENT);
+		}
+#ifdef TC_FREEBSD
+		// FreeBSD apparently retries failed write operations forever, which may lead to a system crash.
+		catch (VolumeReadOnly&)
+		{
+			fuse_reply_write (req, size);
+		}
+		catch (VolumeProtected&)
+		{
+			fuse_reply_write (req, size);
+		}
+#endif
+		catch (...)
+		{
+			fuse_reply_err (req, -FuseService::ExceptionToErrorCode());
+		}
+	}
+
+	// Mounts the file system and serves requests until it is unmounted, like fuse_main of the
+	// high-level interface, but with a multithreaded session loop
+	static int fuse_service_ll_main (int argc, char *argv[])
+	{
+		static fuse_lowlevel_ops fuse_service_oper;
+
+		fuse_service_oper.access = fuse_service_ll_access;
+		fuse_service_oper.destroy = fuse_service_destroy;
+		fuse_service_oper.getattr = fuse_service_ll_getattr;
+		fuse_service_oper.init = fuse_service_ll_init;
+		fuse_service_oper.lookup = fuse_service_ll_lookup;
+		fuse_service_oper.open = fuse_service_ll_open;
+		fuse_service_oper.opendir = fuse_service_ll_opendir;
+		fuse_service_oper.read = fuse_service_ll_read;
+		fuse_service_oper.readdir = fuse_service_ll_readdir;
+		fuse_service_oper.write = fuse_service_ll_write;
+
+		struct fuse_args args = FUSE_ARGS_INIT (argc, argv);
+		struct fuse_cmdline_opts opts;
+		int result = 1;
+
+		if (fuse_parse_cmdline (&args, &opts) != 0)
+			return 1;
+
+		struct fuse_session *session = fuse_session_new (&args, &fuse_service_oper, sizeof (fuse_service_oper), nullptr);
+		if (session)
+		{
+			if (fuse_set_signal_handlers (session) == 0)
+			{
+				if (fuse_session_mount (session, opts.mountpoint) == 0)
+				{
+					fuse_daemonize (opts.foreground);
+
+					if (opts.singlethread)
+					{
+						result = fuse_session_loop (session);
+					}
+					else
+					{
+						// Requests mostly wait for the host file and the encryption threads, so keep
+						// enough idle workers to queue reads and writes on all CPUs
+						unsigned int idleThreadCount = (unsigned int) max ((size_t) opts.max_idle_threads, EncryptionThreadPool::GetCpuCount() * 2);
+#if FUSE_USE_VERSION >= 312
+						struct fuse_loop_config *config = fuse_loop_cfg_create();
+						if (config)
+						{
+							fuse_loop_cfg_set_clone_fd (config, 1);
+							fuse_loop_cfg_set_max_threads (config, max (opts.max_threads, idleThreadCount));
+							fuse_loop_cfg_set_idle_threads (config, idleThreadCount);
+
+							result = fuse_session_loop_mt (session, config);
+							fuse_loop_cfg_destroy (config);
+						}
+#else
+						struct fuse_loop_config config;
+						config.clone_fd = 1;
+						config.max_idle_threads = idleThreadCount;
+
+						result = fuse_session_loop_mt (session, &config);
+#endif
+					}
+
+					fuse_session_unmount (session);
+				}
+
+				fuse_remove_signal_handlers (session);
+			}
+
+			fuse_session_destroy (session);
+		}
+
+		free (opts.mountpoint);
+		fuse_opt_free_args (&args);
+
+		return result == 0 ? 0 : 1;
+	}
+
+#else // TC_FUSE3
+
+	static int fuse_service_access (const char *path, int mask)
+	{
+		try
+		{
+			if (!FuseService::CheckAccessRights())
+				return -EACCES;
+		}
+		catch (...)
+		{
+			return FuseService::ExceptionToErrorCode();
+		}
+
+		return 0;
+	}
+
+#ifdef TC_OPENBSD
+	static void *fuse_service_init (struct fuse_conn_info *)
+#else
+	static void *fuse_service_init ()
+#endif
+	{
+		fuse_service_start();
+		return nullptr;
+	}
+
 	static int fuse_service_getattr (const char *path, struct stat *statData)
 	{
 		try
@@ -201,42 +680,7 @@ namespace VeraCrypt
 				return -EACCES;
 
 			if (strcmp (path, FuseService::GetVolumeImagePath()) == 0)
-			{
-				try
-				{
-					// Test for read beyond the end of the volume
-					if ((uint64) offset + size > FuseService::GetVolumeSize())
-						size = FuseService::GetVolumeSize() - offset;
-
-					size_t sectorSize = FuseService::GetVolumeSectorSize();
-					if (size % sectorSize != 0 || offset % sectorSize != 0)
-					{
-						// Support for non-sector-aligned read operations is required by some loop device tools
-						// which may analyze the volume image before attaching it as a device
-
-						uint64 alignedOffset = offset - (offset % sectorSize);
-						uint64 alignedSize = size + (offset % sectorSize);
-
-						if (alignedSize % sectorSize != 0)
-							alignedSize += sectorSize - (alignedSize % sectorSize);
-
-						SecureBuffer alignedBuffer (alignedSize);
-
-						FuseService::ReadVolumeSectors (alignedBuffer, alignedOffset);
-						BufferPtr ((byte *) buf, size).CopyFrom (alignedBuffer.GetRange (offset % sectorSize, size));
-					}
-					else
-					{
-						FuseService::ReadVolumeSectors (BufferPtr ((byte *) buf, size), offset);
-					}
-				}
-				catch (MissingVolumeData&)
-				{
-					return 0;
-				}
-
-				return size;
-			}
+				return fuse_service_read_volume_image ((byte *) buf, size, offset);
 
 			if (strcmp (path, FuseService::GetControlPath()) == 0)
 			{
@@ -325,9 +769,18 @@ namespace VeraCrypt
 		return -ENOENT;
 	}
 
+#endif // TC_FUSE3
+
+#ifndef TC_FUSE3
 	bool FuseService::CheckAccessRights ()
 	{
-		return fuse_get_context()->uid == 0 || fuse_get_context()->uid == UserId;
+		return CheckAccessRights (fuse_get_context()->uid);
+	}
+#endif
+
+	bool FuseService::CheckAccessRights (uid_t uid)
+	{
+		return uid == 0 || uid == UserId;
 	}
 
 	void FuseService::CloseMountedVolume ()
@@ -347,6 +800,7 @@ namespace VeraCrypt
 
 	void FuseService::Dismount ()
 	{
+		ReadAhead.reset();
 		CloseMountedVolume();
 
 		if (EncryptionThreadPool::IsRunning())
@@ -406,6 +860,12 @@ namespace VeraCrypt
 			OpenVolumeInfo.Serialize (stream);
 		}
 
+		// Appended after the volume info, whose layout must remain readable by older versions
+		{
+			Serializer sr (stream);
+			sr.Serialize ("ReadAheadHits", ReadAhead ? ReadAhead->GetHitCount() : (uint64) 0);
+		}
+
 		ConstBufferPtr infoBuf = dynamic_cast <MemoryStream&> (*stream);
 		shared_ptr <Buffer> outBuf (new Buffer (infoBuf.Size()));
 		outBuf->CopyFrom (infoBuf);
@@ -430,7 +890,7 @@ namespace VeraCrypt
 		return MountedVolume->GetSize();
 	}
 
-	void FuseService::Mount (shared_ptr <Volume> openVolume, VolumeSlotNumber slotNumber, const string &fuseMountPoint)
+	void FuseService::Mount (shared_ptr <Volume> openVolume, VolumeSlotNumber slotNumber, const string &fuseMountPoint, size_t encryptionThreadCount, bool pinEncryptionThreads, size_t readAheadSize)
 	{
 		list <string> args;
 		args.push_back (FuseService::GetDeviceType());
@@ -449,7 +909,7 @@ namespace VeraCrypt
 			args.push_back ("allow_other");
 		}
 
-		ExecFunctor execFunctor (openVolume, slotNumber);
+		ExecFunctor execFunctor (openVolume, slotNumber, encryptionThreadCount, pinEncryptionThreads, readAheadSize);
 		Process::Execute ("fuse", args, -1, &execFunctor);
 
 		for (int t = 0; true; t++)
@@ -474,6 +934,9 @@ namespace VeraCrypt
 		if (!MountedVolume)
 			throw NotInitialized (SRC_POS);
 
+		if (ReadAhead && ReadAhead->Read (buffer, byteOffset))
+			return;
+
 		MountedVolume->ReadSectors (buffer, byteOffset);
 	}
 
@@ -500,11 +963,30 @@ namespace VeraCrypt
 		fuseServiceControl.Write (dynamic_cast <MemoryStream&> (*stream));
 	}
 
+	void FuseService::StartReadAhead ()
+	{
+		if (!ReadAhead && ReadAheadSize > 0 && MountedVolume)
+			ReadAhead.reset (new FuseReadAhead (MountedVolume, ReadAheadSize));
+	}
+
+	void FuseService::StartEncryptionThreadPool ()
+	{
+		if (!EncryptionThreadPool::IsRunning())
+			EncryptionThreadPool::Start (EncryptionThreadCount, PinEncryptionThreads);
+	}
+
 	void FuseService::WriteVolumeSectors (const ConstBufferPtr &buffer, uint64 byteOffset)
 	{
 		if (!MountedVolume)
 			throw NotInitialized (SRC_POS);
 
+		// Blocks read ahead are invalidated after the write so that no load can return the previous data
+		finally_do_arg2 (const ConstBufferPtr &, buffer, uint64, byteOffset,
+		{
+			if (ReadAhead)
+				ReadAhead->Invalidate (finally_arg2, finally_arg.Size());
+		});
+
 		MountedVolume->WriteSectors (buffer, byteOffset);
 	}
 
@@ -530,6 +1012,9 @@ namespace VeraCrypt
 
 		FuseService::MountedVolume = MountedVolume;
 		FuseService::SlotNumber = SlotNumber;
+		FuseService::EncryptionThreadCount = EncryptionThreadCount;
+		FuseService::PinEncryptionThreads = PinEncryptionThreads;
+		FuseService::ReadAheadSize = ReadAheadSize;
 
 		FuseService::UserId = getuid();
 		FuseService::GroupId = getgid();
@@ -550,6 +1035,7 @@ namespace VeraCrypt
 			catch (...) { }
 		}
 
+#ifndef TC_FUSE3
 		static fuse_operations fuse_service_oper;
 
 		fuse_service_oper.access = fuse_service_access;
@@ -561,6 +1047,7 @@ namespace VeraCrypt
 		fuse_service_oper.read = fuse_service_read;
 		fuse_service_oper.readdir = fuse_service_readdir;
 		fuse_service_oper.write = fuse_service_write;
+#endif
 
 		// Create a new session
 		setsid ();
@@ -592,16 +1079,22 @@ namespace VeraCrypt
 
 		SignalHandlerPipe->GetWriteFD();
 
-#ifdef TC_OPENBSD
+#ifdef TC_FUSE3
+		_exit (fuse_service_ll_main (argc, argv));
+#elif defined (TC_OPENBSD)
 		_exit (fuse_main (argc, argv, &fuse_service_oper, NULL));
 #else
 		_exit (fuse_main (argc, argv, &fuse_service_oper));
 #endif
 	}
 
+	size_t FuseService::EncryptionThreadCount;
 	VolumeInfo FuseService::OpenVolumeInfo;
 	Mutex FuseService::OpenVolumeInfoMutex;
 	shared_ptr <Volume> FuseService::MountedVolume;
+	bool FuseService::PinEncryptionThreads;
+	unique_ptr <FuseReadAhead> FuseService::ReadAhead;
+	size_t FuseService::ReadAheadSize;
 	VolumeSlotNumber FuseService::SlotNumber;
 	uid_t FuseService::UserId;
 	gid_t FuseService::GroupId;
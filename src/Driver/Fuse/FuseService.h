@@ -21,20 +21,24 @@
 
 namespace VeraCrypt
 {
+	class FuseReadAhead;
 
 	class FuseService
 	{
 	protected:
 		struct ExecFunctor : public ProcessExecFunctor
 		{
-			ExecFunctor (shared_ptr <Volume> openVolume, VolumeSlotNumber slotNumber)
-				: MountedVolume (openVolume), SlotNumber (slotNumber)
+			ExecFunctor (shared_ptr <Volume> openVolume, VolumeSlotNumber slotNumber, size_t encryptionThreadCount, bool pinEncryptionThreads, size_t readAheadSize)
+				: EncryptionThreadCount (encryptionThreadCount), MountedVolume (openVolume), PinEncryptionThreads (pinEncryptionThreads), ReadAheadSize (readAheadSize), SlotNumber (slotNumber)
 			{
 			}
 			virtual void operator() (int argc, char *argv[]);
 
 		protected:
+			size_t EncryptionThreadCount;
 			shared_ptr <Volume> MountedVolume;
+			bool PinEncryptionThreads;
+			size_t ReadAheadSize;
 			VolumeSlotNumber SlotNumber;
 		};
 
@@ -42,7 +46,10 @@ namespace VeraCrypt
 
 	public:
 		static bool AuxDeviceInfoReceived () { return !OpenVolumeInfo.VirtualDevice.IsEmpty(); }
+#ifndef TC_FUSE3
 		static bool CheckAccessRights ();
+#endif
+		static bool CheckAccessRights (uid_t uid);
 		static void Dismount ();
 		static int ExceptionToErrorCode ();
 		static const char *GetControlPath () { return "/control"; }
@@ -53,10 +60,12 @@ namespace VeraCrypt
 		static shared_ptr <Buffer> GetVolumeInfo ();
 		static uint64 GetVolumeSize ();
 		static uint64 GetVolumeSectorSize () { return MountedVolume->GetSectorSize(); }
-		static void Mount (shared_ptr <Volume> openVolume, VolumeSlotNumber slotNumber, const string &fuseMountPoint);
+		static void Mount (shared_ptr <Volume> openVolume, VolumeSlotNumber slotNumber, const string &fuseMountPoint, size_t encryptionThreadCount = 0, bool pinEncryptionThreads = false, size_t readAheadSize = 0);
 		static void ReadVolumeSectors (const BufferPtr &buffer, uint64 byteOffset);
 		static void ReceiveAuxDeviceInfo (const ConstBufferPtr &buffer);
 		static void SendAuxDeviceInfo (const DirectoryPath &fuseMountPoint, const DevicePath &virtualDevice, const DevicePath &loopDevice = DevicePath());
+		static void StartEncryptionThreadPool ();
+		static void StartReadAhead ();
 		static void WriteVolumeSectors (const ConstBufferPtr &buffer, uint64 byteOffset);
 
 	protected:
@@ -64,9 +73,13 @@ namespace VeraCrypt
 		static void CloseMountedVolume ();
 		static void OnSignal (int signal);
 
+		static size_t EncryptionThreadCount;
 		static VolumeInfo OpenVolumeInfo;
 		static Mutex OpenVolumeInfoMutex;
 		static shared_ptr <Volume> MountedVolume;
+		static bool PinEncryptionThreads;
+		static unique_ptr <FuseReadAhead> ReadAhead;
+		static size_t ReadAheadSize;
 		static VolumeSlotNumber SlotNumber;
 		static uid_t UserId;
 		static gid_t GroupId;
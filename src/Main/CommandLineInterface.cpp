@@ -45,6 +45,7 @@ namespace VeraCrypt
 		parser.AddOption (L"",  L"auto-mount",			_("Auto mount device-hosted/favorite volumes"));
 		parser.AddSwitch (L"",  L"backup-headers",		_("Backup volume headers"));
 		parser.AddSwitch (L"",  L"background-task",		_("Start Background Task"));
+		parser.AddSwitch (L"",  L"benchmark",			_("Benchmark internal algorithms"));
 #ifdef TC_WINDOWS
 		parser.AddSwitch (L"",  L"cache",				_("Cache passwords and keyfiles"));
 #endif
@@ -182,6 +183,12 @@ namespace VeraCrypt
 			param1IsVolume = true;
 		}
 
+		if (parser.Found (L"benchmark"))
+		{
+			CheckCommandSingle();
+			ArgCommand = CommandId::Benchmark;
+		}
+
 		if (parser.Found (L"change"))
 		{
 			CheckCommandSingle();
@@ -399,14 +406,40 @@ namespace VeraCrypt
 			{
 				wxString token = tokenizer.GetNextToken();
 
-				if (token == L"headerbak")
+				if (token == L"directio")
+					ArgMountOptions.DirectIo = true;
+				else if (token == L"headerbak")
 					ArgMountOptions.UseBackupHeaders = true;
 				else if (token == L"nokernelcrypto")
 					ArgMountOptions.NoKernelCrypto = true;
+				else if (token == L"pinthreads")
+					ArgMountOptions.PinEncryptionThreads = true;
+				else if (token.StartsWith (L"readahead="))
+				{
+					try
+					{
+						ArgMountOptions.ReadAheadSize = StringConverter::ToUInt32 (wstring (token.Mid (10)));
+					}
+					catch (...)
+					{
+						throw_err (LangString["UNKNOWN_OPTION"] + L": " + token);
+					}
+				}
 				else if (token == L"readonly" || token == L"ro")
 					ArgMountOptions.Protection = VolumeProtection::ReadOnly;
 				else if (token == L"system")
 					ArgMountOptions.PartitionInSystemEncryptionScope = true;
+				else if (token.StartsWith (L"threads="))
+				{
+					try
+					{
+						ArgMountOptions.EncryptionThreadCount = StringConverter::ToUInt32 (wstring (token.Mid (8)));
+					}
+					catch (...)
+					{
+						throw_err (LangString["UNKNOWN_OPTION"] + L": " + token);
+					}
+				}
 				else if (token == L"timestamp" || token == L"ts")
 					ArgMountOptions.PreserveTimestamps = false;
 #ifdef TC_WINDOWS
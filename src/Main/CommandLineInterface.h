@@ -32,6 +32,7 @@ namespace VeraCrypt
 			AutoMountDevicesFavorites,
 			AutoMountFavorites,
 			BackupHeaders,
+			Benchmark,
 			ChangePassword,
 			CreateKeyfile,
 			CreateVolume,
@@ -81,6 +81,7 @@ namespace VeraCrypt
 #endif
 		AppendToList ("TOTAL_DATA_READ", Gui->SizeToString (volumeInfo.TotalDataRead));
 		AppendToList ("TOTAL_DATA_WRITTEN", Gui->SizeToString (volumeInfo.TotalDataWritten));
+		AppendToList ("READ_AHEAD_HITS", StringConverter::FromNumber (volumeInfo.ReadAheadHits));
 #ifdef TC_LINUX
 		}
 #endif
@@ -25,6 +25,7 @@
 #include "Platform/SystemException.h"
 #include "Common/SecurityToken.h"
 #include "Volume/EncryptionTest.h"
+#include "Volume/EncryptionThreadPool.h"
 #include "Application.h"
 #include "FavoriteVolume.h"
 #include "UserInterface.h"
@@ -48,6 +49,145 @@ namespace VeraCrypt
 		catch (...) { }
 	}
 
+	void UserInterface::Benchmark () const
+	{
+		// Measures how many requests per second the encryption thread pool can accept.
+		// Requests smaller than the calibrated minimum fragment size are encrypted by the
+		// submitting thread, so each request is made large enough to be split into one
+		// fragment per available CPU.
+		const size_t maxThreadCount = 64;
+		const size_t submitterCount = 4;
+		const size_t minUnitsPerRequest = 8;
+		const uint64 testTime = 1000;
+
+		shared_ptr <EncryptionAlgorithm> ea (new AES);
+		Buffer key (ea->GetKeySize());
+		key.Zero();
+		ea->SetKey (key);
+
+		shared_ptr <EncryptionMode> xts (new EncryptionModeXTS);
+		xts->SetKey (key);
+		ea->SetMode (xts);
+
+		struct SubmitterFunctor : public Functor
+		{
+			SubmitterFunctor (shared_ptr <EncryptionAlgorithm> ea, size_t unitCount, uint64 &requestCount, SharedVal <bool> &stopPending)
+				: DataBuffer (unitCount * ENCRYPTION_DATA_UNIT_SIZE), Ea (ea), RequestCount (requestCount), StopPending (stopPending), UnitCount (unitCount) { }
+
+			virtual void operator() ()
+			{
+				uint64 count = 0;
+				DataBuffer.Zero();
+
+				while (!StopPending.Get())
+				{
+					Ea->EncryptSectors (DataBuffer, count * UnitCount, UnitCount, ENCRYPTION_DATA_UNIT_SIZE);
+					++count;
+				}
+
+				RequestCount = count;
+			}
+
+			SecureBuffer DataBuffer;
+			shared_ptr <EncryptionAlgorithm> Ea;
+			uint64 &RequestCount;
+			SharedVal <bool> &StopPending;
+			size_t UnitCount;
+		};
+
+		size_t previousThreadCount = EncryptionThreadPool::GetThreadCount();
+		bool previousThreadsPinned = EncryptionThreadPool::IsPinningThreads();
+		finally_do_arg2 (size_t, previousThreadCount, bool, previousThreadsPinned,
+		{
+			EncryptionThreadPool::Stop();
+			if (finally_arg > 0)
+				EncryptionThreadPool::Start (finally_arg, finally_arg2);
+		});
+
+		// Minimum fragment sizes are calibrated when the pool is first started
+		EncryptionThreadPool::Stop();
+		EncryptionThreadPool::Start (2);
+
+		size_t fragmentCount = min (max (EncryptionThreadPool::GetCpuCount(), (size_t) 2), maxThreadCount);
+		size_t unitsPerRequest = max (minUnitsPerRequest, EncryptionThreadPool::GetMinFragmentSize (ea->GetCiphers()) * fragmentCount / ENCRYPTION_DATA_UNIT_SIZE);
+
+		wxString report = StringFormatter (L"{0} x {1} bytes, {2} submitting threads, {3} CPUs available\n\n", ea->GetName(), (uint64) (unitsPerRequest * ENCRYPTION_DATA_UNIT_SIZE), (uint64) submitterCount, (uint64) EncryptionThreadPool::GetCpuCount());
+
+		for (size_t threadCount = 1; threadCount <= maxThreadCount; threadCount *= 2)
+		{
+			EncryptionThreadPool::Stop();
+			EncryptionThreadPool::Start (threadCount);
+
+			vector <uint64> requestCounts (submitterCount);
+			SharedVal <bool> stopPending (false);
+			list < shared_ptr <Thread> > submitters;
+
+			wxLongLong startTime = wxGetLocalTimeMillis();
+
+			for (size_t i = 0; i < submitterCount; ++i)
+			{
+				make_shared_auto (Thread, thread);
+				thread->Start (new SubmitterFunctor (ea, unitsPerRequest, requestCounts[i], stopPending));
+				submitters.push_back (thread);
+			}
+
+			Thread::Sleep ((uint32) testTime);
+			stopPending.Set (true);
+
+			foreach_ref (const Thread &thread, submitters)
+			{
+				thread.Join();
+			}
+
+			uint64 time = (uint64) (wxGetLocalTimeMillis().GetValue() - startTime.GetValue());
+			if (time == 0)
+				time = 1;
+
+			uint64 requestCount = 0;
+			foreach (uint64 count, requestCounts)
+				requestCount += count;
+
+			// A pool is not started for a single thread and requests are encrypted by the submitting threads
+			wxString poolName = L"No thread pool";
+			if (EncryptionThreadPool::IsRunning())
+				poolName = StringFormatter (L"{0} threads", (uint64) EncryptionThreadPool::GetThreadCount());
+
+			report += StringFormatter (L"{0}: {1} requests/s, {2}\n", poolName, requestCount * 1000 / time,
+				SpeedToString (requestCount * unitsPerRequest * ENCRYPTION_DATA_UNIT_SIZE * 1000 / time));
+		}
+
+		report += StringFormatter (L"\nThread pool dispatch cost: {0} ns\nMinimum fragment size per thread:\n", EncryptionThreadPool::GetDispatchCost());
+
+		EncryptionThreadPool::FragmentSizeMap fragmentSizes = EncryptionThreadPool::GetMinFragmentSizes();
+		for (EncryptionThreadPool::FragmentSizeMap::const_iterator i = fragmentSizes.begin(); i != fragmentSizes.end(); ++i)
+		{
+			report += StringFormatter (L"{0}: {1} bytes\n", i->first, (uint64) i->second);
+		}
+
+		// Header key derivation time of each PRF with the default PIM
+		Buffer dk (MASTER_KEYDATA_SIZE);
+		Buffer salt (64);
+		salt.Zero();
+		VolumePassword password ((const byte *) "passphrase-1234567890", 21);
+
+		report += L"\nHeader key derivation time:\n";
+
+		Pkcs5KdfList kdfList = Pkcs5Kdf::GetAvailableAlgorithms (false);
+		foreach (shared_ptr <Pkcs5Kdf> kdf, kdfList)
+		{
+			if (!kdf->IsDeprecated())
+			{
+				wxLongLong startTime = wxGetLocalTimeMillis();
+				kdf->DeriveKey (dk, password, 0, salt);
+
+				report += StringFormatter (L"{0}: {1} ms ({2} iterations)\n", kdf->GetName(),
+					(uint64) (wxGetLocalTimeMillis().GetValue() - startTime.GetValue()), (uint64) kdf->GetIterationCount (0));
+			}
+		}
+
+		ShowString (report);
+	}
+
 	void UserInterface::CheckRequirementsForMountingVolume () const
 	{
 #ifdef TC_LINUX
@@ -291,6 +431,7 @@ namespace VeraCrypt
 #endif
 			prop << LangString["TOTAL_DATA_READ"] << L": " << SizeToString (volume.TotalDataRead) << L'\n';
 			prop << LangString["TOTAL_DATA_WRITTEN"] << L": " << SizeToString (volume.TotalDataWritten) << L'\n';
+			prop << LangString["READ_AHEAD_HITS"] << L": " << StringConverter::FromNumber (volume.ReadAheadHits) << L'\n';
 #ifdef TC_LINUX
 			}
 #endif
@@ -1020,6 +1161,10 @@ namespace VeraCrypt
 			BackupVolumeHeaders (cmdLine.ArgVolumePath);
 			return true;
 
+		case CommandId::Benchmark:
+			Benchmark();
+			return true;
+
 		case CommandId::ChangePassword:
 			ChangePassword (cmdLine.ArgVolumePath, cmdLine.ArgPassword, cmdLine.ArgPim, cmdLine.ArgHash, cmdLine.ArgTrueCryptMode, cmdLine.ArgKeyfiles, cmdLine.ArgNewPassword, cmdLine.ArgNewPim, cmdLine.ArgNewKeyfiles, cmdLine.ArgNewHash);
 			return true;
@@ -1088,6 +1233,11 @@ namespace VeraCrypt
 					" Backup volume headers to a file. All required options are requested from the\n"
 					" user.\n"
 					"\n"
+					"--benchmark\n"
+					" Measure the throughput of the encryption thread pool with different thread\n"
+					" counts and display the calibrated minimum fragment size of each encryption\n"
+					" algorithm.\n"
+					"\n"
 					"-c, --create[=VOLUME_PATH]\n"
 					" Create a new volume. Most options are requested from the user if not specified\n"
 					" on command line. See also options --encryption, -k, --filesystem, --hash, -p,\n"
@@ -1208,10 +1358,21 @@ namespace VeraCrypt
 					"\n"
 					"-m, --mount-options=OPTION1[,OPTION2,OPTION3,...]\n"
 					" Specifies comma-separated mount options for a VeraCrypt volume:\n"
+					"  directio: Bypass the page cache of the host when accessing the volume file or\n"
+					"   device, so that only decrypted data is cached.\n"
 					"  headerbak: Use backup headers when mounting a volume.\n"
 					"  nokernelcrypto: Do not use kernel cryptographic services.\n"
+					"  pinthreads: Bind each encryption thread to one of the CPUs available to the\n"
+					"   process. Only applies to volumes mounted without kernel cryptographic\n"
+					"   services (see nokernelcrypto).\n"
+					"  readahead=KIB: Size in KiB of the data read ahead of sequential reads of the\n"
+					"   volume image (default: 4096). 0 disables read-ahead.\n"
 					"  readonly|ro: Mount volume as read-only.\n"
 					"  system: Mount partition using system encryption.\n"
+					"  threads=NUMBER: Number of encryption threads used by the mounted volume. By\n"
+					"   default, one thread is used per CPU available to the process, taking CPU\n"
+					"   affinity and cgroup CPU quota into account. Only applies to volumes mounted\n"
+					"   without kernel cryptographic services (see nokernelcrypto).\n"
 					"  timestamp|ts: Do not restore host-file modification timestamp when a volume\n"
 					"   is dismounted (note that the operating system under certain circumstances\n"
 					"   does not alter host-file timestamps, which may be mistakenly interpreted\n"
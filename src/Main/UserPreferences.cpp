@@ -79,6 +79,7 @@ namespace VeraCrypt
 			TC_CONFIG_SET (CloseBackgroundTaskOnNoVolumes);
 			TC_CONFIG_SET (CloseExplorerWindowsOnDismount);
 			TC_CONFIG_SET (CloseSecurityTokenSessionsAfterMount);
+			SetValue (configMap[L"DirectIo"], DefaultMountOptions.DirectIo);
 			TC_CONFIG_SET (DisableKernelEncryptionModeWarning);
 			TC_CONFIG_SET (DismountOnInactivity);
 			TC_CONFIG_SET (DismountOnLogOff);
@@ -86,6 +87,11 @@ namespace VeraCrypt
 			TC_CONFIG_SET (DismountOnScreenSaver);
 			TC_CONFIG_SET (DisplayMessageAfterHotkeyDismount);
 			TC_CONFIG_SET (BackgroundTaskEnabled);
+
+			uint64 encryptionThreadCount = DefaultMountOptions.EncryptionThreadCount;
+			SetValue (configMap[L"EncryptionThreadCount"], encryptionThreadCount);
+			DefaultMountOptions.EncryptionThreadCount = (uint32) encryptionThreadCount;
+
 			SetValue (configMap[L"FilesystemOptions"], DefaultMountOptions.FilesystemOptions);
 			TC_CONFIG_SET (ForceAutoDismount);
 			TC_CONFIG_SET (LastSelectedSlotNumber);
@@ -101,7 +107,13 @@ namespace VeraCrypt
 			SetValue (configMap[L"NoHardwareCrypto"], DefaultMountOptions.NoHardwareCrypto);
 			SetValue (configMap[L"NoKernelCrypto"], DefaultMountOptions.NoKernelCrypto);
 			TC_CONFIG_SET (OpenExplorerWindowAfterMount);
+			SetValue (configMap[L"PinEncryptionThreads"], DefaultMountOptions.PinEncryptionThreads);
 			SetValue (configMap[L"PreserveTimestamps"], DefaultMountOptions.PreserveTimestamps);
+
+			uint64 readAheadSize = DefaultMountOptions.ReadAheadSize;
+			SetValue (configMap[L"ReadAheadSize"], readAheadSize);
+			DefaultMountOptions.ReadAheadSize = (uint32) readAheadSize;
+
 			TC_CONFIG_SET (SaveHistory);
 			SetValue (configMap[L"SecurityTokenLibrary"], SecurityTokenModule);
 			TC_CONFIG_SET (StartOnLogon);
@@ -197,6 +209,7 @@ namespace VeraCrypt
 		TC_CONFIG_ADD (CloseBackgroundTaskOnNoVolumes);
 		TC_CONFIG_ADD (CloseExplorerWindowsOnDismount);
 		TC_CONFIG_ADD (CloseSecurityTokenSessionsAfterMount);
+		formatter.AddEntry (L"DirectIo", DefaultMountOptions.DirectIo);
 		TC_CONFIG_ADD (DisableKernelEncryptionModeWarning);
 		TC_CONFIG_ADD (DismountOnInactivity);
 		TC_CONFIG_ADD (DismountOnLogOff);
@@ -204,6 +217,7 @@ namespace VeraCrypt
 		TC_CONFIG_ADD (DismountOnScreenSaver);
 		TC_CONFIG_ADD (DisplayMessageAfterHotkeyDismount);
 		TC_CONFIG_ADD (BackgroundTaskEnabled);
+		formatter.AddEntry (L"EncryptionThreadCount", (uint64) DefaultMountOptions.EncryptionThreadCount);
 		formatter.AddEntry (L"FilesystemOptions", DefaultMountOptions.FilesystemOptions);
 		TC_CONFIG_ADD (ForceAutoDismount);
 		TC_CONFIG_ADD (LastSelectedSlotNumber);
@@ -215,7 +229,9 @@ namespace VeraCrypt
 		formatter.AddEntry (L"NoHardwareCrypto", DefaultMountOptions.NoHardwareCrypto);
 		formatter.AddEntry (L"NoKernelCrypto", DefaultMountOptions.NoKernelCrypto);
 		TC_CONFIG_ADD (OpenExplorerWindowAfterMount);
+		formatter.AddEntry (L"PinEncryptionThreads", DefaultMountOptions.PinEncryptionThreads);
 		formatter.AddEntry (L"PreserveTimestamps", DefaultMountOptions.PreserveTimestamps);
+		formatter.AddEntry (L"ReadAheadSize", (uint64) DefaultMountOptions.ReadAheadSize);
 		TC_CONFIG_ADD (SaveHistory);
 		formatter.AddEntry (L"SecurityTokenLibrary", wstring (SecurityTokenModule));
 		TC_CONFIG_ADD (StartOnLogon);
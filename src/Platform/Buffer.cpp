@@ -12,6 +12,7 @@
 
 #include "Buffer.h"
 #include "Exception.h"
+#include "ForEach.h"
 
 namespace VeraCrypt
 {
@@ -133,6 +134,70 @@ namespace VeraCrypt
 		Buffer::Free ();
 	}
 
+	PooledSecureBuffer::PooledSecureBuffer (size_t size) : DataSize (size), PooledBuffer (nullptr)
+	{
+		list <SecureBuffer *> &buffers = CurrentThreadPool.Buffers;
+
+		for (list <SecureBuffer *>::iterator i = buffers.begin(); i != buffers.end(); ++i)
+		{
+			if ((*i)->Size() >= size)
+			{
+				PooledBuffer = *i;
+				buffers.erase (i);
+				PooledTotalSize -= PooledBuffer->Size();
+				return;
+			}
+		}
+
+		PooledBuffer = new SecureBuffer (max ((size_t) 1, (size + Alignment - 1) / Alignment) * Alignment, Alignment);
+		PooledBuffer->Zero();
+	}
+
+	PooledSecureBuffer::~PooledSecureBuffer ()
+	{
+		list <SecureBuffer *> &buffers = CurrentThreadPool.Buffers;
+
+		if (PooledBuffer->Size() > MaxPooledBufferSize || buffers.size() >= MaxPooledBufferCount)
+		{
+			delete PooledBuffer;
+			return;
+		}
+
+		// Buffers of idle threads would otherwise accumulate up to the limit of each thread
+		if (PooledTotalSize.fetch_add (PooledBuffer->Size()) + PooledBuffer->Size() > MaxPooledTotalSize)
+		{
+			PooledTotalSize -= PooledBuffer->Size();
+			delete PooledBuffer;
+			return;
+		}
+
+		// Only the part used by this request may hold data
+		if (DataSize > 0)
+			Memory::Zero (PooledBuffer->Ptr(), DataSize);
+
+		try
+		{
+			buffers.push_back (PooledBuffer);
+		}
+		catch (...)
+		{
+			PooledTotalSize -= PooledBuffer->Size();
+			delete PooledBuffer;
+		}
+	}
+
+	PooledSecureBuffer::ThreadPool::~ThreadPool ()
+	{
+		foreach (SecureBuffer *buffer, Buffers)
+		{
+			PooledTotalSize -= buffer->Size();
+			delete buffer;
+		}
+	}
+
+	thread_local PooledSecureBuffer::ThreadPool PooledSecureBuffer::CurrentThreadPool;
+	atomic <size_t> PooledSecureBuffer::PooledTotalSize (0);
+
 	void BufferPtr::CopyFrom (const ConstBufferPtr &bufferPtr) const
 	{
 		if (bufferPtr.Size() > DataSize)
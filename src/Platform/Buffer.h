@@ -13,6 +13,7 @@
 #ifndef TC_HEADER_Platform_Buffer
 #define TC_HEADER_Platform_Buffer
 
+#include <atomic>
 #include "PlatformBase.h"
 #include "Memory.h"
 
@@ -116,6 +117,49 @@ namespace VeraCrypt
 		SecureBuffer &operator= (const SecureBuffer &);
 	};
 
+	// Secure buffer taken from a pool of the calling thread and returned to it when destroyed,
+	// so that frequent I/O requests do not allocate and free a buffer each. Pooled buffers are
+	// page-aligned, zeroed when allocated and erased when returned. The size of the buffers held
+	// by the pools of all threads is limited to MaxPooledTotalSize. A PooledSecureBuffer must
+	// be destroyed by the thread that created it.
+	class PooledSecureBuffer
+	{
+	public:
+		PooledSecureBuffer (size_t size);
+		~PooledSecureBuffer ();
+
+		BufferPtr GetRange (size_t offset, size_t size) const { return BufferPtr (*this).GetRange (offset, size); }
+		byte *Ptr () const { return PooledBuffer->Ptr(); }
+		size_t Size () const { return DataSize; }
+
+		operator byte * () const { return PooledBuffer->Ptr(); }
+		operator BufferPtr () const { return BufferPtr (PooledBuffer->Ptr(), DataSize); }
+		operator ConstBufferPtr () const { return ConstBufferPtr (PooledBuffer->Ptr(), DataSize); }
+
+		static const size_t Alignment = 4096;
+		static const size_t MaxPooledBufferCount = 4;
+		static const size_t MaxPooledBufferSize = 4 * 1024 * 1024;
+		static const size_t MaxPooledTotalSize = 8 * 1024 * 1024;
+
+	protected:
+		struct ThreadPool
+		{
+			~ThreadPool ();
+
+			list <SecureBuffer *> Buffers;
+		};
+
+		size_t DataSize;
+		SecureBuffer *PooledBuffer;
+
+		static thread_local ThreadPool CurrentThreadPool;
+		static atomic <size_t> PooledTotalSize;
+
+	private:
+		PooledSecureBuffer (const PooledSecureBuffer &);
+		PooledSecureBuffer &operator= (const PooledSecureBuffer &);
+	};
+
 }
 
 #endif // TC_HEADER_Platform_Buffer
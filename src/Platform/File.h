@@ -16,6 +16,7 @@
 #include "PlatformBase.h"
 #include "Buffer.h"
 #include "FilesystemPath.h"
+#include "Mutex.h"
 #include "SystemException.h"
 
 namespace VeraCrypt
@@ -45,7 +46,8 @@ namespace VeraCrypt
 			// Bitmap
 			FlagsNone = 0,
 			PreserveTimestamps = 1 << 0,
-			DisableWriteCaching = 1 << 1
+			DisableWriteCaching = 1 << 1,
+			DirectIo = 1 << 2
 		};
 
 #ifdef TC_WINDOWS
@@ -54,7 +56,7 @@ namespace VeraCrypt
 		typedef int SystemFileHandleType;
 #endif
 
-		File () : FileIsOpen (false), mFileOpenFlags (FlagsNone), SharedHandle (false), FileHandle (0)
+		File () : FileIsOpen (false), mFileOpenFlags (FlagsNone), SharedHandle (false), FileHandle (0), DirectIoAlignment (0), DirectIoBypassCount (0)
 #ifndef TC_WINDOWS
 				,AccTime(0), ModTime (0)
 #endif
@@ -73,13 +75,16 @@ namespace VeraCrypt
 		void Close ();
 		static void Copy (const FilePath &sourcePath, const FilePath &destinationPath, bool preserveTimestamps = true);
 		void Delete ();
+		void DisableDirectIo ();
 		void Flush () const;
 		uint32 GetDeviceSectorSize () const;
+		size_t GetDirectIoAlignment () const { return DirectIoAlignment; }
 		static size_t GetOptimalReadSize () { return OptimalReadSize; }
 		static size_t GetOptimalWriteSize ()  { return OptimalWriteSize; }
 		uint64 GetPartitionDeviceStartOffset () const;
 		bool IsOpen () const { return FileIsOpen; }
 		FilePath GetPath () const;
+		SystemFileHandleType GetSystemHandle () const { return FileHandle; }
 		uint64 Length () const;
 		void Open (const FilePath &path, FileOpenMode mode = OpenRead, FileShareMode shareMode = ShareReadWrite, FileOpenFlags flags = FlagsNone);
 		uint64 Read (const BufferPtr &buffer) const;
@@ -91,7 +96,14 @@ namespace VeraCrypt
 		void Write (const ConstBufferPtr &buffer, size_t length) const { Write (buffer.GetRange (0, length)); }
 		void WriteAt (const ConstBufferPtr &buffer, uint64 position) const;
 
+		// Largest alignment of direct transfers supported
+		static const size_t MaxDirectIoAlignment = 4096;
+
 	protected:
+		bool BeginDirectIoBypass (const void *data, size_t size, uint64 position) const;
+		void EndDirectIoBypass () const;
+		size_t ProbeDirectIoAlignment () const;
+		void SetDirectIo (bool enable) const;
 		void ValidateState () const;
 
 		static const size_t OptimalReadSize = 256 * 1024;
@@ -103,6 +115,11 @@ namespace VeraCrypt
 		FilePath Path;
 		SystemFileHandleType FileHandle;
 
+		// Alignment of the memory, position and size of direct transfers, or 0 if caching is not bypassed
+		size_t DirectIoAlignment;
+		mutable size_t DirectIoBypassCount;
+		mutable Mutex DirectIoMutex;
+
 #ifdef TC_WINDOWS
 #else
 		time_t AccTime;
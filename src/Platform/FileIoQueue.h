@@ -0,0 +1,82 @@
+/*
+ Copyright (c) 2013-2017 IDRIX. All rights reserved.
+
+ Governed by the Apache License 2.0 the full text of which is
+ contained in the file License.txt included in VeraCrypt binary and source
+ code distribution packages.
+*/
+
+#ifndef TC_HEADER_Platform_FileIoQueue
+#define TC_HEADER_Platform_FileIoQueue
+
+#include "PlatformBase.h"
+#include "Buffer.h"
+#include "File.h"
+#include "SharedPtr.h"
+
+namespace VeraCrypt
+{
+	// Keeps several reads and writes of a file in flight. Requests are queued at explicit positions
+	// and passed to the system in batches by Submit(). Each request occupies one of the slots of
+	// the queue until its completion is collected by Wait(), and its buffer must not be released
+	// before then. On Linux, the requests are submitted to an io_uring instance when the build
+	// enables it (TC_IO_URING) and the kernel permits it. Otherwise, they are performed with
+	// pread() and pwrite() by Submit().
+	class FileIoQueue
+	{
+	public:
+		typedef size_t RequestId;
+
+		FileIoQueue (shared_ptr <File> file, size_t depth = DefaultDepth);
+		virtual ~FileIoQueue ();
+
+		size_t GetDepth () const { return Requests.size(); }
+		size_t GetFreeSlotCount () const { return FreeSlots.size(); }
+		bool IsAsynchronous () const;
+		RequestId QueueRead (const BufferPtr &buffer, uint64 position);
+		RequestId QueueWrite (const ConstBufferPtr &buffer, uint64 position);
+		void RegisterBuffers (const list <BufferPtr> &buffers);
+		void Reset ();
+		void Submit ();
+		uint64 Wait (RequestId request);
+		void WaitAll ();
+
+		static const size_t DefaultDepth = 16;
+
+	protected:
+		struct Request
+		{
+			Request () : Buffer (nullptr), Completed (false), InUse (false), Position (0), Result (0), Size (0), Submitted (false), Write (false) { }
+
+			byte *Buffer;
+			bool Completed;
+			bool InUse;
+			uint64 Position;
+			int64 Result;
+			size_t Size;
+			bool Submitted;
+			bool Write;
+		};
+
+		struct Ring;
+
+		void CloseRing ();
+		void OpenRing ();
+		void PerformRequest (Request &request);
+		RequestId QueueRequest (byte *buffer, size_t size, uint64 position, bool write);
+		void ReapCompletions (bool wait);
+
+		list <RequestId> FreeSlots;
+		shared_ptr <File> QueueFile;
+		list <BufferPtr> RegisteredBuffers;
+		vector <Request> Requests;
+		Ring *IoRing;
+		list <RequestId> UnsubmittedRequests;
+
+	private:
+		FileIoQueue (const FileIoQueue &);
+		FileIoQueue &operator= (const FileIoQueue &);
+	};
+}
+
+#endif // TC_HEADER_Platform_FileIoQueue
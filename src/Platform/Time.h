@@ -24,6 +24,7 @@ namespace VeraCrypt
 		virtual ~Time () { }
 
 		static uint64 GetCurrent (); // Returns time in hundreds of nanoseconds since 1601/01/01
+		static uint64 GetMonotonic (); // Returns time in nanoseconds from an unspecified starting point
 
 	private:
 		Time (const Time &);
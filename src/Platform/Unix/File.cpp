@@ -43,6 +43,7 @@
 #endif
 
 #include "Platform/File.h"
+#include "Platform/Finally.h"
 #include "Platform/TextReader.h"
 
 namespace VeraCrypt
@@ -70,6 +71,7 @@ namespace VeraCrypt
 		{
 			close (FileHandle);
 			FileIsOpen = false;
+			DirectIoAlignment = 0;
 
 			if ((mFileOpenFlags & File::PreserveTimestamps) && Path.IsFile())
 			{
@@ -91,12 +93,48 @@ namespace VeraCrypt
 		}
 	}
 
+	bool File::BeginDirectIoBypass (const void *data, size_t size, uint64 position) const
+	{
+		if (DirectIoAlignment == 0 || (((uint64) (uintptr_t) data | (uint64) size | position) % DirectIoAlignment) == 0)
+			return false;
+
+		// Transfers not aligned for direct I/O go through the page cache, which the kernel keeps coherent
+		// with direct transfers. O_DIRECT is a flag of the open file description, so it stays cleared
+		// until the unaligned transfers of all threads complete.
+		ScopeLock lock (DirectIoMutex);
+
+		if (DirectIoBypassCount == 0)
+			SetDirectIo (false);
+
+		++DirectIoBypassCount;
+		return true;
+	}
+
 	void File::Delete ()
 	{
 		Close();
 		Path.Delete();
 	}
 
+	void File::DisableDirectIo ()
+	{
+		if_debug (ValidateState());
+
+		ScopeLock lock (DirectIoMutex);
+
+		SetDirectIo (false);
+		DirectIoAlignment = 0;
+		mFileOpenFlags = (FileOpenFlags) (mFileOpenFlags & ~File::DirectIo);
+	}
+
+	void File::EndDirectIoBypass () const
+	{
+		ScopeLock lock (DirectIoMutex);
+
+		if (--DirectIoBypassCount == 0 && DirectIoAlignment != 0)
+			SetDirectIo (true);
+	}
+
 
 	void File::Flush () const
 	{
@@ -264,6 +302,13 @@ namespace VeraCrypt
 			throw ParameterIncorrect (SRC_POS);
 		}
 
+#ifdef O_DIRECT
+		if (flags & File::DirectIo)
+			sysFlags |= O_DIRECT;
+#else
+		flags = (FileOpenFlags) (flags & ~File::DirectIo);
+#endif
+
 		if ((flags & File::PreserveTimestamps) && path.IsFile())
 		{
 			struct stat statData;
@@ -273,6 +318,15 @@ namespace VeraCrypt
 		}
 
 		FileHandle = open (string (path).c_str(), sysFlags, S_IRUSR | S_IWUSR);
+
+#ifdef O_DIRECT
+		// Filesystems not supporting direct I/O may reject the flag
+		if (FileHandle == -1 && (sysFlags & O_DIRECT) && errno == EINVAL)
+		{
+			flags = (FileOpenFlags) (flags & ~File::DirectIo);
+			FileHandle = open (string (path).c_str(), sysFlags & ~O_DIRECT, S_IRUSR | S_IWUSR);
+		}
+#endif
 		throw_sys_sub_if (FileHandle == -1, wstring (path));
 
 #if 0 // File locking is disabled to avoid remote filesystem locking issues
@@ -324,6 +378,39 @@ namespace VeraCrypt
 		Path = path;
 		mFileOpenFlags = flags;
 		FileIsOpen = true;
+		DirectIoAlignment = 0;
+		DirectIoBypassCount = 0;
+
+		if (flags & File::DirectIo)
+		{
+			// Filesystems accepting the flag may still reject direct transfers
+			DirectIoAlignment = ProbeDirectIoAlignment();
+
+			if (DirectIoAlignment == 0)
+				DisableDirectIo();
+		}
+	}
+
+	size_t File::ProbeDirectIoAlignment () const
+	{
+		// Direct transfers must be aligned to the logical block size of the storage, which is determined
+		// by reads of the start of the file. Write-only files are assumed to require the largest alignment.
+		int flags = fcntl (FileHandle, F_GETFL);
+		if (flags != -1 && (flags & O_ACCMODE) == O_WRONLY)
+			return MaxDirectIoAlignment;
+
+		Buffer probeBuffer (MaxDirectIoAlignment, MaxDirectIoAlignment);
+
+		for (size_t alignment = 512; alignment <= MaxDirectIoAlignment; alignment *= 2)
+		{
+			if (pread (FileHandle, probeBuffer.Ptr(), alignment, 0) != -1)
+				return alignment;
+
+			if (errno != EINVAL)
+				break;
+		}
+
+		return 0;
 	}
 
 	uint64 File::Read (const BufferPtr &buffer) const
@@ -333,6 +420,10 @@ namespace VeraCrypt
 #ifdef TC_TRACE_FILE_OPERATIONS
 		TraceFileOperation (FileHandle, Path, false, buffer.Size());
 #endif
+		uint64 position = (DirectIoAlignment != 0 ? lseek (FileHandle, 0, SEEK_CUR) : 0);
+		bool directIoBypass = BeginDirectIoBypass (buffer, buffer.Size(), position);
+		finally_do_arg2 (const File *, this, bool, directIoBypass, { if (finally_arg2) finally_arg->EndDirectIoBypass(); });
+
 		ssize_t bytesRead = read (FileHandle, buffer, buffer.Size());
 		throw_sys_sub_if (bytesRead == -1, wstring (Path));
 
@@ -346,6 +437,9 @@ namespace VeraCrypt
 #ifdef TC_TRACE_FILE_OPERATIONS
 		TraceFileOperation (FileHandle, Path, false, buffer.Size(), position);
 #endif
+		bool directIoBypass = BeginDirectIoBypass (buffer, buffer.Size(), position);
+		finally_do_arg2 (const File *, this, bool, directIoBypass, { if (finally_arg2) finally_arg->EndDirectIoBypass(); });
+
 		ssize_t bytesRead = pread (FileHandle, buffer, buffer.Size(), position);
 		throw_sys_sub_if (bytesRead == -1, wstring (Path));
 
@@ -374,6 +468,17 @@ namespace VeraCrypt
 		throw_sys_sub_if (lseek (FileHandle, offset, SEEK_END) == -1, wstring (Path));
 	}
 
+	void File::SetDirectIo (bool enable) const
+	{
+#ifdef O_DIRECT
+		int flags = fcntl (FileHandle, F_GETFL);
+		throw_sys_sub_if (flags == -1, wstring (Path));
+
+		flags = (enable ? flags | O_DIRECT : flags & ~O_DIRECT);
+		throw_sys_sub_if (fcntl (FileHandle, F_SETFL, flags) == -1, wstring (Path));
+#endif
+	}
+
 	void File::Write (const ConstBufferPtr &buffer) const
 	{
 		if_debug (ValidateState());
@@ -381,6 +486,10 @@ namespace VeraCrypt
 #ifdef TC_TRACE_FILE_OPERATIONS
 		TraceFileOperation (FileHandle, Path, true, buffer.Size());
 #endif
+		uint64 position = (DirectIoAlignment != 0 ? lseek (FileHandle, 0, SEEK_CUR) : 0);
+		bool directIoBypass = BeginDirectIoBypass (buffer, buffer.Size(), position);
+		finally_do_arg2 (const File *, this, bool, directIoBypass, { if (finally_arg2) finally_arg->EndDirectIoBypass(); });
+
 		throw_sys_sub_if (write (FileHandle, buffer, buffer.Size()) != (ssize_t) buffer.Size(), wstring (Path));
 	}
 
@@ -391,6 +500,9 @@ namespace VeraCrypt
 #ifdef TC_TRACE_FILE_OPERATIONS
 		TraceFileOperation (FileHandle, Path, true, buffer.Size(), position);
 #endif
+		bool directIoBypass = BeginDirectIoBypass (buffer, buffer.Size(), position);
+		finally_do_arg2 (const File *, this, bool, directIoBypass, { if (finally_arg2) finally_arg->EndDirectIoBypass(); });
+
 		throw_sys_sub_if (pwrite (FileHandle, buffer, buffer.Size(), position) != (ssize_t) buffer.Size(), wstring (Path));
 	}
 }
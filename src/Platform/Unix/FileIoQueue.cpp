@@ -0,0 +1,496 @@
+/*
+ Copyright (c) 2013-2017 IDRIX. All rights reserved.
+
+ Governed by the Apache License 2.0 the full text of which is
+ contained in the file License.txt included in VeraCrypt binary and source
+ code distribution packages.
+*/
+
+#include <errno.h>
+#include <unistd.h>
+
+#if defined (TC_LINUX) && defined (TC_IO_URING)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+#include "Platform/FileIoQueue.h"
+#include "Platform/Memory.h"
+#include "Platform/SystemException.h"
+#include "Platform/Thread.h"
+
+namespace VeraCrypt
+{
+#if defined (TC_LINUX) && defined (TC_IO_URING)
+
+	// The ring is used through the system calls directly, so that the build does not depend on liburing
+	struct FileIoQueue::Ring
+	{
+		Ring () : CqMap (MAP_FAILED), CqMapSize (0), Fd (-1), FixedBuffers (false), SqeMap (MAP_FAILED), SqeMapSize (0), SqMap (MAP_FAILED), SqMapSize (0) { }
+
+		unsigned *CqHead;
+		void *CqMap;
+		size_t CqMapSize;
+		unsigned *CqMask;
+		unsigned *CqTail;
+		io_uring_cqe *Cqes;
+		int Fd;
+		bool FixedBuffers;
+		unsigned *SqArray;
+		void *SqeMap;
+		size_t SqeMapSize;
+		io_uring_sqe *Sqes;
+		void *SqMap;
+		size_t SqMapSize;
+		unsigned *SqMask;
+		unsigned *SqTail;
+	};
+
+	// Largest transfer of a single read or write system call. The remainder of a larger request is
+	// transferred when its completion is collected.
+	static const size_t MaxRingRequestSize = 0x7ffff000;
+
+#else
+
+	struct FileIoQueue::Ring
+	{
+	};
+
+#endif
+
+	FileIoQueue::FileIoQueue (shared_ptr <File> file, size_t depth)
+		: QueueFile (file), IoRing (nullptr)
+	{
+		if (!QueueFile || !QueueFile->IsOpen() || depth < 1)
+			throw ParameterIncorrect (SRC_POS);
+
+		Requests.resize (depth);
+
+		for (RequestId i = 0; i < depth; ++i)
+			FreeSlots.push_back (i);
+
+		OpenRing();
+	}
+
+	FileIoQueue::~FileIoQueue ()
+	{
+		try
+		{
+			Reset();
+		}
+		catch (...) { }
+
+		CloseRing();
+	}
+
+	void FileIoQueue::CloseRing ()
+	{
+#if defined (TC_LINUX) && defined (TC_IO_URING)
+		if (!IoRing)
+			return;
+
+		if (IoRing->SqeMap != MAP_FAILED)
+			munmap (IoRing->SqeMap, IoRing->SqeMapSize);
+
+		if (IoRing->CqMap != MAP_FAILED && IoRing->CqMap != IoRing->SqMap)
+			munmap (IoRing->CqMap, IoRing->CqMapSize);
+
+		if (IoRing->SqMap != MAP_FAILED)
+			munmap (IoRing->SqMap, IoRing->SqMapSize);
+
+		close (IoRing->Fd);
+#endif
+		delete IoRing;
+		IoRing = nullptr;
+	}
+
+	bool FileIoQueue::IsAsynchronous () const
+	{
+		return IoRing != nullptr;
+	}
+
+	void FileIoQueue::OpenRing ()
+	{
+#if defined (TC_LINUX) && defined (TC_IO_URING)
+		io_uring_params params;
+		Memory::Zero (&params, sizeof (params));
+
+		// Requests are performed synchronously if the kernel does not support io_uring or its use is
+		// not permitted (kernel.io_uring_disabled, seccomp filters of containers)
+		int ringFd = (int) syscall (__NR_io_uring_setup, (unsigned int) Requests.size(), &params);
+		if (ringFd == -1)
+			return;
+
+		IoRing = new Ring;
+		IoRing->Fd = ringFd;
+
+		IoRing->SqMapSize = params.sq_off.array + params.sq_entries * sizeof (unsigned);
+		IoRing->CqMapSize = params.cq_off.cqes + params.cq_entries * sizeof (io_uring_cqe);
+
+		if (params.features & IORING_FEAT_SINGLE_MMAP)
+		{
+			IoRing->SqMapSize = max (IoRing->SqMapSize, IoRing->CqMapSize);
+			IoRing->CqMapSize = IoRing->SqMapSize;
+		}
+
+		IoRing->SqMap = mmap (nullptr, IoRing->SqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+
+		if (IoRing->SqMap != MAP_FAILED)
+		{
+			if (params.features & IORING_FEAT_SINGLE_MMAP)
+				IoRing->CqMap = IoRing->SqMap;
+			else
+				IoRing->CqMap = mmap (nullptr, IoRing->CqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+		}
+
+		IoRing->SqeMapSize = params.sq_entries * sizeof (io_uring_sqe);
+		IoRing->SqeMap = mmap (nullptr, IoRing->SqeMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+
+		// The file is registered so that the kernel does not look up its descriptor for every request
+		int fileHandle = QueueFile->GetSystemHandle();
+
+		if (IoRing->SqMap == MAP_FAILED || IoRing->CqMap == MAP_FAILED || IoRing->SqeMap == MAP_FAILED
+			|| syscall (__NR_io_uring_register, ringFd, IORING_REGISTER_FILES, &fileHandle, 1) == -1)
+		{
+			CloseRing();
+			return;
+		}
+
+		// Requests whose buffers are not registered use IORING_OP_READ and IORING_OP_WRITE, which kernels
+		// before 5.6 reject. Those kernels do not support IORING_REGISTER_PROBE either.
+		const unsigned probeOpCount = max (IORING_OP_READ, IORING_OP_WRITE) + 1;
+		Buffer probeBuffer (sizeof (io_uring_probe) + probeOpCount * sizeof (io_uring_probe_op));
+		probeBuffer.Zero();
+
+		io_uring_probe *probe = (io_uring_probe *) probeBuffer.Ptr();
+
+		if (syscall (__NR_io_uring_register, ringFd, IORING_REGISTER_PROBE, probe, probeOpCount) == -1
+			|| probe->ops_len < probeOpCount
+			|| !(probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED)
+			|| !(probe->ops[IORING_OP_WRITE].flags & IO_URING_OP_SUPPORTED))
+		{
+			CloseRing();
+			return;
+		}
+
+		byte *sq = (byte *) IoRing->SqMap;
+		IoRing->SqArray = (unsigned *) (sq + params.sq_off.array);
+		IoRing->SqMask = (unsigned *) (sq + params.sq_off.ring_mask);
+		IoRing->SqTail = (unsigned *) (sq + params.sq_off.tail);
+		IoRing->Sqes = (io_uring_sqe *) IoRing->SqeMap;
+
+		byte *cq = (byte *) IoRing->CqMap;
+		IoRing->CqHead = (unsigned *) (cq + params.cq_off.head);
+		IoRing->CqMask = (unsigned *) (cq + params.cq_off.ring_mask);
+		IoRing->CqTail = (unsigned *) (cq + params.cq_off.tail);
+		IoRing->Cqes = (io_uring_cqe *) (cq + params.cq_off.cqes);
+#endif
+	}
+
+	void FileIoQueue::PerformRequest (Request &request)
+	{
+		// File handles the transfers not aligned for direct I/O
+		try
+		{
+			if (request.Write)
+			{
+				QueueFile->WriteAt (ConstBufferPtr (request.Buffer, request.Size), request.Position);
+				request.Result = request.Size;
+			}
+			else
+			{
+				request.Result = QueueFile->ReadAt (BufferPtr (request.Buffer, request.Size), request.Position);
+			}
+		}
+		catch (SystemException &e)
+		{
+			request.Result = (e.GetErrorCode() != 0 ? -e.GetErrorCode() : -EIO);
+		}
+
+		request.Submitted = true;
+		request.Completed = true;
+	}
+
+	FileIoQueue::RequestId FileIoQueue::QueueRead (const BufferPtr &buffer, uint64 position)
+	{
+		return QueueRequest (buffer.Get(), buffer.Size(), position, false);
+	}
+
+	FileIoQueue::RequestId FileIoQueue::QueueRequest (byte *buffer, size_t size, uint64 position, bool write)
+	{
+		if (FreeSlots.empty())
+			throw ParameterIncorrect (SRC_POS);
+
+		RequestId id = FreeSlots.front();
+		FreeSlots.pop_front();
+
+		Request &request = Requests[id];
+		request = Request();
+		request.Buffer = buffer;
+		request.InUse = true;
+		request.Position = position;
+		request.Size = size;
+		request.Write = write;
+
+		UnsubmittedRequests.push_back (id);
+		return id;
+	}
+
+	FileIoQueue::RequestId FileIoQueue::QueueWrite (const ConstBufferPtr &buffer, uint64 position)
+	{
+		return QueueRequest (const_cast <byte *> (buffer.Get()), buffer.Size(), position, true);
+	}
+
+	void FileIoQueue::ReapCompletions (bool wait)
+	{
+#if defined (TC_LINUX) && defined (TC_IO_URING)
+		for (int pass = 0; pass < 2; ++pass)
+		{
+			unsigned int head = *IoRing->CqHead;
+			unsigned int tail = __atomic_load_n (IoRing->CqTail, __ATOMIC_ACQUIRE);
+
+			if (head != tail)
+			{
+				for (; head != tail; ++head)
+				{
+					io_uring_cqe *cqe = &IoRing->Cqes[head & *IoRing->CqMask];
+					Request &request = Requests[(size_t) cqe->user_data];
+
+					request.Result = cqe->res;
+					request.Completed = true;
+				}
+
+				__atomic_store_n (IoRing->CqHead, head, __ATOMIC_RELEASE);
+				return;
+			}
+
+			if (!wait || pass > 0)
+				return;
+
+			// An interrupted wait returns to the caller, which checks its request again
+			if (syscall (__NR_io_uring_enter, IoRing->Fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) == -1)
+				throw_sys_sub_if (errno != EINTR, wstring (QueueFile->GetPath()));
+		}
+#endif
+	}
+
+	void FileIoQueue::RegisterBuffers (const list <BufferPtr> &buffers)
+	{
+		if (FreeSlots.size() != Requests.size())
+			throw ParameterIncorrect (SRC_POS);
+
+		RegisteredBuffers.clear();
+
+#if defined (TC_LINUX) && defined (TC_IO_URING)
+		if (!IoRing)
+			return;
+
+		if (IoRing->FixedBuffers)
+		{
+			syscall (__NR_io_uring_register, IoRing->Fd, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+			IoRing->FixedBuffers = false;
+		}
+
+		if (buffers.empty())
+			return;
+
+		vector <struct iovec> bufferVectors;
+		for (list <BufferPtr>::const_iterator i = buffers.begin(); i != buffers.end(); ++i)
+		{
+			struct iovec bufferVector;
+			bufferVector.iov_base = i->Get();
+			bufferVector.iov_len = i->Size();
+			bufferVectors.push_back (bufferVector);
+		}
+
+		// Registered buffers are pinned by the kernel and may exceed the limit of locked memory,
+		// in which case they are used as unregistered buffers
+		if (syscall (__NR_io_uring_register, IoRing->Fd, IORING_REGISTER_BUFFERS, &bufferVectors.front(), (unsigned int) bufferVectors.size()) == 0)
+		{
+			IoRing->FixedBuffers = true;
+			RegisteredBuffers = buffers;
+		}
+#endif
+	}
+
+	void FileIoQueue::Reset ()
+	{
+		// Requests not yet submitted are discarded, but the kernel may still access the buffers of
+		// submitted requests, which must therefore complete before their slots are released
+		for (RequestId id = 0; id < Requests.size(); ++id)
+		{
+			Request &request = Requests[id];
+
+			if (!request.InUse)
+				continue;
+
+			while (request.Submitted && !request.Completed)
+				ReapCompletions (true);
+
+			request.InUse = false;
+			FreeSlots.push_back (id);
+		}
+
+		UnsubmittedRequests.clear();
+	}
+
+	void FileIoQueue::Submit ()
+	{
+		if (UnsubmittedRequests.empty())
+			return;
+
+#if defined (TC_LINUX) && defined (TC_IO_URING)
+		if (IoRing)
+		{
+			// The submission ring has at least as many entries as the queue has slots
+			unsigned int tail = *IoRing->SqTail;
+			unsigned int submitCount = 0;
+
+			for (list <RequestId>::const_iterator i = UnsubmittedRequests.begin(); i != UnsubmittedRequests.end(); ++i)
+			{
+				Request &request = Requests[*i];
+
+				size_t alignment = QueueFile->GetDirectIoAlignment();
+				if (alignment != 0 && (((uint64) (uintptr_t) request.Buffer | (uint64) request.Size | request.Position) % alignment) != 0)
+				{
+					PerformRequest (request);
+					continue;
+				}
+
+				unsigned int index = tail & *IoRing->SqMask;
+
+				io_uring_sqe *sqe = &IoRing->Sqes[index];
+				Memory::Zero (sqe, sizeof (*sqe));
+
+				sqe->opcode = request.Write ? IORING_OP_WRITE : IORING_OP_READ;
+				sqe->fd = 0;
+				sqe->flags = IOSQE_FIXED_FILE;
+				sqe->addr = (uint64) (uintptr_t) request.Buffer;
+				sqe->len = (uint32) min (request.Size, MaxRingRequestSize);
+				sqe->off = request.Position;
+				sqe->user_data = *i;
+
+				uint16 bufferIndex = 0;
+				for (list <BufferPtr>::const_iterator b = RegisteredBuffers.begin(); b != RegisteredBuffers.end(); ++b, ++bufferIndex)
+				{
+					if (request.Buffer >= b->Get() && request.Buffer + request.Size <= b->Get() + b->Size())
+					{
+						sqe->opcode = request.Write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+						sqe->buf_index = bufferIndex;
+						break;
+					}
+				}
+
+				IoRing->SqArray[index] = index;
+				request.Submitted = true;
+
+				++tail;
+				++submitCount;
+			}
+
+			UnsubmittedRequests.clear();
+			__atomic_store_n (IoRing->SqTail, tail, __ATOMIC_RELEASE);
+
+			while (submitCount > 0)
+			{
+				int submitted = (int) syscall (__NR_io_uring_enter, IoRing->Fd, submitCount, 0, 0, nullptr, 0);
+
+				if (submitted == -1)
+				{
+					// Completions must be collected before the kernel accepts further requests, so one of
+					// the accepted requests is waited for, like io_uring_wait_cqe, if any is outstanding
+					if (errno == EAGAIN || errno == EBUSY)
+					{
+						size_t pendingCount = 0;
+						for (RequestId id = 0; id < Requests.size(); ++id)
+						{
+							if (Requests[id].Submitted && !Requests[id].Completed)
+								++pendingCount;
+						}
+
+						if (pendingCount > submitCount)
+							ReapCompletions (true);
+						else
+							Thread::Sleep (1);
+					}
+					else
+						throw_sys_sub_if (errno != EINTR, wstring (QueueFile->GetPath()));
+
+					continue;
+				}
+
+				submitCount -= submitted;
+			}
+
+			return;
+		}
+#endif
+		for (list <RequestId>::const_iterator i = UnsubmittedRequests.begin(); i != UnsubmittedRequests.end(); ++i)
+			PerformRequest (Requests[*i]);
+
+		UnsubmittedRequests.clear();
+	}
+
+	uint64 FileIoQueue::Wait (RequestId id)
+	{
+		if (id >= Requests.size() || !Requests[id].InUse)
+			throw ParameterIncorrect (SRC_POS);
+
+		Request &request = Requests[id];
+
+		if (!request.Submitted)
+			Submit();
+
+		while (!request.Completed)
+			ReapCompletions (true);
+
+		request.InUse = false;
+		FreeSlots.push_back (id);
+
+		if (request.Result < 0)
+		{
+			errno = (int) -request.Result;
+			throw SystemException (SRC_POS, wstring (QueueFile->GetPath()));
+		}
+
+		uint64 transferred = (uint64) request.Result;
+
+		// Transfers may be cut short, like those of read() and write()
+		if (request.Write && transferred < request.Size)
+		{
+			QueueFile->WriteAt (ConstBufferPtr (request.Buffer + transferred, request.Size - (size_t) transferred), request.Position + transferred);
+			transferred = request.Size;
+		}
+
+		while (!request.Write && transferred > 0 && transferred < request.Size)
+		{
+			uint64 bytesRead = QueueFile->ReadAt (BufferPtr (request.Buffer + transferred, request.Size - (size_t) transferred), request.Position + transferred);
+			if (bytesRead == 0)
+				break;
+
+			transferred += bytesRead;
+		}
+
+		return transferred;
+	}
+
+	void FileIoQueue::WaitAll ()
+	{
+		Submit();
+
+		// All requests complete before an error of any of them is reported
+		for (RequestId id = 0; id < Requests.size(); ++id)
+		{
+			while (Requests[id].InUse && !Requests[id].Completed)
+				ReapCompletions (true);
+		}
+
+		for (RequestId id = 0; id < Requests.size(); ++id)
+		{
+			if (Requests[id].InUse)
+				Wait (id);
+		}
+	}
+}
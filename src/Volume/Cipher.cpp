@@ -17,11 +17,16 @@
 #include "Crypto/Twofish.h"
 #include "Crypto/Camellia.h"
 #include "Crypto/kuznyechik.h"
+#include "Crypto/Xts_simd.h"
 
 #ifdef TC_AES_HW_CPU
 #	include "Crypto/Aes_hw_cpu.h"
 #endif
 
+#ifdef TC_XTS_AES_HW_CPU
+#	include "Crypto/Aes_vaes.h"
+#endif
+
 extern "C" int IsAesHwCpuSupported ()
 {
 #ifdef TC_AES_HW_CPU
@@ -69,6 +74,29 @@ namespace VeraCrypt
 		}
 	}
 
+	void Cipher::DecryptBlocksXTS (byte *data, byte *tweak, size_t blockCount) const
+	{
+		if (!Initialized)
+			throw NotInitialized (SRC_POS);
+
+		assert (GetBlockSize() == 16);
+		byte whiteningValues[XtsPassBlockCount * 16];
+
+		while (blockCount > 0)
+		{
+			size_t passBlockCount = min (blockCount, XtsPassBlockCount);
+
+			xts_whiten_blocks (data, whiteningValues, tweak, passBlockCount);
+			DecryptBlocks (data, passBlockCount);
+			xts_xor_blocks (data, whiteningValues, passBlockCount);
+
+			data += passBlockCount * 16;
+			blockCount -= passBlockCount;
+		}
+
+		FAST_ERASE64 (whiteningValues, sizeof (whiteningValues));
+	}
+
 	void Cipher::EncryptBlock (byte *data) const
 	{
 		if (!Initialized)
@@ -89,6 +117,29 @@ namespace VeraCrypt
 		}
 	}
 
+	void Cipher::EncryptBlocksXTS (byte *data, byte *tweak, size_t blockCount) const
+	{
+		if (!Initialized)
+			throw NotInitialized (SRC_POS);
+
+		assert (GetBlockSize() == 16);
+		byte whiteningValues[XtsPassBlockCount * 16];
+
+		while (blockCount > 0)
+		{
+			size_t passBlockCount = min (blockCount, XtsPassBlockCount);
+
+			xts_whiten_blocks (data, whiteningValues, tweak, passBlockCount);
+			EncryptBlocks (data, passBlockCount);
+			xts_xor_blocks (data, whiteningValues, passBlockCount);
+
+			data += passBlockCount * 16;
+			blockCount -= passBlockCount;
+		}
+
+		FAST_ERASE64 (whiteningValues, sizeof (whiteningValues));
+	}
+
 	CipherList Cipher::GetAvailableCiphers ()
 	{
 		CipherList l;
@@ -123,6 +174,21 @@ namespace VeraCrypt
 
 
 	// AES
+#ifdef TC_XTS_AES_HW_CPU
+	static bool IsAesVaesSupported ()
+	{
+		static bool state = false;
+		static bool stateValid = false;
+
+		if (!stateValid)
+		{
+			state = HasVAES() && HasVPCLMULQDQ() && HasAVX512F() && HasAVX512BW();
+			stateValid = true;
+		}
+		return state;
+	}
+#endif
+
 	void CipherAES::Decrypt (byte *data) const
 	{
 #ifdef TC_AES_HW_CPU
@@ -139,22 +205,52 @@ namespace VeraCrypt
 			throw NotInitialized (SRC_POS);
 
 #ifdef TC_AES_HW_CPU
-		if ((blockCount & (32 - 1)) == 0
-			&& IsHwSupportAvailable())
+		if (IsHwSupportAvailable())
 		{
-			while (blockCount > 0)
+#ifdef TC_XTS_AES_HW_CPU
+			if (IsAesVaesSupported())
+			{
+				aes_vaes_decrypt_blocks (ScheduledKey.Ptr() + sizeof (aes_encrypt_ctx), data, blockCount);
+				return;
+			}
+#endif
+			while (blockCount >= 32)
 			{
 				aes_hw_cpu_decrypt_32_blocks (ScheduledKey.Ptr() + sizeof (aes_encrypt_ctx), data);
 
 				data += 32 * GetBlockSize();
 				blockCount -= 32;
 			}
+
+			while (blockCount-- > 0)
+			{
+				aes_hw_cpu_decrypt (ScheduledKey.Ptr() + sizeof (aes_encrypt_ctx), data);
+				data += GetBlockSize();
+			}
 		}
 		else
 #endif
 			Cipher::DecryptBlocks (data, blockCount);
 	}
 
+	void CipherAES::DecryptBlocksXTS (byte *data, byte *tweak, size_t blockCount) const
+	{
+		if (!Initialized)
+			throw NotInitialized (SRC_POS);
+
+#ifdef TC_XTS_AES_HW_CPU
+		if (IsHwSupportAvailable())
+		{
+			if (IsAesVaesSupported())
+				xts_aes_vaes_decrypt_blocks (ScheduledKey.Ptr() + sizeof (aes_encrypt_ctx), data, tweak, blockCount);
+			else
+				xts_aes_hw_cpu_decrypt_blocks (ScheduledKey.Ptr() + sizeof (aes_encrypt_ctx), data, tweak, blockCount);
+		}
+		else
+#endif
+			Cipher::DecryptBlocksXTS (data, tweak, blockCount);
+	}
+
 	void CipherAES::Encrypt (byte *data) const
 	{
 #ifdef TC_AES_HW_CPU
@@ -171,22 +267,52 @@ namespace VeraCrypt
 			throw NotInitialized (SRC_POS);
 
 #ifdef TC_AES_HW_CPU
-		if ((blockCount & (32 - 1)) == 0
-			&& IsHwSupportAvailable())
+		if (IsHwSupportAvailable())
 		{
-			while (blockCount > 0)
+#ifdef TC_XTS_AES_HW_CPU
+			if (IsAesVaesSupported())
+			{
+				aes_vaes_encrypt_blocks (ScheduledKey.Ptr(), data, blockCount);
+				return;
+			}
+#endif
+			while (blockCount >= 32)
 			{
 				aes_hw_cpu_encrypt_32_blocks (ScheduledKey.Ptr(), data);
 
 				data += 32 * GetBlockSize();
 				blockCount -= 32;
 			}
+
+			while (blockCount-- > 0)
+			{
+				aes_hw_cpu_encrypt (ScheduledKey.Ptr(), data);
+				data += GetBlockSize();
+			}
 		}
 		else
 #endif
 			Cipher::EncryptBlocks (data, blockCount);
 	}
 
+	void CipherAES::EncryptBlocksXTS (byte *data, byte *tweak, size_t blockCount) const
+	{
+		if (!Initialized)
+			throw NotInitialized (SRC_POS);
+
+#ifdef TC_XTS_AES_HW_CPU
+		if (IsHwSupportAvailable())
+		{
+			if (IsAesVaesSupported())
+				xts_aes_vaes_encrypt_blocks (ScheduledKey.Ptr(), data, tweak, blockCount);
+			else
+				xts_aes_hw_cpu_encrypt_blocks (ScheduledKey.Ptr(), data, tweak, blockCount);
+		}
+		else
+#endif
+			Cipher::EncryptBlocksXTS (data, tweak, blockCount);
+	}
+
 	size_t CipherAES::GetScheduledKeySize () const
 	{
 		return sizeof(aes_encrypt_ctx) + sizeof(aes_decrypt_ctx);
@@ -248,7 +374,12 @@ namespace VeraCrypt
 		if ((blockCount >= 4)
 			&& IsHwSupportAvailable())
 		{
-			serpent_encrypt_blocks (data, data, blockCount, ScheduledKey.Ptr());
+			if (blockCount >= 16 && IsHwSupportEnabled() && HasAVX512F() && HasAVX512BW() && HasAVX512VL())
+				serpent_avx512_encrypt_blocks (data, data, blockCount, ScheduledKey.Ptr());
+			else if (blockCount >= 8 && IsHwSupportEnabled() && HasSAVX2())
+				serpent_avx2_encrypt_blocks (data, data, blockCount, ScheduledKey.Ptr());
+			else
+				serpent_encrypt_blocks (data, data, blockCount, ScheduledKey.Ptr());
 		}
 		else
 #endif
@@ -264,7 +395,12 @@ namespace VeraCrypt
 		if ((blockCount >= 4)
 			&& IsHwSupportAvailable())
 		{
-			serpent_decrypt_blocks (data, data, blockCount, ScheduledKey.Ptr());
+			if (blockCount >= 16 && IsHwSupportEnabled() && HasAVX512F() && HasAVX512BW() && HasAVX512VL())
+				serpent_avx512_decrypt_blocks (data, data, blockCount, ScheduledKey.Ptr());
+			else if (blockCount >= 8 && IsHwSupportEnabled() && HasSAVX2())
+				serpent_avx2_decrypt_blocks (data, data, blockCount, ScheduledKey.Ptr());
+			else
+				serpent_decrypt_blocks (data, data, blockCount, ScheduledKey.Ptr());
 		}
 		else
 #endif
@@ -315,11 +451,19 @@ namespace VeraCrypt
 		if (!Initialized)
 			throw NotInitialized (SRC_POS);
 
-#if CRYPTOPP_BOOL_X64 && !defined(CRYPTOPP_DISABLE_ASM)
-		twofish_encrypt_blocks ( (TwofishInstance *) ScheduledKey.Ptr(), data, data, blockCount);
-#else
-		Cipher::EncryptBlocks (data, blockCount);
+#if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE && !defined(CRYPTOPP_DISABLE_ASM)
+		if (blockCount >= 8 && IsHwSupportEnabled() && IsHwSupportAvailable())
+		{
+			if (blockCount >= 16 && HasAVX512F() && HasAVX512BW() && HasAVX512VL())
+				twofish_avx512_encrypt_blocks ( (TwofishInstance *) ScheduledKey.Ptr(), data, data, blockCount);
+			else if (HasSAVX2())
+				twofish_avx2_encrypt_blocks ( (TwofishInstance *) ScheduledKey.Ptr(), data, data, blockCount);
+			else
+				twofish_encrypt_blocks ( (TwofishInstance *) ScheduledKey.Ptr(), data, data, blockCount);
+		}
+		else
 #endif
+			twofish_encrypt_blocks ( (TwofishInstance *) ScheduledKey.Ptr(), data, data, blockCount);
 	}
 	
 	void CipherTwofish::DecryptBlocks (byte *data, size_t blockCount) const
@@ -327,17 +471,27 @@ namespace VeraCrypt
 		if (!Initialized)
 			throw NotInitialized (SRC_POS);
 
-#if CRYPTOPP_BOOL_X64 && !defined(CRYPTOPP_DISABLE_ASM)
-		twofish_decrypt_blocks ( (TwofishInstance *) ScheduledKey.Ptr(), data, data, blockCount);
-#else
-		Cipher::DecryptBlocks (data, blockCount);
+#if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE && !defined(CRYPTOPP_DISABLE_ASM)
+		if (blockCount >= 8 && IsHwSupportEnabled() && IsHwSupportAvailable())
+		{
+			if (blockCount >= 16 && HasAVX512F() && HasAVX512BW() && HasAVX512VL())
+				twofish_avx512_decrypt_blocks ( (TwofishInstance *) ScheduledKey.Ptr(), data, data, blockCount);
+			else if (HasSAVX2())
+				twofish_avx2_decrypt_blocks ( (TwofishInstance *) ScheduledKey.Ptr(), data, data, blockCount);
+			else
+				twofish_decrypt_blocks ( (TwofishInstance *) ScheduledKey.Ptr(), data, data, blockCount);
+		}
+		else
 #endif
+			twofish_decrypt_blocks ( (TwofishInstance *) ScheduledKey.Ptr(), data, data, blockCount);
 	}
 	
 	bool CipherTwofish::IsHwSupportAvailable () const
 	{
 #if CRYPTOPP_BOOL_X64 && !defined(CRYPTOPP_DISABLE_ASM)
 		return true;
+#elif CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE && !defined(CRYPTOPP_DISABLE_ASM)
+		return HasSAVX2();
 #else
 		return false;
 #endif
@@ -426,7 +580,10 @@ namespace VeraCrypt
 		if ((blockCount >= 4)
 			&& IsHwSupportAvailable())
 		{
-			kuznyechik_encrypt_blocks (data, data, blockCount, (kuznyechik_kds *) ScheduledKey.Ptr());
+			if (blockCount >= 32 && HasAVX512F() && HasAVX512BW() && HasAVX512VBMI() && HasGFNI())
+				kuznyechik_avx512_encrypt_blocks (data, data, blockCount, (kuznyechik_kds *) ScheduledKey.Ptr());
+			else
+				kuznyechik_encrypt_blocks (data, data, blockCount, (kuznyechik_kds *) ScheduledKey.Ptr());
 		}
 		else
 #endif
@@ -442,7 +599,10 @@ namespace VeraCrypt
 		if ((blockCount >= 4)
 			&& IsHwSupportAvailable())
 		{
-			kuznyechik_decrypt_blocks (data, data, blockCount, (kuznyechik_kds *) ScheduledKey.Ptr());
+			if (blockCount >= 32 && HasAVX512F() && HasAVX512BW() && HasAVX512VBMI() && HasGFNI())
+				kuznyechik_avx512_decrypt_blocks (data, data, blockCount, (kuznyechik_kds *) ScheduledKey.Ptr());
+			else
+				kuznyechik_decrypt_blocks (data, data, blockCount, (kuznyechik_kds *) ScheduledKey.Ptr());
 		}
 		else
 #endif
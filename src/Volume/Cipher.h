@@ -28,9 +28,11 @@ namespace VeraCrypt
 
 		virtual void DecryptBlock (byte *data) const;
 		virtual void DecryptBlocks (byte *data, size_t blockCount) const;
+		virtual void DecryptBlocksXTS (byte *data, byte *tweak, size_t blockCount) const;
 		static void EnableHwSupport (bool enable) { HwSupportEnabled = enable; }
 		virtual void EncryptBlock (byte *data) const;
 		virtual void EncryptBlocks (byte *data, size_t blockCount) const;
+		virtual void EncryptBlocksXTS (byte *data, byte *tweak, size_t blockCount) const;
 		static CipherList GetAvailableCiphers ();
 		virtual size_t GetBlockSize () const = 0;
 		virtual const SecureBuffer &GetKey () const { return Key; }
@@ -44,6 +46,11 @@ namespace VeraCrypt
 		static const int MaxBlockSize = 16;
 
 	protected:
+		// Number of blocks whitened per pass of the generic XTS implementation. Only AES overrides it
+		// with a fused kernel; Serpent, Twofish, Camellia and Kuznyechik are whitened around their
+		// multi-block routines.
+		static const size_t XtsPassBlockCount = 32;
+
 		Cipher ();
 
 		virtual void Decrypt (byte *data) const = 0;
@@ -96,10 +103,19 @@ namespace VeraCrypt
 
 #define TC_CIPHER_ADD_METHODS \
 	virtual void DecryptBlocks (byte *data, size_t blockCount) const; \
+	virtual void DecryptBlocksXTS (byte *data, byte *tweak, size_t blockCount) const; \
 	virtual void EncryptBlocks (byte *data, size_t blockCount) const; \
+	virtual void EncryptBlocksXTS (byte *data, byte *tweak, size_t blockCount) const; \
 	virtual bool IsHwSupportAvailable () const;
 
 	TC_CIPHER (AES, 16, 32);
+
+#undef TC_CIPHER_ADD_METHODS
+#define TC_CIPHER_ADD_METHODS \
+	virtual void DecryptBlocks (byte *data, size_t blockCount) const; \
+	virtual void EncryptBlocks (byte *data, size_t blockCount) const; \
+	virtual bool IsHwSupportAvailable () const;
+
 	TC_CIPHER (Serpent, 16, 32);
 	TC_CIPHER (Twofish, 16, 32);
 	TC_CIPHER (Camellia, 16, 32);
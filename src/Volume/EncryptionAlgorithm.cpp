@@ -23,6 +23,24 @@ namespace VeraCrypt
 	{
 	}
 
+	shared_ptr <EncryptionThreadPool::WorkItemCompletion> EncryptionAlgorithm::BeginDecryptSectors (byte *data, uint64 sectorIndex, uint64 sectorCount, size_t sectorSize) const
+	{
+		if_debug (ValidateState());
+		return EncryptionThreadPool::BeginWork (EncryptionThreadPool::WorkType::DecryptDataUnits, Mode.get(), data, sectorIndex, sectorCount, sectorSize);
+	}
+
+	shared_ptr <EncryptionThreadPool::WorkItemCompletion> EncryptionAlgorithm::BeginEncryptSectors (byte *data, uint64 sectorIndex, uint64 sectorCount, size_t sectorSize) const
+	{
+		if_debug (ValidateState());
+		return EncryptionThreadPool::BeginWork (EncryptionThreadPool::WorkType::EncryptDataUnits, Mode.get(), data, sectorIndex, sectorCount, sectorSize);
+	}
+
+	shared_ptr <EncryptionThreadPool::WorkItemCompletion> EncryptionAlgorithm::BeginEncryptSectors (const byte *source, byte *destination, uint64 sectorIndex, uint64 sectorCount, size_t sectorSize) const
+	{
+		if_debug (ValidateState());
+		return EncryptionThreadPool::BeginWork (EncryptionThreadPool::WorkType::EncryptDataUnits, Mode.get(), source, destination, sectorIndex, sectorCount, sectorSize);
+	}
+
 	void EncryptionAlgorithm::Decrypt (byte *data, uint64 length) const
 	{
 		if_debug (ValidateState ());
@@ -57,6 +75,12 @@ namespace VeraCrypt
 		Mode->EncryptSectors (data, sectorIndex, sectorCount, sectorSize);
 	}
 
+	void EncryptionAlgorithm::EncryptSectors (const byte *source, byte *destination, uint64 sectorIndex, uint64 sectorCount, size_t sectorSize) const
+	{
+		if_debug (ValidateState ());
+		Mode->EncryptSectors (source, destination, sectorIndex, sectorCount, sectorSize);
+	}
+
 	EncryptionAlgorithmList EncryptionAlgorithm::GetAvailableAlgorithms ()
 	{
 		EncryptionAlgorithmList l;
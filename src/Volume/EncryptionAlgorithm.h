@@ -16,6 +16,7 @@
 #include "Platform/Platform.h"
 #include "Cipher.h"
 #include "EncryptionMode.h"
+#include "EncryptionThreadPool.h"
 
 namespace VeraCrypt
 {
@@ -27,12 +28,16 @@ namespace VeraCrypt
 	public:
 		virtual ~EncryptionAlgorithm ();
 
+		virtual shared_ptr <EncryptionThreadPool::WorkItemCompletion> BeginDecryptSectors (byte *data, uint64 sectorIndex, uint64 sectorCount, size_t sectorSize) const;
+		virtual shared_ptr <EncryptionThreadPool::WorkItemCompletion> BeginEncryptSectors (byte *data, uint64 sectorIndex, uint64 sectorCount, size_t sectorSize) const;
+		virtual shared_ptr <EncryptionThreadPool::WorkItemCompletion> BeginEncryptSectors (const byte *source, byte *destination, uint64 sectorIndex, uint64 sectorCount, size_t sectorSize) const;
 		virtual void Decrypt (byte *data, uint64 length) const;
 		virtual void Decrypt (const BufferPtr &data) const;
 		virtual void DecryptSectors (byte *data, uint64 sectorIndex, uint64 sectorCount, size_t sectorSize) const;
 		virtual void Encrypt (byte *data, uint64 length) const;
 		virtual void Encrypt (const BufferPtr &data) const;
 		virtual void EncryptSectors (byte *data, uint64 sectorIndex, uint64 sectorCount, size_t sectorSize) const;
+		virtual void EncryptSectors (const byte *source, byte *destination, uint64 sectorIndex, uint64 sectorCount, size_t sectorSize) const;
 		static EncryptionAlgorithmList GetAvailableAlgorithms ();
 		virtual const CipherList &GetCiphers () const { return Ciphers; }
 		virtual shared_ptr <EncryptionAlgorithm> GetNew () const = 0;
@@ -16,7 +16,7 @@
 
 namespace VeraCrypt
 {
-	EncryptionMode::EncryptionMode () : KeySet (false), SectorOffset (0)
+	EncryptionMode::EncryptionMode () : KeySet (false), MinFragmentSize (ENCRYPTION_DATA_UNIT_SIZE), SectorOffset (0)
 	{
 	}
 
@@ -34,6 +34,17 @@ namespace VeraCrypt
 		EncryptionThreadPool::DoWork (EncryptionThreadPool::WorkType::EncryptDataUnits, this, data, sectorIndex, sectorCount, sectorSize);
 	}
 
+	void EncryptionMode::EncryptSectors (const byte *source, byte *destination, uint64 sectorIndex, uint64 sectorCount, size_t sectorSize) const
+	{
+		EncryptionThreadPool::DoWork (EncryptionThreadPool::WorkType::EncryptDataUnits, this, source, destination, sectorIndex, sectorCount, sectorSize);
+	}
+
+	void EncryptionMode::EncryptSectorsCurrentThread (const byte *source, byte *destination, uint64 sectorIndex, uint64 sectorCount, size_t sectorSize) const
+	{
+		Memory::Copy (destination, source, (size_t) (sectorCount * sectorSize));
+		EncryptSectorsCurrentThread (destination, sectorIndex, sectorCount, sectorSize);
+	}
+
 	EncryptionModeList EncryptionMode::GetAvailableModes ()
 	{
 		EncryptionModeList l;
@@ -43,6 +54,12 @@ namespace VeraCrypt
 		return l;
 	}
 
+	void EncryptionMode::SetCiphers (const CipherList &ciphers)
+	{
+		Ciphers = ciphers;
+		MinFragmentSize = EncryptionThreadPool::GetMinFragmentSize (ciphers);
+	}
+
 	void EncryptionMode::ValidateState () const
 	{
 		if (!KeySet || Ciphers.size() < 1)
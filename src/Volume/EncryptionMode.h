@@ -32,16 +32,19 @@ namespace VeraCrypt
 		virtual void DecryptSectorsCurrentThread (byte *data, uint64 sectorIndex, uint64 sectorCount, size_t sectorSize) const = 0;
 		virtual void Encrypt (byte *data, uint64 length) const = 0;
 		virtual void EncryptSectors (byte *data, uint64 sectorIndex, uint64 sectorCount, size_t sectorSize) const;
+		virtual void EncryptSectors (const byte *source, byte *destination, uint64 sectorIndex, uint64 sectorCount, size_t sectorSize) const;
 		virtual void EncryptSectorsCurrentThread (byte *data, uint64 sectorIndex, uint64 sectorCount, size_t sectorSize) const = 0;
+		virtual void EncryptSectorsCurrentThread (const byte *source, byte *destination, uint64 sectorIndex, uint64 sectorCount, size_t sectorSize) const;
 		static EncryptionModeList GetAvailableModes ();
 		virtual const SecureBuffer &GetKey () const { throw NotApplicable (SRC_POS); }
 		virtual size_t GetKeySize () const = 0;
+		virtual size_t GetMinFragmentSize () const { return MinFragmentSize; }
 		virtual wstring GetName () const = 0;
 		virtual shared_ptr <EncryptionMode> GetNew () const = 0;
 		virtual uint64 GetSectorOffset () const { return SectorOffset; }
 		virtual bool IsKeySet () const { return KeySet; }
 		virtual void SetKey (const ConstBufferPtr &key) = 0;
-		virtual void SetCiphers (const CipherList &ciphers) { Ciphers = ciphers; }
+		virtual void SetCiphers (const CipherList &ciphers);
 		virtual void SetSectorOffset (int64 offset) { SectorOffset = offset; }
 
 	protected:
@@ -55,6 +58,7 @@ namespace VeraCrypt
 
 		CipherList Ciphers;
 		bool KeySet;
+		size_t MinFragmentSize;
 		uint64 SectorOffset;
 
 	private:
@@ -10,43 +10,123 @@
  code distribution packages.
 */
 
+#include <typeinfo>
 #include "Crypto/cpu.h"
 #include "Crypto/misc.h"
+#include "Crypto/Xts_simd.h"
 #include "EncryptionModeXTS.h"
 #include "Common/Crypto.h"
 
-#if (CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE && CRYPTOPP_BOOL_X64)
-
-#define XorBlocks(result,ptr,len,start,end) \
-	while (len >= 2) \
-	{ \
-		__m128i xmm1 = _mm_loadu_si128((const __m128i*) ptr); \
-		__m128i xmm2 = _mm_loadu_si128((__m128i*)result); \
-		__m128i xmm3 = _mm_loadu_si128((const __m128i*) (ptr + 2)); \
-		__m128i xmm4 = _mm_loadu_si128((__m128i*)(result + 2)); \
-		\
-		_mm_storeu_si128((__m128i*)result, _mm_xor_si128(xmm1, xmm2)); \
-		_mm_storeu_si128((__m128i*)(result + 2), _mm_xor_si128(xmm3, xmm4)); \
-		ptr+= 4; \
-		result+= 4; \
-		len -= 2; \
-	} \
-	\
-	if (len) \
-	{ \
-		__m128i xmm1 = _mm_loadu_si128((const __m128i*)ptr); \
-		__m128i xmm2 = _mm_loadu_si128((__m128i*)result); \
-		\
-		_mm_storeu_si128((__m128i*)result, _mm_xor_si128(xmm1, xmm2)); \
-		ptr+= 2; \
-		result+= 2; \
-	} \
-	len = end - start;
-
-#endif
-
 namespace VeraCrypt
 {
+	// Calls the block functions of a cipher whose concrete type is known at compile time, so that
+	// they are not dispatched through the virtual function table. Ciphers without an XTS implementation
+	// of their own are whitened here around their block functions, as Cipher::EncryptBlocksXTS would
+	// call them virtually. XtsCascadeCipher <Cipher> uses virtual calls, and XtsCascadeCipher <void>
+	// stands for an unused position of a cascade.
+	template <class CipherType>
+	struct XtsCascadeCipher
+	{
+		static void DecryptBlocksXTS (const Cipher &cipher, byte *data, byte *tweak, size_t blockCount)
+		{
+			byte whiteningValues [BLOCKS_PER_XTS_DATA_UNIT * BYTES_PER_XTS_BLOCK];
+
+			while (blockCount > 0)
+			{
+				size_t passBlockCount = min (blockCount, (size_t) BLOCKS_PER_XTS_DATA_UNIT);
+
+				xts_whiten_blocks (data, whiteningValues, tweak, passBlockCount);
+				static_cast <const CipherType &> (cipher).CipherType::DecryptBlocks (data, passBlockCount);
+				xts_xor_blocks (data, whiteningValues, passBlockCount);
+
+				data += passBlockCount * BYTES_PER_XTS_BLOCK;
+				blockCount -= passBlockCount;
+			}
+
+			FAST_ERASE64 (whiteningValues, sizeof (whiteningValues));
+		}
+
+		static void EncryptBlocks (const Cipher &cipher, byte *data, size_t blockCount)
+		{
+			static_cast <const CipherType &> (cipher).CipherType::EncryptBlocks (data, blockCount);
+		}
+
+		static void EncryptBlocksXTS (const Cipher &cipher, byte *data, byte *tweak, size_t blockCount)
+		{
+			byte whiteningValues [BLOCKS_PER_XTS_DATA_UNIT * BYTES_PER_XTS_BLOCK];
+
+			while (blockCount > 0)
+			{
+				size_t passBlockCount = min (blockCount, (size_t) BLOCKS_PER_XTS_DATA_UNIT);
+
+				xts_whiten_blocks (data, whiteningValues, tweak, passBlockCount);
+				static_cast <const CipherType &> (cipher).CipherType::EncryptBlocks (data, passBlockCount);
+				xts_xor_blocks (data, whiteningValues, passBlockCount);
+
+				data += passBlockCount * BYTES_PER_XTS_BLOCK;
+				blockCount -= passBlockCount;
+			}
+
+			FAST_ERASE64 (whiteningValues, sizeof (whiteningValues));
+		}
+
+		static bool Matches (const CipherList &ciphers, size_t index)
+		{
+			return index < ciphers.size() && typeid (*ciphers[index]) == typeid (CipherType);
+		}
+	};
+
+	template <>
+	struct XtsCascadeCipher <Cipher>
+	{
+		static void DecryptBlocksXTS (const Cipher &cipher, byte *data, byte *tweak, size_t blockCount)
+		{
+			cipher.DecryptBlocksXTS (data, tweak, blockCount);
+		}
+
+		static void EncryptBlocks (const Cipher &cipher, byte *data, size_t blockCount)
+		{
+			cipher.EncryptBlocks (data, blockCount);
+		}
+
+		static void EncryptBlocksXTS (const Cipher &cipher, byte *data, byte *tweak, size_t blockCount)
+		{
+			cipher.EncryptBlocksXTS (data, tweak, blockCount);
+		}
+	};
+
+	// AES generates the whitening values in the same pass as its rounds
+	template <>
+	void XtsCascadeCipher <CipherAES>::DecryptBlocksXTS (const Cipher &cipher, byte *data, byte *tweak, size_t blockCount)
+	{
+		static_cast <const CipherAES &> (cipher).CipherAES::DecryptBlocksXTS (data, tweak, blockCount);
+	}
+
+	template <>
+	void XtsCascadeCipher <CipherAES>::EncryptBlocksXTS (const Cipher &cipher, byte *data, byte *tweak, size_t blockCount)
+	{
+		static_cast <const CipherAES &> (cipher).CipherAES::EncryptBlocksXTS (data, tweak, blockCount);
+	}
+
+	template <>
+	struct XtsCascadeCipher <void>
+	{
+		static bool Matches (const CipherList &ciphers, size_t index)
+		{
+			return index >= ciphers.size();
+		}
+	};
+
+	template <>
+	void EncryptionModeXTS::DecryptCascadeStage <void> (size_t cipherIndex, byte *data, uint64 length, uint64 startDataUnitNo) const
+	{
+	}
+
+	template <>
+	void EncryptionModeXTS::EncryptCascadeStage <void> (size_t cipherIndex, byte *data, uint64 length, uint64 startDataUnitNo) const
+	{
+	}
+
 	void EncryptionModeXTS::Encrypt (byte *data, uint64 length) const
 	{
 		EncryptBuffer (data, length, 0);
@@ -56,28 +136,31 @@ namespace VeraCrypt
 	{
 		if_debug (ValidateState());
 
+		if (EncryptCascadeFunction)
+		{
+			(this->*EncryptCascadeFunction) (data, length, startDataUnitNo);
+			return;
+		}
+
 		CipherList::const_iterator iSecondaryCipher = SecondaryCiphers.begin();
 
 		for (CipherList::const_iterator iCipher = Ciphers.begin(); iCipher != Ciphers.end(); ++iCipher)
 		{
-			EncryptBufferXTS (**iCipher, **iSecondaryCipher, data, length, startDataUnitNo, 0);
+			EncryptBufferXTS <Cipher> (**iCipher, **iSecondaryCipher, data, length, startDataUnitNo, 0);
 			++iSecondaryCipher;
 		}
 
 		assert (iSecondaryCipher == SecondaryCiphers.end());
 	}
 
+	template <class CipherType>
 	void EncryptionModeXTS::EncryptBufferXTS (const Cipher &cipher, const Cipher &secondaryCipher, byte *buffer, uint64 length, uint64 startDataUnitNo, unsigned int startCipherBlockNo) const
 	{
-		byte finalCarry;
-		byte whiteningValues [ENCRYPTION_DATA_UNIT_SIZE];
-		byte whiteningValue [BYTES_PER_XTS_BLOCK];
-		byte byteBufUnitNo [BYTES_PER_XTS_BLOCK];
-		uint64 *whiteningValuesPtr64 = (uint64 *) whiteningValues;
-		uint64 *whiteningValuePtr64 = (uint64 *) whiteningValue;
-		uint64 *bufPtr = (uint64 *) buffer;
-		uint64 *dataUnitBufPtr;
-		unsigned int startBlock = startCipherBlockNo, endBlock, block, countBlock;
+		byte whiteningValues [TweakBatchSize * BYTES_PER_XTS_BLOCK];
+		byte skippedBlock [BYTES_PER_XTS_BLOCK] = { 0 };
+		uint64 *whiteningValuesPtr64;
+		unsigned int startBlock = startCipherBlockNo, block, countBlock;
+		size_t unit, unitCount, maxUnitCount = 0;
 		uint64 remainingBlocks, dataUnitNo;
 
 		startDataUnitNo += SectorOffset;
@@ -89,11 +172,7 @@ namespace VeraCrypt
 		the shift of the highest byte results in a carry, 135 is XORed into the lowest byte. The value 135 is
 		derived from the modulus of the Galois Field (x^128+x^7+x^2+x+1). */
 
-		// Convert the 64-bit data unit number into a little-endian 16-byte array.
-		// Note that as we are converting a 64-bit number into a 16-byte array we can always zero the last 8 bytes.
 		dataUnitNo = startDataUnitNo;
-		*((uint64 *) byteBufUnitNo) = Endian::Little (dataUnitNo);
-		*((uint64 *) byteBufUnitNo + 1) = 0;
 
 		if (length % BYTES_PER_XTS_BLOCK)
 			TC_THROW_FATAL_EXCEPTION;
@@ -103,108 +182,71 @@ namespace VeraCrypt
 		// Process all blocks in the buffer
 		while (remainingBlocks > 0)
 		{
-			if (remainingBlocks < BLOCKS_PER_XTS_DATA_UNIT)
-				endBlock = startBlock + (unsigned int) remainingBlocks;
-			else
-				endBlock = BLOCKS_PER_XTS_DATA_UNIT;
-			countBlock = endBlock - startBlock;
+			unitCount = (size_t) min ((uint64) TweakBatchSize, (startBlock + remainingBlocks + BLOCKS_PER_XTS_DATA_UNIT - 1) / BLOCKS_PER_XTS_DATA_UNIT);
+			maxUnitCount = max (maxUnitCount, unitCount);
 
+			// Encrypt the data unit numbers of a batch of data units using the secondary key (in order to
+			// generate the first whitening value for each data unit). As each 64-bit data unit number is
+			// converted into a little-endian 16-byte array, the last 8 bytes are always zero.
 			whiteningValuesPtr64 = (uint64 *) whiteningValues;
-			whiteningValuePtr64 = (uint64 *) whiteningValue;
-
-			// Encrypt the data unit number using the secondary key (in order to generate the first
-			// whitening value for this data unit)
-			*whiteningValuePtr64 = *((uint64 *) byteBufUnitNo);
-			*(whiteningValuePtr64 + 1) = 0;
-			secondaryCipher.EncryptBlock (whiteningValue);
 
-			// Generate subsequent whitening values for blocks in this data unit. Note that all generated 128-bit
-			// whitening values are stored in memory as a sequence of 64-bit integers.
-			for (block = 0; block < endBlock; block++)
+			for (unit = 0; unit < unitCount; unit++)
 			{
-				if (block >= startBlock)
-				{
-					*whiteningValuesPtr64++ = *whiteningValuePtr64++;
-					*whiteningValuesPtr64++ = *whiteningValuePtr64;
-				}
-				else
-					whiteningValuePtr64++;
-
-				// Derive the next whitening value
-
-#if BYTE_ORDER == LITTLE_ENDIAN
-
-				// Little-endian platforms
-
-				finalCarry =
-					(*whiteningValuePtr64 & 0x8000000000000000ULL) ?
-					135 : 0;
-
-				*whiteningValuePtr64-- <<= 1;
-
-				if (*whiteningValuePtr64 & 0x8000000000000000ULL)
-					*(whiteningValuePtr64 + 1) |= 1;
-
-				*whiteningValuePtr64 <<= 1;
-#else
-
-				// Big-endian platforms
+				*whiteningValuesPtr64++ = Endian::Little (dataUnitNo + unit);
+				*whiteningValuesPtr64++ = 0;
+			}
 
-				finalCarry =
-					(*whiteningValuePtr64 & 0x80) ?
-					135 : 0;
+			XtsCascadeCipher <CipherType>::EncryptBlocks (secondaryCipher, whiteningValues, unitCount);
 
-				*whiteningValuePtr64 = Endian::Little (Endian::Little (*whiteningValuePtr64) << 1);
+			for (unit = 0; unit < unitCount; unit++)
+			{
+				byte *whiteningValue = whiteningValues + unit * BYTES_PER_XTS_BLOCK;
 
-				whiteningValuePtr64--;
+				if (remainingBlocks < BLOCKS_PER_XTS_DATA_UNIT - startBlock)
+					countBlock = (unsigned int) remainingBlocks;
+				else
+					countBlock = BLOCKS_PER_XTS_DATA_UNIT - startBlock;
 
-				if (*whiteningValuePtr64 & 0x80)
-					*(whiteningValuePtr64 + 1) |= 0x0100000000000000ULL;
+				for (block = 0; block < startBlock; block++)
+					xts_whiten_blocks (skippedBlock, skippedBlock, whiteningValue, 1);
 
-				*whiteningValuePtr64 = Endian::Little (Endian::Little (*whiteningValuePtr64) << 1);
-#endif
+				// Subsequent whitening values are derived by the cipher while it processes the blocks
+				// of this data unit, so that they are generated in the same pass as the encryption
+				XtsCascadeCipher <CipherType>::EncryptBlocksXTS (cipher, buffer, whiteningValue, countBlock);
 
-				whiteningValue[0] ^= finalCarry;
+				buffer += countBlock * BYTES_PER_XTS_BLOCK;
+				remainingBlocks -= countBlock;
+				startBlock = 0;
 			}
 
-			dataUnitBufPtr = bufPtr;
-			whiteningValuesPtr64 = (uint64 *) whiteningValues;
+			dataUnitNo += unitCount;
+		}
 
-			// Encrypt all blocks in this data unit
-#if (CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE && CRYPTOPP_BOOL_X64)
-			XorBlocks (bufPtr, whiteningValuesPtr64, countBlock, startBlock, endBlock);
-#else
-			for (block = 0; block < countBlock; block++)
-			{
-				// Pre-whitening
-				*bufPtr++ ^= *whiteningValuesPtr64++;
-				*bufPtr++ ^= *whiteningValuesPtr64++;
-			}
-#endif
-			// Actual encryption
-			cipher.EncryptBlocks ((byte *) dataUnitBufPtr, countBlock);
+		FAST_ERASE64 (whiteningValues, maxUnitCount * BYTES_PER_XTS_BLOCK);
+	}
 
-			bufPtr = dataUnitBufPtr;
-			whiteningValuesPtr64 = (uint64 *) whiteningValues;
+	// Passes each chunk of the buffer through all ciphers of the cascade while it is in the cache
+	template <class CipherType1, class CipherType2, class CipherType3>
+	void EncryptionModeXTS::EncryptCascade (byte *data, uint64 length, uint64 startDataUnitNo) const
+	{
+		while (length > 0)
+		{
+			uint64 chunkLength = min (length, (uint64) CascadeChunkSize);
 
-#if (CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE && CRYPTOPP_BOOL_X64)
-			XorBlocks (bufPtr, whiteningValuesPtr64, countBlock, startBlock, endBlock);
-#else
-			for (block = 0; block < countBlock; block++)
-			{
-				// Post-whitening
-				*bufPtr++ ^= *whiteningValuesPtr64++;
-				*bufPtr++ ^= *whiteningValuesPtr64++;
-			}
-#endif
-			remainingBlocks -= countBlock;
-			startBlock = 0;
-			dataUnitNo++;
-			*((uint64 *) byteBufUnitNo) = Endian::Little (dataUnitNo);
+			EncryptCascadeStage <CipherType1> (0, data, chunkLength, startDataUnitNo);
+			EncryptCascadeStage <CipherType2> (1, data, chunkLength, startDataUnitNo);
+			EncryptCascadeStage <CipherType3> (2, data, chunkLength, startDataUnitNo);
+
+			data += chunkLength;
+			length -= chunkLength;
+			startDataUnitNo += chunkLength / ENCRYPTION_DATA_UNIT_SIZE;
 		}
+	}
 
-		FAST_ERASE64 (whiteningValue, sizeof (whiteningValue));
-		FAST_ERASE64 (whiteningValues, sizeof (whiteningValues));
+	template <class CipherType>
+	void EncryptionModeXTS::EncryptCascadeStage (size_t cipherIndex, byte *data, uint64 length, uint64 startDataUnitNo) const
+	{
+		EncryptBufferXTS <CipherType> (*Ciphers[cipherIndex], *SecondaryCiphers[cipherIndex], data, length, startDataUnitNo, 0);
 	}
 
 	void EncryptionModeXTS::EncryptSectorsCurrentThread (byte *data, uint64 sectorIndex, uint64 sectorCount, size_t sectorSize) const
@@ -212,6 +254,26 @@ namespace VeraCrypt
 		EncryptBuffer (data, sectorCount * sectorSize, sectorIndex * sectorSize / ENCRYPTION_DATA_UNIT_SIZE);
 	}
 
+	void EncryptionModeXTS::EncryptSectorsCurrentThread (const byte *source, byte *destination, uint64 sectorIndex, uint64 sectorCount, size_t sectorSize) const
+	{
+		uint64 length = sectorCount * sectorSize;
+		uint64 dataUnitNo = sectorIndex * sectorSize / ENCRYPTION_DATA_UNIT_SIZE;
+
+		// Each chunk is encrypted in the destination right after it is copied, while it is in the cache
+		while (length > 0)
+		{
+			uint64 chunkLength = min (length, (uint64) CascadeChunkSize);
+
+			Memory::Copy (destination, source, (size_t) chunkLength);
+			EncryptBuffer (destination, chunkLength, dataUnitNo);
+
+			source += chunkLength;
+			destination += chunkLength;
+			length -= chunkLength;
+			dataUnitNo += chunkLength / ENCRYPTION_DATA_UNIT_SIZE;
+		}
+	}
+
 	size_t EncryptionModeXTS::GetKeySize () const
 	{
 		if (Ciphers.empty())
@@ -235,37 +297,36 @@ namespace VeraCrypt
 	{
 		if_debug (ValidateState());
 
+		if (DecryptCascadeFunction)
+		{
+			(this->*DecryptCascadeFunction) (data, length, startDataUnitNo);
+			return;
+		}
+
 		CipherList::const_iterator iSecondaryCipher = SecondaryCiphers.end();
 
 		for (CipherList::const_reverse_iterator iCipher = Ciphers.rbegin(); iCipher != Ciphers.rend(); ++iCipher)
 		{
 			--iSecondaryCipher;
-			DecryptBufferXTS (**iCipher, **iSecondaryCipher, data, length, startDataUnitNo, 0);
+			DecryptBufferXTS <Cipher> (**iCipher, **iSecondaryCipher, data, length, startDataUnitNo, 0);
 		}
 
 		assert (iSecondaryCipher == SecondaryCiphers.begin());
 	}
 
+	template <class CipherType>
 	void EncryptionModeXTS::DecryptBufferXTS (const Cipher &cipher, const Cipher &secondaryCipher, byte *buffer, uint64 length, uint64 startDataUnitNo, unsigned int startCipherBlockNo) const
 	{
-		byte finalCarry;
-		byte whiteningValues [ENCRYPTION_DATA_UNIT_SIZE];
-		byte whiteningValue [BYTES_PER_XTS_BLOCK];
-		byte byteBufUnitNo [BYTES_PER_XTS_BLOCK];
-		uint64 *whiteningValuesPtr64 = (uint64 *) whiteningValues;
-		uint64 *whiteningValuePtr64 = (uint64 *) whiteningValue;
-		uint64 *bufPtr = (uint64 *) buffer;
-		uint64 *dataUnitBufPtr;
-		unsigned int startBlock = startCipherBlockNo, endBlock, block, countBlock;
+		byte whiteningValues [TweakBatchSize * BYTES_PER_XTS_BLOCK];
+		byte skippedBlock [BYTES_PER_XTS_BLOCK] = { 0 };
+		uint64 *whiteningValuesPtr64;
+		unsigned int startBlock = startCipherBlockNo, block, countBlock;
+		size_t unit, unitCount, maxUnitCount = 0;
 		uint64 remainingBlocks, dataUnitNo;
 
 		startDataUnitNo += SectorOffset;
 
-		// Convert the 64-bit data unit number into a little-endian 16-byte array.
-		// Note that as we are converting a 64-bit number into a 16-byte array we can always zero the last 8 bytes.
 		dataUnitNo = startDataUnitNo;
-		*((uint64 *) byteBufUnitNo) = Endian::Little (dataUnitNo);
-		*((uint64 *) byteBufUnitNo + 1) = 0;
 
 		if (length % BYTES_PER_XTS_BLOCK)
 			TC_THROW_FATAL_EXCEPTION;
@@ -275,105 +336,70 @@ namespace VeraCrypt
 		// Process all blocks in the buffer
 		while (remainingBlocks > 0)
 		{
-			if (remainingBlocks < BLOCKS_PER_XTS_DATA_UNIT)
-				endBlock = startBlock + (unsigned int) remainingBlocks;
-			else
-				endBlock = BLOCKS_PER_XTS_DATA_UNIT;
-			countBlock = endBlock - startBlock;
+			unitCount = (size_t) min ((uint64) TweakBatchSize, (startBlock + remainingBlocks + BLOCKS_PER_XTS_DATA_UNIT - 1) / BLOCKS_PER_XTS_DATA_UNIT);
+			maxUnitCount = max (maxUnitCount, unitCount);
 
+			// Encrypt the data unit numbers of a batch of data units using the secondary key (in order to
+			// generate the first whitening value for each data unit). As each 64-bit data unit number is
+			// converted into a little-endian 16-byte array, the last 8 bytes are always zero.
 			whiteningValuesPtr64 = (uint64 *) whiteningValues;
-			whiteningValuePtr64 = (uint64 *) whiteningValue;
 
-			// Encrypt the data unit number using the secondary key (in order to generate the first
-			// whitening value for this data unit)
-			*whiteningValuePtr64 = *((uint64 *) byteBufUnitNo);
-			*(whiteningValuePtr64 + 1) = 0;
-			secondaryCipher.EncryptBlock (whiteningValue);
-
-			// Generate subsequent whitening values for blocks in this data unit. Note that all generated 128-bit
-			// whitening values are stored in memory as a sequence of 64-bit integers.
-			for (block = 0; block < endBlock; block++)
+			for (unit = 0; unit < unitCount; unit++)
 			{
-				if (block >= startBlock)
-				{
-					*whiteningValuesPtr64++ = *whiteningValuePtr64++;
-					*whiteningValuesPtr64++ = *whiteningValuePtr64;
-				}
-				else
-					whiteningValuePtr64++;
-
-				// Derive the next whitening value
-
-#if BYTE_ORDER == LITTLE_ENDIAN
-
-				// Little-endian platforms
-
-				finalCarry =
-					(*whiteningValuePtr64 & 0x8000000000000000ULL) ?
-					135 : 0;
-
-				*whiteningValuePtr64-- <<= 1;
-
-				if (*whiteningValuePtr64 & 0x8000000000000000ULL)
-					*(whiteningValuePtr64 + 1) |= 1;
-
-				*whiteningValuePtr64 <<= 1;
-
-#else
-				// Big-endian platforms
+				*whiteningValuesPtr64++ = Endian::Little (dataUnitNo + unit);
+				*whiteningValuesPtr64++ = 0;
+			}
 
-				finalCarry =
-					(*whiteningValuePtr64 & 0x80) ?
-					135 : 0;
+			XtsCascadeCipher <CipherType>::EncryptBlocks (secondaryCipher, whiteningValues, unitCount);
 
-				*whiteningValuePtr64 = Endian::Little (Endian::Little (*whiteningValuePtr64) << 1);
+			for (unit = 0; unit < unitCount; unit++)
+			{
+				byte *whiteningValue = whiteningValues + unit * BYTES_PER_XTS_BLOCK;
 
-				whiteningValuePtr64--;
+				if (remainingBlocks < BLOCKS_PER_XTS_DATA_UNIT - startBlock)
+					countBlock = (unsigned int) remainingBlocks;
+				else
+					countBlock = BLOCKS_PER_XTS_DATA_UNIT - startBlock;
 
-				if (*whiteningValuePtr64 & 0x80)
-					*(whiteningValuePtr64 + 1) |= 0x0100000000000000ULL;
+				for (block = 0; block < startBlock; block++)
+					xts_whiten_blocks (skippedBlock, skippedBlock, whiteningValue, 1);
 
-				*whiteningValuePtr64 = Endian::Little (Endian::Little (*whiteningValuePtr64) << 1);
-#endif
+				// Subsequent whitening values are derived by the cipher while it processes the blocks
+				// of this data unit, so that they are generated in the same pass as the decryption
+				XtsCascadeCipher <CipherType>::DecryptBlocksXTS (cipher, buffer, whiteningValue, countBlock);
 
-				whiteningValue[0] ^= finalCarry;
+				buffer += countBlock * BYTES_PER_XTS_BLOCK;
+				remainingBlocks -= countBlock;
+				startBlock = 0;
 			}
 
-			dataUnitBufPtr = bufPtr;
-			whiteningValuesPtr64 = (uint64 *) whiteningValues;
+			dataUnitNo += unitCount;
+		}
 
-			// Decrypt blocks in this data unit
-#if (CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE && CRYPTOPP_BOOL_X64)
-			XorBlocks (bufPtr, whiteningValuesPtr64, countBlock, startBlock, endBlock);
-#else
-			for (block = 0; block < countBlock; block++)
-			{
-				*bufPtr++ ^= *whiteningValuesPtr64++;
-				*bufPtr++ ^= *whiteningValuesPtr64++;
-			}
-#endif
-			cipher.DecryptBlocks ((byte *) dataUnitBufPtr, countBlock);
+		FAST_ERASE64 (whiteningValues, maxUnitCount * BYTES_PER_XTS_BLOCK);
+	}
 
-			bufPtr = dataUnitBufPtr;
-			whiteningValuesPtr64 = (uint64 *) whiteningValues;
-#if (CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE && CRYPTOPP_BOOL_X64)
-			XorBlocks (bufPtr, whiteningValuesPtr64, countBlock, startBlock, endBlock);
-#else
-			for (block = 0; block < countBlock; block++)
-			{
-				*bufPtr++ ^= *whiteningValuesPtr64++;
-				*bufPtr++ ^= *whiteningValuesPtr64++;
-			}
-#endif
-			remainingBlocks -= countBlock;
-			startBlock = 0;
-			dataUnitNo++;
+	template <class CipherType1, class CipherType2, class CipherType3>
+	void EncryptionModeXTS::DecryptCascade (byte *data, uint64 length, uint64 startDataUnitNo) const
+	{
+		while (length > 0)
+		{
+			uint64 chunkLength = min (length, (uint64) CascadeChunkSize);
+
+			DecryptCascadeStage <CipherType3> (2, data, chunkLength, startDataUnitNo);
+			DecryptCascadeStage <CipherType2> (1, data, chunkLength, startDataUnitNo);
+			DecryptCascadeStage <CipherType1> (0, data, chunkLength, startDataUnitNo);
 
-			*((uint64 *) byteBufUnitNo) = Endian::Little (dataUnitNo);
+			data += chunkLength;
+			length -= chunkLength;
+			startDataUnitNo += chunkLength / ENCRYPTION_DATA_UNIT_SIZE;
 		}
+	}
 
-		FAST_ERASE64 (whiteningValue, sizeof (whiteningValue));
-		FAST_ERASE64 (whiteningValues, sizeof (whiteningValues));
+	template <class CipherType>
+	void EncryptionModeXTS::DecryptCascadeStage (size_t cipherIndex, byte *data, uint64 length, uint64 startDataUnitNo) const
+	{
+		DecryptBufferXTS <CipherType> (*Ciphers[cipherIndex], *SecondaryCiphers[cipherIndex], data, length, startDataUnitNo, 0);
 	}
 
 	void EncryptionModeXTS::DecryptSectorsCurrentThread (byte *data, uint64 sectorIndex, uint64 sectorCount, size_t sectorSize) const
@@ -394,6 +420,44 @@ namespace VeraCrypt
 
 		if (SecondaryKey.Size() > 0)
 			SetSecondaryCipherKeys();
+
+		SelectCascadeFunctions();
+	}
+
+	template <class CipherType1, class CipherType2, class CipherType3>
+	void EncryptionModeXTS::SelectCascade ()
+	{
+		if (XtsCascadeCipher <CipherType1>::Matches (Ciphers, 0)
+			&& XtsCascadeCipher <CipherType2>::Matches (Ciphers, 1)
+			&& XtsCascadeCipher <CipherType3>::Matches (Ciphers, 2)
+			&& Ciphers.size() <= 3)
+		{
+			DecryptCascadeFunction = &EncryptionModeXTS::DecryptCascade <CipherType1, CipherType2, CipherType3>;
+			EncryptCascadeFunction = &EncryptionModeXTS::EncryptCascade <CipherType1, CipherType2, CipherType3>;
+		}
+	}
+
+	void EncryptionModeXTS::SelectCascadeFunctions ()
+	{
+		DecryptCascadeFunction = NULL;
+		EncryptCascadeFunction = NULL;
+
+		// Ciphers in the order in which the encryption algorithms apply them
+		SelectCascade <CipherAES, void, void> ();
+		SelectCascade <CipherSerpent, void, void> ();
+		SelectCascade <CipherTwofish, void, void> ();
+		SelectCascade <CipherCamellia, void, void> ();
+		SelectCascade <CipherKuznyechik, void, void> ();
+		SelectCascade <CipherTwofish, CipherAES, void> ();
+		SelectCascade <CipherSerpent, CipherTwofish, CipherAES> ();
+		SelectCascade <CipherAES, CipherSerpent, void> ();
+		SelectCascade <CipherSerpent, CipherTwofish, void> ();
+		SelectCascade <CipherAES, CipherTwofish, CipherSerpent> ();
+		SelectCascade <CipherTwofish, CipherKuznyechik, void> ();
+		SelectCascade <CipherAES, CipherKuznyechik, void> ();
+		SelectCascade <CipherCamellia, CipherSerpent, CipherKuznyechik> ();
+		SelectCascade <CipherKuznyechik, CipherCamellia, void> ();
+		SelectCascade <CipherSerpent, CipherCamellia, void> ();
 	}
 
 	void EncryptionModeXTS::SetKey (const ConstBufferPtr &key)
@@ -21,13 +21,14 @@ namespace VeraCrypt
 	class EncryptionModeXTS : public EncryptionMode
 	{
 	public:
-		EncryptionModeXTS () { }
+		EncryptionModeXTS () : DecryptCascadeFunction (NULL), EncryptCascadeFunction (NULL) { }
 		virtual ~EncryptionModeXTS () { }
 
 		virtual void Decrypt (byte *data, uint64 length) const;
 		virtual void DecryptSectorsCurrentThread (byte *data, uint64 sectorIndex, uint64 sectorCount, size_t sectorSize) const;
 		virtual void Encrypt (byte *data, uint64 length) const;
 		virtual void EncryptSectorsCurrentThread (byte *data, uint64 sectorIndex, uint64 sectorCount, size_t sectorSize) const;
+		virtual void EncryptSectorsCurrentThread (const byte *source, byte *destination, uint64 sectorIndex, uint64 sectorCount, size_t sectorSize) const;
 		virtual const SecureBuffer &GetKey () const { return SecondaryKey; }
 		virtual size_t GetKeySize () const;
 		virtual wstring GetName () const { return L"XTS"; };
@@ -36,12 +37,30 @@ namespace VeraCrypt
 		virtual void SetKey (const ConstBufferPtr &key);
 
 	protected:
+		typedef void (EncryptionModeXTS::*CascadeFunction) (byte *data, uint64 length, uint64 startDataUnitNo) const;
+
 		void DecryptBuffer (byte *data, uint64 length, uint64 startDataUnitNo) const;
-		void DecryptBufferXTS (const Cipher &cipher, const Cipher &secondaryCipher, byte *buffer, uint64 length, uint64 startDataUnitNo, unsigned int startCipherBlockNo) const;
+		template <class CipherType> void DecryptBufferXTS (const Cipher &cipher, const Cipher &secondaryCipher, byte *buffer, uint64 length, uint64 startDataUnitNo, unsigned int startCipherBlockNo) const;
+		template <class CipherType1, class CipherType2, class CipherType3> void DecryptCascade (byte *data, uint64 length, uint64 startDataUnitNo) const;
+		template <class CipherType> void DecryptCascadeStage (size_t cipherIndex, byte *data, uint64 length, uint64 startDataUnitNo) const;
 		void EncryptBuffer (byte *data, uint64 length, uint64 startDataUnitNo) const;
-		void EncryptBufferXTS (const Cipher &cipher, const Cipher &secondaryCipher, byte *buffer, uint64 length, uint64 startDataUnitNo, unsigned int startCipherBlockNo) const;
+		template <class CipherType> void EncryptBufferXTS (const Cipher &cipher, const Cipher &secondaryCipher, byte *buffer, uint64 length, uint64 startDataUnitNo, unsigned int startCipherBlockNo) const;
+		template <class CipherType1, class CipherType2, class CipherType3> void EncryptCascade (byte *data, uint64 length, uint64 startDataUnitNo) const;
+		template <class CipherType> void EncryptCascadeStage (size_t cipherIndex, byte *data, uint64 length, uint64 startDataUnitNo) const;
+		template <class CipherType1, class CipherType2, class CipherType3> void SelectCascade ();
+		void SelectCascadeFunctions ();
 		void SetSecondaryCipherKeys ();
 
+		// Number of data units whose initial whitening values are encrypted by a single call
+		static const size_t TweakBatchSize = 512;
+
+		// Number of bytes passed through all ciphers of a cascade before the next part of a buffer is processed
+		static const size_t CascadeChunkSize = 32 * 1024;
+
+		// Specialized implementations for the cipher types of a shipped cascade, or NULL
+		CascadeFunction DecryptCascadeFunction;
+		CascadeFunction EncryptCascadeFunction;
+
 		SecureBuffer SecondaryKey;
 		CipherList SecondaryCiphers;
 
@@ -166,6 +166,87 @@ namespace VeraCrypt
 		}
 	}
 
+	static void MultiplyXtsTweak (byte *tweak)
+	{
+		byte carry = tweak[15] >> 7;
+
+		for (int i = 15; i > 0; --i)
+			tweak[i] = (byte) ((tweak[i] << 1) | (tweak[i - 1] >> 7));
+
+		tweak[0] = (byte) ((tweak[0] << 1) ^ (carry ? 0x87 : 0));
+	}
+
+	// Checks the multi-block and XTS paths of a keyed cipher against its single-block transformation.
+	// Depending on the block count, the multi-block paths use SIMD kernels of different widths and their tails.
+	static void TestCipherBlocks (Cipher &cipher, size_t blockCount)
+	{
+		const size_t blockSize = cipher.GetBlockSize();
+
+		// One block past the end must not be modified
+		Buffer plaintext ((blockCount + 1) * blockSize);
+		for (size_t i = 0; i < plaintext.Size(); ++i)
+			plaintext[i] = (byte) (i * 13 + i / 256);
+
+		Buffer data (plaintext.Size());
+		Buffer expected (plaintext.Size());
+
+		memcpy (data, plaintext, plaintext.Size());
+		memcpy (expected, plaintext, plaintext.Size());
+
+		cipher.EncryptBlocks (data, blockCount);
+		for (size_t i = 0; i < blockCount; ++i)
+			cipher.EncryptBlock (expected.Ptr() + i * blockSize);
+
+		if (memcmp (data, expected, data.Size()) != 0)
+			throw TestFailed (SRC_POS);
+
+		cipher.DecryptBlocks (data, blockCount);
+		if (memcmp (data, plaintext, data.Size()) != 0)
+			throw TestFailed (SRC_POS);
+
+		byte tweak[16];
+		byte expectedTweak[16];
+
+		for (size_t i = 0; i < sizeof (tweak); ++i)
+			tweak[i] = expectedTweak[i] = (byte) (blockCount + i);
+
+		memcpy (expected, plaintext, plaintext.Size());
+		for (size_t i = 0; i < blockCount; ++i)
+		{
+			byte *block = expected.Ptr() + i * blockSize;
+
+			for (size_t j = 0; j < blockSize; ++j)
+				block[j] ^= expectedTweak[j];
+
+			cipher.EncryptBlock (block);
+
+			for (size_t j = 0; j < blockSize; ++j)
+				block[j] ^= expectedTweak[j];
+
+			MultiplyXtsTweak (expectedTweak);
+		}
+
+		cipher.EncryptBlocksXTS (data, tweak, blockCount);
+		if (memcmp (data, expected, data.Size()) != 0 || memcmp (tweak, expectedTweak, sizeof (tweak)) != 0)
+			throw TestFailed (SRC_POS);
+
+		for (size_t i = 0; i < sizeof (tweak); ++i)
+			tweak[i] = (byte) (blockCount + i);
+
+		cipher.DecryptBlocksXTS (data, tweak, blockCount);
+		if (memcmp (data, plaintext, data.Size()) != 0)
+			throw TestFailed (SRC_POS);
+	}
+
+	static void TestCipherBlocks (Cipher &cipher)
+	{
+		for (size_t blockCount = 1; blockCount <= 40; ++blockCount)
+			TestCipherBlocks (cipher, blockCount);
+
+		TestCipherBlocks (cipher, 255);
+		TestCipherBlocks (cipher, 257);
+	}
+
 	void EncryptionTest::TestCiphers ()
 	{
 			CipherAES aes;
@@ -190,17 +271,23 @@ namespace VeraCrypt
 			if (origCrc != Crc32::ProcessBuffer (testData))
 				throw TestFailed (SRC_POS);
 
+			TestCipherBlocks (aes);
+
 			CipherSerpent serpent;
 			TestCipher (serpent, SerpentTestVectors, array_capacity (SerpentTestVectors));
+			TestCipherBlocks (serpent);
 
 			CipherTwofish twofish;
 			TestCipher (twofish, TwofishTestVectors, array_capacity (TwofishTestVectors));
+			TestCipherBlocks (twofish);
 			
 			CipherCamellia camellia;
 			TestCipher (camellia, CamelliaTestVectors, array_capacity (CamelliaTestVectors));
+			TestCipherBlocks (camellia);
 			
 			CipherKuznyechik kuznyechik;
 			TestCipher (kuznyechik, KuznyechikTestVectors, array_capacity (KuznyechikTestVectors));
+			TestCipherBlocks (kuznyechik);
 	}
 
 	const EncryptionTest::XtsTestVector EncryptionTest::XtsTestVectors[] =
@@ -1074,6 +1161,99 @@ namespace VeraCrypt
 			throw TestFailed (SRC_POS);
 	}
 
+	// GOST R 34.11-2012 / RFC 6986, examples 1 and 2
+	static const byte StreebogTestMessage1[] = "012345678901234567890123456789012345678901234567890123456789012";
+
+	static const byte StreebogTestMessage2[] =
+	{
+		0xd1, 0xe5, 0x20, 0xe2, 0xe5, 0xf2, 0xf0, 0xe8, 0x2c, 0x20, 0xd1, 0xf2, 0xf0, 0xe8, 0xe1, 0xee,
+		0xe6, 0xe8, 0x20, 0xe2, 0xed, 0xf3, 0xf6, 0xe8, 0x2c, 0x20, 0xe2, 0xe5, 0xfe, 0xf2, 0xfa, 0x20,
+		0xf1, 0x20, 0xec, 0xee, 0xf0, 0xff, 0x20, 0xf1, 0xf2, 0xf0, 0xe5, 0xeb, 0xe0, 0xec, 0xe8, 0x20,
+		0xed, 0xe0, 0x20, 0xf5, 0xf0, 0xe0, 0xe1, 0xf0, 0xfb, 0xff, 0x20, 0xef, 0xeb, 0xfa, 0xea, 0xfb,
+		0x20, 0xc8, 0xe3, 0xee, 0xf0, 0xe5, 0xe2, 0xfb
+	};
+
+	static const byte StreebogTestDigest1[] =
+	{
+		0x1b, 0x54, 0xd0, 0x1a, 0x4a, 0xf5, 0xb9, 0xd5, 0xcc, 0x3d, 0x86, 0xd6, 0x8d, 0x28, 0x54, 0x62,
+		0xb1, 0x9a, 0xbc, 0x24, 0x75, 0x22, 0x2f, 0x35, 0xc0, 0x85, 0x12, 0x2b, 0xe4, 0xba, 0x1f, 0xfa,
+		0x00, 0xad, 0x30, 0xf8, 0x76, 0x7b, 0x3a, 0x82, 0x38, 0x4c, 0x65, 0x74, 0xf0, 0x24, 0xc3, 0x11,
+		0xe2, 0xa4, 0x81, 0x33, 0x2b, 0x08, 0xef, 0x7f, 0x41, 0x79, 0x78, 0x91, 0xc1, 0x64, 0x6f, 0x48
+	};
+
+	static const byte StreebogTestDigest2[] =
+	{
+		0x1e, 0x88, 0xe6, 0x22, 0x26, 0xbf, 0xca, 0x6f, 0x99, 0x94, 0xf1, 0xf2, 0xd5, 0x15, 0x69, 0xe0,
+		0xda, 0xf8, 0x47, 0x5a, 0x3b, 0x0f, 0xe6, 0x1a, 0x53, 0x00, 0xee, 0xe4, 0x6d, 0x96, 0x13, 0x76,
+		0x03, 0x5f, 0xe8, 0x35, 0x49, 0xad, 0xa2, 0xb8, 0x62, 0x0f, 0xcd, 0x7c, 0x49, 0x6c, 0xe5, 0xb3,
+		0x3f, 0x0c, 0xb9, 0xdd, 0xdc, 0x2b, 0x64, 0x60, 0x14, 0x3b, 0x03, 0xda, 0xba, 0xc9, 0xfb, 0x28
+	};
+
+	struct Pkcs5TestVector
+	{
+		const char *Password;
+		const char *Salt;
+		int IterationCount;
+		size_t DerivedKeySize;
+		byte DerivedKey[100];
+	};
+
+	// R 50.1.111-2016, PBKDF2-HMAC-Streebog-512
+	static const Pkcs5TestVector Pkcs5HmacStreebogTestVectors[] =
+	{
+		{
+			"password",
+			"salt",
+			1,
+			64,
+			{
+				0x64, 0x77, 0x0a, 0xf7, 0xf7, 0x48, 0xc3, 0xb1, 0xc9, 0xac, 0x83, 0x1d, 0xbc, 0xfd, 0x85, 0xc2,
+				0x61, 0x11, 0xb3, 0x0a, 0x8a, 0x65, 0x7d, 0xdc, 0x30, 0x56, 0xb8, 0x0c, 0xa7, 0x3e, 0x04, 0x0d,
+				0x28, 0x54, 0xfd, 0x36, 0x81, 0x1f, 0x6d, 0x82, 0x5c, 0xc4, 0xab, 0x66, 0xec, 0x0a, 0x68, 0xa4,
+				0x90, 0xa9, 0xe5, 0xcf, 0x51, 0x56, 0xb3, 0xa2, 0xb7, 0xee, 0xcd, 0xdb, 0xf9, 0xa1, 0x6b, 0x47
+			}
+		},
+		{
+			"password",
+			"salt",
+			2,
+			64,
+			{
+				0x5a, 0x58, 0x5b, 0xaf, 0xdf, 0xbb, 0x6e, 0x88, 0x30, 0xd6, 0xd6, 0x8a, 0xa3, 0xb4, 0x3a, 0xc0,
+				0x0d, 0x2e, 0x4a, 0xeb, 0xce, 0x01, 0xc9, 0xb3, 0x1c, 0x2c, 0xae, 0xd5, 0x6f, 0x02, 0x36, 0xd4,
+				0xd3, 0x4b, 0x2b, 0x8f, 0xbd, 0x2c, 0x4e, 0x89, 0xd5, 0x4d, 0x46, 0xf5, 0x0e, 0x47, 0xd4, 0x5b,
+				0xba, 0xc3, 0x01, 0x57, 0x17, 0x43, 0x11, 0x9e, 0x8d, 0x3c, 0x42, 0xba, 0x66, 0xd3, 0x48, 0xde
+			}
+		},
+		{
+			"password",
+			"salt",
+			4096,
+			64,
+			{
+				0xe5, 0x2d, 0xeb, 0x9a, 0x2d, 0x2a, 0xaf, 0xf4, 0xe2, 0xac, 0x9d, 0x47, 0xa4, 0x1f, 0x34, 0xc2,
+				0x03, 0x76, 0x59, 0x1c, 0x67, 0x80, 0x7f, 0x04, 0x77, 0xe3, 0x25, 0x49, 0xdc, 0x34, 0x1b, 0xc7,
+				0x86, 0x7c, 0x09, 0x84, 0x1b, 0x6d, 0x58, 0xe2, 0x9d, 0x03, 0x47, 0xc9, 0x96, 0x30, 0x1d, 0x55,
+				0xdf, 0x0d, 0x34, 0xe4, 0x7c, 0xf6, 0x8f, 0x4e, 0x3c, 0x2c, 0xda, 0xf1, 0xd9, 0xab, 0x86, 0xc3
+			}
+		},
+		{
+			"passwordPASSWORDpassword",
+			"saltSALTsaltSALTsaltSALTsaltSALTsalt",
+			4096,
+			100,
+			{
+				0xb2, 0xd8, 0xf1, 0x24, 0x5f, 0xc4, 0xd2, 0x92, 0x74, 0x80, 0x20, 0x57, 0xe4, 0xb5, 0x4e, 0x0a,
+				0x07, 0x53, 0xaa, 0x22, 0xfc, 0x53, 0x76, 0x0b, 0x30, 0x1c, 0xf0, 0x08, 0x67, 0x9e, 0x58, 0xfe,
+				0x4b, 0xee, 0x9a, 0xdd, 0xca, 0xe9, 0x9b, 0xa2, 0xb0, 0xb2, 0x0f, 0x43, 0x1a, 0x9c, 0x5e, 0x50,
+				0xf3, 0x95, 0xc8, 0x93, 0x87, 0xd0, 0x94, 0x5a, 0xed, 0xec, 0xa6, 0xeb, 0x40, 0x15, 0xdf, 0xc2,
+				0xbd, 0x24, 0x21, 0xee, 0x9b, 0xb7, 0x11, 0x83, 0xba, 0x88, 0x2c, 0xee, 0xbf, 0xef, 0x25, 0x9f,
+				0x33, 0xf9, 0xe2, 0x7d, 0xc6, 0x17, 0x8c, 0xb8, 0x9d, 0xc3, 0x74, 0x28, 0xcf, 0x9c, 0xc5, 0x2a,
+				0x2b, 0xaa, 0x2d, 0x3a
+			}
+		}
+	};
+
 	void EncryptionTest::TestPkcs5 ()
 	{
 		VolumePassword password ((byte*) "password", 8);
@@ -1105,5 +1285,30 @@ namespace VeraCrypt
 		pkcs5HmacStreebog.DeriveKey (derivedKey, password, salt, 5);
 		if (memcmp (derivedKey.Ptr(), "\xd0\x53\xa2\x30", 4) != 0)
 			throw TestFailed (SRC_POS);
+
+		Streebog streebog;
+		Buffer digest (streebog.GetDigestSize());
+
+		streebog.ProcessData (ConstBufferPtr (StreebogTestMessage1, sizeof (StreebogTestMessage1) - 1));
+		streebog.GetDigest (digest);
+		if (memcmp (digest.Ptr(), StreebogTestDigest1, sizeof (StreebogTestDigest1)) != 0)
+			throw TestFailed (SRC_POS);
+
+		streebog.Init();
+		streebog.ProcessData (ConstBufferPtr (StreebogTestMessage2, sizeof (StreebogTestMessage2)));
+		streebog.GetDigest (digest);
+		if (memcmp (digest.Ptr(), StreebogTestDigest2, sizeof (StreebogTestDigest2)) != 0)
+			throw TestFailed (SRC_POS);
+
+		for (size_t i = 0; i < array_capacity (Pkcs5HmacStreebogTestVectors); ++i)
+		{
+			const Pkcs5TestVector &testVector = Pkcs5HmacStreebogTestVectors[i];
+			VolumePassword testPassword ((const byte *) testVector.Password, strlen (testVector.Password));
+			Buffer testKey (testVector.DerivedKeySize);
+
+			pkcs5HmacStreebog.DeriveKey (testKey, testPassword, ConstBufferPtr ((const byte *) testVector.Salt, strlen (testVector.Salt)), testVector.IterationCount);
+			if (memcmp (testKey.Ptr(), testVector.DerivedKey, testKey.Size()) != 0)
+				throw TestFailed (SRC_POS);
+		}
 	}
 }
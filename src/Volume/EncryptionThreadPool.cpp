@@ -14,133 +14,431 @@
 #	include <unistd.h>
 #endif
 
+#ifdef TC_LINUX
+#	include <pthread.h>
+#	include <sched.h>
+#endif
+
 #ifdef TC_MACOSX
 #	include <sys/types.h>
 #	include <sys/sysctl.h>
 #endif
 
+#include <algorithm>
 #include "Platform/SyncEvent.h"
+#include "Platform/SystemException.h"
 #include "Platform/SystemLog.h"
+#include "Platform/TextReader.h"
+#include "Platform/Time.h"
 #include "Common/Crypto.h"
+#include "EncryptionAlgorithm.h"
+#include "EncryptionModeXTS.h"
 #include "EncryptionThreadPool.h"
 
 namespace VeraCrypt
 {
-	void EncryptionThreadPool::DoWork (WorkType::Enum type, const EncryptionMode *encryptionMode, byte *data, uint64 startUnitNo, uint64 unitCount, size_t sectorSize)
+	EncryptionThreadPool::EncryptionThreadPool ()
+		: ClientQueuesVersion (1), IdleThreadCount (0), QueuedItemCount (0), StopPending (false), ThreadCount (0), ThreadsPinned (false), ThreadsRunning (false), VirtualTime (0)
 	{
-		size_t fragmentCount;
-		size_t unitsPerFragment;
-		size_t remainder;
+		DefaultClient.reset (new Client (*this, ClientWeight::Interactive));
+	}
 
-		byte *fragmentData;
-		uint64 fragmentStartUnitNo;
+	EncryptionThreadPool::~EncryptionThreadPool ()
+	{
+		try
+		{
+			StopThreads();
+		}
+		catch (...) { }
 
-		WorkItem *workItem;
-		WorkItem *firstFragmentWorkItem;
+		DefaultClient.reset();
+	}
 
-		if (unitCount == 0)
-			return;
+	EncryptionThreadPool::Client::Client (EncryptionThreadPool &pool, uint32 weight)
+		: Pool (pool), Queue (new ClientQueue (weight, max (MinQueueSize, GetCpuCount() * 2)))
+	{
+		ScopeLock lock (Pool.ClientQueuesMutex);
+		Pool.ClientQueues.push_back (Queue);
+		++Pool.ClientQueuesVersion;
+	}
+
+	EncryptionThreadPool::Client::~Client ()
+	{
+		// Queued work refers to completions whose owners wait for it, so the
+		// queue is empty once the last submission has returned
+		ScopeLock lock (Pool.ClientQueuesMutex);
+
+		ClientQueueList::iterator i = find (Pool.ClientQueues.begin(), Pool.ClientQueues.end(), Queue);
+		if (i != Pool.ClientQueues.end())
+			Pool.ClientQueues.erase (i);
+
+		++Pool.ClientQueuesVersion;
+	}
+
+	void EncryptionThreadPool::Client::BeginKeyDerivation (shared_ptr <KeyDerivationTask> task)
+	{
+		if (!Pool.ThreadsRunning)
+			throw NotInitialized (SRC_POS);
 
-		if (!ThreadPoolRunning || unitCount == 1)
+		WorkItem workItem;
+		workItem.Type = WorkType::DeriveKey;
+		workItem.Completion = nullptr;
+		workItem.KeyDerivation = task;
+
+		Enqueue (workItem);
+		Pool.SignalWorkItemReady();
+	}
+
+	shared_ptr <EncryptionThreadPool::WorkItemCompletion> EncryptionThreadPool::Client::BeginWork (WorkType::Enum type, const EncryptionMode *encryptionMode, const byte *source, byte *data, uint64 startUnitNo, uint64 unitCount, size_t sectorSize)
+	{
+		uint64 fragmentCount = GetFragmentCount (encryptionMode, unitCount, sectorSize);
+
+		if (fragmentCount == 0)
 		{
-			switch (type)
-			{
-			case WorkType::DecryptDataUnits:
-				encryptionMode->DecryptSectorsCurrentThread (data, startUnitNo, unitCount, sectorSize);
-				break;
+			// Not worth dispatching
+			if (unitCount > 0)
+				ProcessDataUnits (type, encryptionMode, source, data, startUnitNo, unitCount, sectorSize);
 
-			case WorkType::EncryptDataUnits:
-				encryptionMode->EncryptSectorsCurrentThread (data, startUnitNo, unitCount, sectorSize);
-				break;
+			return shared_ptr <WorkItemCompletion> (new WorkItemCompletion (0));
+		}
 
-			default:
-				throw ParameterIncorrect (SRC_POS);
-			}
+		shared_ptr <WorkItemCompletion> completion (new WorkItemCompletion ((size_t) fragmentCount));
+		QueueFragments (*completion, type, encryptionMode, source, data, startUnitNo, unitCount, sectorSize, (size_t) fragmentCount, (size_t) fragmentCount);
+
+		return completion;
+	}
 
+	void EncryptionThreadPool::Client::DoWork (WorkType::Enum type, const EncryptionMode *encryptionMode, const byte *source, byte *data, uint64 startUnitNo, uint64 unitCount, size_t sectorSize)
+	{
+		if (unitCount == 0)
 			return;
-		}
 
-		if (unitCount <= ThreadCount)
+		uint64 fragmentCount = GetFragmentCount (encryptionMode, unitCount, sectorSize);
+
+		if (fragmentCount < 2)
 		{
-			fragmentCount = (size_t) unitCount;
-			unitsPerFragment = 1;
-			remainder = 0;
+			ProcessDataUnits (type, encryptionMode, source, data, startUnitNo, unitCount, sectorSize);
+			return;
 		}
-		else
+
+		DoWorkFragmented (type, encryptionMode, source, data, startUnitNo, unitCount, sectorSize, (size_t) fragmentCount);
+	}
+
+	void EncryptionThreadPool::Client::DoWorkFragmented (WorkType::Enum type, const EncryptionMode *encryptionMode, const byte *source, byte *data, uint64 startUnitNo, uint64 unitCount, size_t sectorSize, size_t fragmentCount)
+	{
+		// The last fragment is processed by the calling thread
+		WorkItemCompletion completion (fragmentCount - 1);
+		QueueFragments (completion, type, encryptionMode, source, data, startUnitNo, unitCount, sectorSize, fragmentCount, fragmentCount - 1);
+
+		uint64 lastFragmentUnitCount = unitCount / fragmentCount;
+		uint64 lastFragmentUnitOffset = unitCount - lastFragmentUnitCount;
+
+		ProcessDataUnits (type, encryptionMode, source + lastFragmentUnitOffset * sectorSize, data + lastFragmentUnitOffset * sectorSize, startUnitNo + lastFragmentUnitOffset, lastFragmentUnitCount, sectorSize);
+
+		completion.Wait();
+	}
+
+	void EncryptionThreadPool::Client::Enqueue (WorkItem &workItem)
+	{
+		ClientQueue &queue = *Queue;
+
+		// A client resuming after an idle period competes from the current virtual
+		// time instead of claiming the share it did not use
+		if (queue.IsEmpty())
 		{
-			fragmentCount = ThreadCount;
-			unitsPerFragment = (size_t) unitCount / ThreadCount;
-			remainder = (size_t) unitCount % ThreadCount;
+			uint64 poolTime = Pool.VirtualTime;
+			uint64 queueTime = queue.VirtualTime;
 
-			if (remainder > 0)
-				++unitsPerFragment;
+			while (queueTime < poolTime && !queue.VirtualTime.compare_exchange_weak (queueTime, poolTime));
 		}
 
-		fragmentData = data;
-		fragmentStartUnitNo = startUnitNo;
+		WorkQueueSlot *slot;
+		size_t position = queue.EnqueuePosition.load (memory_order_relaxed);
 
+		while (true)
 		{
-			ScopeLock lock (EnqueueMutex);
-			firstFragmentWorkItem = &WorkItemQueue[EnqueuePosition];
+			slot = &queue.Slots[position % queue.QueueSize];
+			size_t sequence = slot->Sequence.load (memory_order_acquire);
 
-			while (firstFragmentWorkItem->State != WorkItem::State::Free)
+			if (sequence == position)
 			{
-				WorkItemCompletedEvent.Wait();
+				if (queue.EnqueuePosition.compare_exchange_weak (position, position + 1, memory_order_relaxed))
+					break;
 			}
+			else if ((ptrdiff_t) (sequence - position) < 0)
+			{
+				// Queue full: wait until a worker releases a slot
+				++queue.SlotWaiterCount;
 
-			firstFragmentWorkItem->OutstandingFragmentCount.Set (fragmentCount);
-			firstFragmentWorkItem->ItemException.reset();
+				if (slot->Sequence.load() == sequence)
+					queue.SlotFreedEvent.Wait();
 
-			while (fragmentCount-- > 0)
+				--queue.SlotWaiterCount;
+				position = queue.EnqueuePosition.load (memory_order_relaxed);
+			}
+			else
 			{
-				workItem = &WorkItemQueue[EnqueuePosition++];
+				position = queue.EnqueuePosition.load (memory_order_relaxed);
+			}
+		}
 
-				if (EnqueuePosition >= QueueSize)
-					EnqueuePosition = 0;
+		slot->Item.Completion = workItem.Completion;
+		slot->Item.Type = workItem.Type;
+		slot->Item.KeyDerivation = workItem.KeyDerivation;
+		slot->Item.Encryption = workItem.Encryption;
 
-				while (workItem->State != WorkItem::State::Free)
-				{
-					WorkItemCompletedEvent.Wait();
-				}
+		++Pool.QueuedItemCount;
+
+		slot->Sequence.store (position + 1, memory_order_release);
+		atomic_thread_fence (memory_order_seq_cst);
 
-				workItem->Type = type;
-				workItem->FirstFragment = firstFragmentWorkItem;
+		if (queue.SlotWaiterCount > 0)
+			queue.SlotFreedEvent.Signal();
+	}
+
+	uint64 EncryptionThreadPool::Client::GetFragmentCount (const EncryptionMode *encryptionMode, uint64 unitCount, size_t sectorSize) const
+	{
+		if (!Pool.ThreadsRunning || unitCount == 0)
+			return 0;
+
+		// Fan out only as far as each fragment outweighs the cost of dispatching it
+		uint64 fragmentCount = unitCount * sectorSize / encryptionMode->GetMinFragmentSize();
+		fragmentCount = min (fragmentCount, (uint64) Pool.ThreadCount);
+
+		// Bulk work is split finely enough for interactive work to overtake it soon
+		if (fragmentCount > 0 && Queue->Weight < ClientWeight::Interactive)
+			fragmentCount = max (fragmentCount, unitCount * sectorSize / MaxBulkFragmentSize);
+
+		fragmentCount = min (fragmentCount, unitCount);
+
+		return fragmentCount;
+	}
+
+	void EncryptionThreadPool::Client::QueueFragments (WorkItemCompletion &completion, WorkType::Enum type, const EncryptionMode *encryptionMode, const byte *source, byte *data, uint64 startUnitNo, uint64 unitCount, size_t sectorSize, size_t fragmentCount, size_t queuedFragmentCount)
+	{
+		size_t unitsPerFragment = (size_t) (unitCount / fragmentCount);
+		size_t remainder = (size_t) (unitCount % fragmentCount);
+
+		if (remainder > 0)
+			++unitsPerFragment;
+
+		WorkItem workItem;
+		workItem.Type = type;
+		workItem.Completion = &completion;
+		workItem.Encryption.Mode = encryptionMode;
+		workItem.Encryption.SectorSize = sectorSize;
+		workItem.Encryption.Source = source;
+		workItem.Encryption.Data = data;
+		workItem.Encryption.StartUnitNo = startUnitNo;
+
+		while (queuedFragmentCount-- > 0)
+		{
+			workItem.Encryption.UnitCount = unitsPerFragment;
+
+			Enqueue (workItem);
+			Pool.SignalWorkItemReady();
 
-				workItem->Encryption.Mode = encryptionMode;
-				workItem->Encryption.Data = fragmentData;
-				workItem->Encryption.UnitCount = unitsPerFragment;
-				workItem->Encryption.StartUnitNo = fragmentStartUnitNo;
-				workItem->Encryption.SectorSize = sectorSize;
+			workItem.Encryption.Source += unitsPerFragment * sectorSize;
+			workItem.Encryption.Data += unitsPerFragment * sectorSize;
+			workItem.Encryption.StartUnitNo += unitsPerFragment;
+
+			if (remainder > 0 && --remainder == 0)
+				--unitsPerFragment;
+		}
+	}
+
+	EncryptionThreadPool::ClientQueue::ClientQueue (uint32 weight, size_t queueSize)
+		: DequeuePosition (0), EnqueuePosition (0), QueueSize (queueSize), SlotWaiterCount (0), Slots (new WorkQueueSlot[queueSize]), VirtualTime (0), Weight (weight)
+	{
+		for (size_t i = 0; i < QueueSize; ++i)
+		{
+			Slots[i].Sequence = i;
+		}
+	}
 
-				fragmentData += unitsPerFragment * sectorSize;
-				fragmentStartUnitNo += unitsPerFragment;
+	bool EncryptionThreadPool::ClientQueue::TryDequeue (WorkItem &workItem)
+	{
+		WorkQueueSlot *slot;
+		size_t position = DequeuePosition.load (memory_order_relaxed);
 
-				if (remainder > 0 && --remainder == 0)
-					--unitsPerFragment;
+		while (true)
+		{
+			slot = &Slots[position % QueueSize];
+			size_t sequence = slot->Sequence.load (memory_order_acquire);
 
-				workItem->State.Set (WorkItem::State::Ready);
-				WorkItemReadyEvent.Signal();
+			if (sequence == position + 1)
+			{
+				if (DequeuePosition.compare_exchange_weak (position, position + 1, memory_order_relaxed))
+					break;
+			}
+			else if ((ptrdiff_t) (sequence - (position + 1)) < 0)
+			{
+				return false;
+			}
+			else
+			{
+				position = DequeuePosition.load (memory_order_relaxed);
 			}
 		}
 
-		firstFragmentWorkItem->ItemCompletedEvent.Wait();
+		workItem.Completion = slot->Item.Completion;
+		workItem.Type = slot->Item.Type;
+		workItem.KeyDerivation.swap (slot->Item.KeyDerivation);
+		workItem.Encryption = slot->Item.Encryption;
 
-		unique_ptr <Exception> itemException;
-		if (firstFragmentWorkItem->ItemException.get())
-			itemException = move_ptr(firstFragmentWorkItem->ItemException);
+		slot->Sequence.store (position + QueueSize, memory_order_release);
+		atomic_thread_fence (memory_order_seq_cst);
 
-		firstFragmentWorkItem->State.Set (WorkItem::State::Free);
-		WorkItemCompletedEvent.Signal();
+		if (SlotWaiterCount > 0)
+			SlotFreedEvent.Signal();
 
-		if (itemException.get())
-			itemException->Throw();
+		return true;
 	}
 
-	void EncryptionThreadPool::Start ()
+	void EncryptionThreadPool::Calibrate (Client &client)
 	{
-		if (ThreadPoolRunning)
+		const uint64 unitCount = CalibrationDataSize / ENCRYPTION_DATA_UNIT_SIZE;
+		SecureBuffer data (CalibrationDataSize);
+		data.Zero();
+
+		// Cost of encrypting the calibration data with each cipher cascade
+		map <wstring, uint64> cascadeTimes;
+		shared_ptr <EncryptionMode> dispatchMode;
+
+		foreach (shared_ptr <EncryptionAlgorithm> ea, EncryptionAlgorithm::GetAvailableAlgorithms())
+		{
+			SecureBuffer key (ea->GetKeySize());
+			key.Zero();
+			ea->SetKey (key);
+
+			shared_ptr <EncryptionMode> xts (new EncryptionModeXTS);
+			xts->SetKey (key);
+			ea->SetMode (xts);
+
+			uint64 bestTime = 0;
+			for (int i = 0; i < 3; ++i)
+			{
+				uint64 startTime = Time::GetMonotonic();
+				xts->EncryptSectorsCurrentThread (data, 0, unitCount, ENCRYPTION_DATA_UNIT_SIZE);
+				uint64 time = Time::GetMonotonic() - startTime;
+
+				if (i == 0 || time < bestTime)
+					bestTime = time;
+			}
+
+			cascadeTimes[GetCipherChainName (ea->GetCiphers())] = max (bestTime, (uint64) 1);
+
+			if (!dispatchMode)
+				dispatchMode = xts;
+		}
+
+		if (!dispatchMode)
 			return;
 
+		// Cost of handing one data unit to a worker thread and waiting for its completion
+		vector <uint64> dispatchTimes;
+		for (size_t i = 0; i < CalibrationPassCount; ++i)
+		{
+			uint64 startTime = Time::GetMonotonic();
+			client.DoWorkFragmented (WorkType::EncryptDataUnits, dispatchMode.get(), data, data, 0, 2, ENCRYPTION_DATA_UNIT_SIZE, 2);
+			uint64 fragmentedTime = Time::GetMonotonic() - startTime;
+
+			startTime = Time::GetMonotonic();
+			dispatchMode->EncryptSectorsCurrentThread (data, 0, 1, ENCRYPTION_DATA_UNIT_SIZE);
+			uint64 inlineTime = Time::GetMonotonic() - startTime;
+
+			dispatchTimes.push_back (fragmentedTime > inlineTime ? fragmentedTime - inlineTime : 0);
+		}
+
+		sort (dispatchTimes.begin(), dispatchTimes.end());
+
+		ScopeLock lock (CalibrationMutex);
+		DispatchCost = dispatchTimes[dispatchTimes.size() / 2];
+
+		for (map <wstring, uint64>::const_iterator i = cascadeTimes.begin(); i != cascadeTimes.end(); ++i)
+		{
+			uint64 minFragmentSize = DispatchCost * FragmentCostFactor * CalibrationDataSize / i->second;
+			minFragmentSize = (minFragmentSize + ENCRYPTION_DATA_UNIT_SIZE - 1) / ENCRYPTION_DATA_UNIT_SIZE * ENCRYPTION_DATA_UNIT_SIZE;
+
+			MinFragmentSizes[i->first] = (size_t) max (minFragmentSize, (uint64) ENCRYPTION_DATA_UNIT_SIZE);
+		}
+
+		Calibrated = true;
+	}
+
+	shared_ptr <EncryptionThreadPool::Client> EncryptionThreadPool::CreateClient (uint32 weight)
+	{
+		if (weight == 0)
+			throw ParameterIncorrect (SRC_POS);
+
+		return shared_ptr <Client> (new Client (*this, weight));
+	}
+
+#ifdef TC_LINUX
+	size_t EncryptionThreadPool::GetCgroupCpuLimit ()
+	{
+		size_t cpuLimit = 0;
+
+		try
+		{
+			// Path of the process in the unified (v2) hierarchy
+			string cgroupPath;
+			string line;
+
+			TextReader cgroupReader (FilePath ("/proc/self/cgroup"));
+			while (cgroupReader.ReadLine (line))
+			{
+				if (line.find ("0::") == 0)
+				{
+					cgroupPath = line.substr (3);
+					break;
+				}
+			}
+
+			if (cgroupPath.empty() || cgroupPath[0] != '/')
+				return 0;
+
+			// Quotas of all ancestors apply as well
+			while (true)
+			{
+				try
+				{
+					TextReader cpuMaxReader (FilePath ("/sys/fs/cgroup" + (cgroupPath == "/" ? string() : cgroupPath) + "/cpu.max"));
+
+					vector <string> fields;
+					if (cpuMaxReader.ReadLine (line))
+						fields = StringConverter::Split (line);
+
+					if (fields.size() == 2 && fields[0] != "max")
+					{
+						uint64 quota = StringConverter::ToUInt64 (fields[0]);
+						uint64 period = StringConverter::ToUInt64 (fields[1]);
+
+						if (quota > 0 && period > 0)
+						{
+							size_t limit = (size_t) ((quota + period - 1) / period);
+							if (cpuLimit == 0 || limit < cpuLimit)
+								cpuLimit = limit;
+						}
+					}
+				}
+				catch (...) { }
+
+				if (cgroupPath == "/")
+					break;
+
+				size_t separator = cgroupPath.rfind ('/');
+				cgroupPath = separator == 0 ? string ("/") : cgroupPath.substr (0, separator);
+			}
+		}
+		catch (...) { }
+
+		return cpuLimit;
+	}
+#endif
+
+	size_t EncryptionThreadPool::DetectCpuCount ()
+	{
 		size_t cpuCount;
 
 #ifdef TC_WINDOWS
@@ -170,20 +468,181 @@ namespace VeraCrypt
 #	error Cannot determine CPU count
 #endif
 
-		if (cpuCount < 2)
+#ifdef TC_LINUX
+		// CPUs the process may run on
+		cpu_set_t cpuSet;
+		if (sched_getaffinity (0, sizeof (cpuSet), &cpuSet) == 0)
+		{
+			size_t affinityCount = (size_t) CPU_COUNT (&cpuSet);
+			if (affinityCount > 0 && affinityCount < cpuCount)
+				cpuCount = affinityCount;
+		}
+
+		// CPU bandwidth granted by the cgroup (e.g. a container CPU limit)
+		size_t cgroupLimit = GetCgroupCpuLimit();
+		if (cgroupLimit > 0 && cgroupLimit < cpuCount)
+			cpuCount = cgroupLimit;
+#endif
+
+		return cpuCount;
+	}
+
+	size_t EncryptionThreadPool::GetCpuCount ()
+	{
+		// Detected once, as the cgroup CPU limit is read from files each time and every client sizes its queue from it
+		static const size_t cpuCount = DetectCpuCount();
+		return cpuCount;
+	}
+
+	wstring EncryptionThreadPool::GetCipherChainName (const CipherList &ciphers)
+	{
+		wstring name;
+
+		foreach_reverse_ref (const Cipher &c, ciphers)
+		{
+			if (!name.empty())
+				name += L"-";
+			name += c.GetName();
+		}
+
+		return name;
+	}
+
+	size_t EncryptionThreadPool::GetMinFragmentSize (const CipherList &ciphers)
+	{
+		ScopeLock lock (CalibrationMutex);
+
+		FragmentSizeMap::const_iterator i = MinFragmentSizes.find (GetCipherChainName (ciphers));
+		if (i == MinFragmentSizes.end())
+			return ENCRYPTION_DATA_UNIT_SIZE;
+
+		return i->second;
+	}
+
+	EncryptionThreadPool::FragmentSizeMap EncryptionThreadPool::GetMinFragmentSizes ()
+	{
+		ScopeLock lock (CalibrationMutex);
+		return MinFragmentSizes;
+	}
+
+	EncryptionThreadPool &EncryptionThreadPool::GetDefault ()
+	{
+		static EncryptionThreadPool defaultPool;
+		return defaultPool;
+	}
+
+	shared_ptr <EncryptionThreadPool::KeyDerivationTask> EncryptionThreadPool::KeyDerivationCompletion::WaitForTask (list < shared_ptr <KeyDerivationTask> > &tasks)
+	{
+		while (!tasks.empty())
+		{
+			// Completed is set before the event is signaled; one signal may stand for several tasks
+			for (list < shared_ptr <KeyDerivationTask> >::iterator i = tasks.begin(); i != tasks.end(); ++i)
+			{
+				shared_ptr <KeyDerivationTask> task = *i;
+				if (!task->Completed)
+					continue;
+
+				tasks.erase (i);
+
+				if (task->TaskException.get())
+					task->TaskException->Throw();
+
+				return task;
+			}
+
+			CompletedEvent.Wait();
+		}
+
+		return shared_ptr <KeyDerivationTask> ();
+	}
+
+	void EncryptionThreadPool::KeyDerivationThreadProc (KeyDerivationTask &task)
+	{
+		// Derivations for PRFs that are no longer needed are skipped or stopped early
+		if (!task.Completion->Aborted)
+		{
+			try
+			{
+				task.Pkcs5->DeriveKey (task.DerivedKey, task.Password, task.Pim, task.Salt, &task.Completion->Aborted);
+			}
+			catch (Exception &e)
+			{
+				task.TaskException.reset (e.CloneNew());
+			}
+			catch (exception &e)
+			{
+				task.TaskException.reset (new ExternalException (SRC_POS, StringConverter::ToExceptionString (e)));
+			}
+			catch (...)
+			{
+				task.TaskException.reset (new UnknownException (SRC_POS));
+			}
+		}
+
+		task.Completed.Set (true);
+		task.Completion->CompletedEvent.Signal();
+	}
+
+	void EncryptionThreadPool::ProcessDataUnits (WorkType::Enum type, const EncryptionMode *encryptionMode, const byte *source, byte *data, uint64 startUnitNo, uint64 unitCount, size_t sectorSize)
+	{
+		switch (type)
+		{
+		case WorkType::DecryptDataUnits:
+			if (source != data)
+				throw ParameterIncorrect (SRC_POS);
+
+			encryptionMode->DecryptSectorsCurrentThread (data, startUnitNo, unitCount, sectorSize);
+			break;
+
+		case WorkType::EncryptDataUnits:
+			if (source != data)
+				encryptionMode->EncryptSectorsCurrentThread (source, data, startUnitNo, unitCount, sectorSize);
+			else
+				encryptionMode->EncryptSectorsCurrentThread (data, startUnitNo, unitCount, sectorSize);
+			break;
+
+		default:
+			throw ParameterIncorrect (SRC_POS);
+		}
+	}
+
+	void EncryptionThreadPool::SignalWorkItemReady ()
+	{
+		// Idle threads pass the wakeup on while work remains queued
+		if (IdleThreadCount > 0)
+			WorkItemReadyEvent.Signal();
+	}
+
+	void EncryptionThreadPool::StartThreads (size_t threadCount, bool pinThreads)
+	{
+		if (ThreadsRunning)
 			return;
 
-		if (cpuCount > MaxThreadCount)
-			cpuCount = MaxThreadCount;
+		size_t cpuCount = threadCount > 0 ? threadCount : GetCpuCount();
+
+		if (cpuCount < 2)
+			return;
 
 		StopPending = false;
-		DequeuePosition = 0;
-		EnqueuePosition = 0;
+		IdleThreadCount = 0;
 
-		for (size_t i = 0; i < sizeof (WorkItemQueue) / sizeof (WorkItemQueue[0]); ++i)
+		PinnedCpus.clear();
+		ThreadsPinned = pinThreads;
+
+#ifdef TC_LINUX
+		if (pinThreads)
 		{
-			WorkItemQueue[i].State.Set (WorkItem::State::Free);
+			cpu_set_t cpuSet;
+			if (sched_getaffinity (0, sizeof (cpuSet), &cpuSet) == 0)
+			{
+				for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+				{
+					if (CPU_ISSET (cpu, &cpuSet))
+						PinnedCpus.push_back (cpu);
+				}
+			}
 		}
+#endif
 
 		try
 		{
@@ -191,14 +650,21 @@ namespace VeraCrypt
 			{
 				struct ThreadFunctor : public Functor
 				{
+					ThreadFunctor (EncryptionThreadPool &pool, int cpu) : Cpu (cpu), Pool (pool) { }
+
 					virtual void operator() ()
 					{
-						WorkThreadProc();
+						Pool.WorkThreadProc (Cpu);
 					}
+
+					int Cpu;
+					EncryptionThreadPool &Pool;
 				};
 
+				int cpu = PinnedCpus.empty() ? -1 : PinnedCpus[ThreadCount % PinnedCpus.size()];
+
 				make_shared_auto (Thread, thread);
-				thread->Start (new ThreadFunctor ());
+				thread->Start (new ThreadFunctor (*this, cpu));
 				RunningThreads.push_back (thread);
 			}
 		}
@@ -206,19 +672,31 @@ namespace VeraCrypt
 		{
 			try
 			{
-				ThreadPoolRunning = true;
-				Stop();
+				ThreadsRunning = true;
+				StopThreads();
 			} catch (...) { }
 
 			throw;
 		}
 
-		ThreadPoolRunning = true;
+		ThreadsRunning = true;
+
+		if (!Calibrated)
+		{
+			try
+			{
+				Calibrate (*DefaultClient);
+			}
+			catch (exception &e)
+			{
+				SystemLog::WriteException (e);
+			}
+		}
 	}
 
-	void EncryptionThreadPool::Stop ()
+	void EncryptionThreadPool::StopThreads ()
 	{
-		if (!ThreadPoolRunning)
+		if (!ThreadsRunning)
 			return;
 
 		StopPending = true;
@@ -229,74 +707,159 @@ namespace VeraCrypt
 			thread.Join();
 		}
 
+		RunningThreads.clear();
 		ThreadCount = 0;
-		ThreadPoolRunning = false;
+		ThreadsRunning = false;
 	}
 
-	void EncryptionThreadPool::WorkThreadProc ()
+	bool EncryptionThreadPool::TryDequeue (ClientQueueList &queues, size_t &queueListVersion, WorkItem &workItem)
+	{
+		if (queueListVersion != ClientQueuesVersion)
+		{
+			ScopeLock lock (ClientQueuesMutex);
+			queues = ClientQueues;
+			queueListVersion = ClientQueuesVersion;
+		}
+
+		// Serve the client that has received the least service relative to its weight
+		ClientQueue *selectedQueue = nullptr;
+		uint64 selectedTime = 0;
+
+		foreach (shared_ptr <ClientQueue> queue, queues)
+		{
+			if (queue->IsEmpty())
+				continue;
+
+			uint64 queueTime = queue->VirtualTime;
+			if (!selectedQueue || queueTime < selectedTime)
+			{
+				selectedQueue = queue.get();
+				selectedTime = queueTime;
+			}
+		}
+
+		if (!selectedQueue)
+			return false;
+
+		if (!selectedQueue->TryDequeue (workItem))
+		{
+			// The selected item is not published yet or was taken by another thread
+			selectedQueue = nullptr;
+
+			foreach (shared_ptr <ClientQueue> queue, queues)
+			{
+				if (!queue->IsEmpty() && queue->TryDequeue (workItem))
+				{
+					selectedQueue = queue.get();
+					break;
+				}
+			}
+
+			if (!selectedQueue)
+				return false;
+		}
+
+		--QueuedItemCount;
+
+		uint64 cost = workItem.Type == WorkType::DeriveKey ? KeyDerivationCost : workItem.Encryption.UnitCount * workItem.Encryption.SectorSize;
+		uint64 startTime = selectedQueue->VirtualTime.fetch_add (max (cost / selectedQueue->Weight, (uint64) 1));
+
+		uint64 poolTime = VirtualTime;
+		while (poolTime < startTime && !VirtualTime.compare_exchange_weak (poolTime, startTime));
+
+		return true;
+	}
+
+	void EncryptionThreadPool::WorkItemCompletion::Wait ()
+	{
+		if (!WaitCompleted)
+		{
+			CompletedEvent.Wait();
+			WaitCompleted = true;
+		}
+
+		if (ItemException.get())
+			ItemException->Throw();
+	}
+
+	void EncryptionThreadPool::WorkThreadProc (int cpu)
 	{
 		try
 		{
-			WorkItem *workItem;
+#ifdef TC_LINUX
+			if (cpu >= 0)
+			{
+				cpu_set_t cpuSet;
+				CPU_ZERO (&cpuSet);
+				CPU_SET (cpu, &cpuSet);
+
+				int status = pthread_setaffinity_np (pthread_self(), sizeof (cpuSet), &cpuSet);
+				if (status != 0)
+					SystemLog::WriteException (SystemException (SRC_POS, (int64) status));
+			}
+#endif
+			WorkItem workItem;
+			ClientQueueList queues;
+			size_t queueListVersion = 0;
 
 			while (!StopPending)
 			{
-				{
-					ScopeLock lock (DequeueMutex);
+				bool dequeued = false;
 
-					workItem = &WorkItemQueue[DequeuePosition++];
+				for (size_t i = 0; i < SpinCount && !dequeued && !StopPending; ++i)
+					dequeued = TryDequeue (queues, queueListVersion, workItem);
 
-					if (DequeuePosition >= QueueSize)
-						DequeuePosition = 0;
+				if (!dequeued)
+				{
+					// Register as idle before the final check so that an enqueue either
+					// becomes visible here or sees this thread and signals it
+					++IdleThreadCount;
 
-					while (!StopPending && workItem->State != WorkItem::State::Ready)
-					{
+					while (!StopPending && !(dequeued = TryDequeue (queues, queueListVersion, workItem)))
 						WorkItemReadyEvent.Wait();
-					}
 
-					workItem->State.Set (WorkItem::State::Busy);
+					--IdleThreadCount;
 				}
 
-				if (StopPending)
+				if (!dequeued)
 					break;
 
-				try
+				if (IdleThreadCount > 0 && QueuedItemCount > 0)
+					WorkItemReadyEvent.Signal();
+
+				if (workItem.Type == WorkType::DeriveKey)
 				{
-					switch (workItem->Type)
-					{
-					case WorkType::DecryptDataUnits:
-						workItem->Encryption.Mode->DecryptSectorsCurrentThread (workItem->Encryption.Data, workItem->Encryption.StartUnitNo, workItem->Encryption.UnitCount, workItem->Encryption.SectorSize);
-						break;
+					shared_ptr <KeyDerivationTask> task;
+					task.swap (workItem.KeyDerivation);
 
-					case WorkType::EncryptDataUnits:
-						workItem->Encryption.Mode->EncryptSectorsCurrentThread (workItem->Encryption.Data, workItem->Encryption.StartUnitNo, workItem->Encryption.UnitCount, workItem->Encryption.SectorSize);
-						break;
+					KeyDerivationThreadProc (*task);
+					continue;
+				}
 
-					default:
-						throw ParameterIncorrect (SRC_POS);
-					}
+				WorkItemCompletion &completion = *workItem.Completion;
+
+				try
+				{
+					ProcessDataUnits (workItem.Type, workItem.Encryption.Mode, workItem.Encryption.Source, workItem.Encryption.Data, workItem.Encryption.StartUnitNo, workItem.Encryption.UnitCount, workItem.Encryption.SectorSize);
 				}
 				catch (Exception &e)
 				{
-					workItem->FirstFragment->ItemException.reset (e.CloneNew());
+					if (!completion.ExceptionSet.exchange (true))
+						completion.ItemException.reset (e.CloneNew());
 				}
 				catch (exception &e)
 				{
-					workItem->FirstFragment->ItemException.reset (new ExternalException (SRC_POS, StringConverter::ToExceptionString (e)));
+					if (!completion.ExceptionSet.exchange (true))
+						completion.ItemException.reset (new ExternalException (SRC_POS, StringConverter::ToExceptionString (e)));
 				}
 				catch (...)
 				{
-					workItem->FirstFragment->ItemException.reset (new UnknownException (SRC_POS));
-				}
-
-				if (workItem != workItem->FirstFragment)
-				{
-					workItem->State.Set (WorkItem::State::Free);
-					WorkItemCompletedEvent.Signal();
+					if (!completion.ExceptionSet.exchange (true))
+						completion.ItemException.reset (new UnknownException (SRC_POS));
 				}
 
-				if (workItem->FirstFragment->OutstandingFragmentCount.Decrement() == 0)
-					workItem->FirstFragment->ItemCompletedEvent.Signal();
+				if (completion.OutstandingFragmentCount.fetch_sub (1) == 1)
+					completion.CompletedEvent.Signal();
 			}
 		}
 		catch (exception &e)
@@ -307,23 +870,14 @@ namespace VeraCrypt
 		{
 			SystemLog::WriteException (UnknownException (SRC_POS));
 		}
-	}
-
-	volatile bool EncryptionThreadPool::ThreadPoolRunning = false;
-	volatile bool EncryptionThreadPool::StopPending = false;
-
-	size_t EncryptionThreadPool::ThreadCount;
-
-	EncryptionThreadPool::WorkItem EncryptionThreadPool::WorkItemQueue[QueueSize];
 
-	volatile size_t EncryptionThreadPool::EnqueuePosition;
-	volatile size_t EncryptionThreadPool::DequeuePosition;
-
-	Mutex EncryptionThreadPool::EnqueueMutex;
-	Mutex EncryptionThreadPool::DequeueMutex;
-
-	SyncEvent EncryptionThreadPool::WorkItemReadyEvent;
-	SyncEvent EncryptionThreadPool::WorkItemCompletedEvent;
+		// Pass the stop request on to the next idle thread
+		WorkItemReadyEvent.Signal();
+	}
 
-	list < shared_ptr <Thread> > EncryptionThreadPool::RunningThreads;
+	bool EncryptionThreadPool::Calibrated = false;
+	Mutex EncryptionThreadPool::CalibrationMutex;
+	thread_local EncryptionThreadPool::Client *EncryptionThreadPool::CurrentClient = nullptr;
+	uint64 EncryptionThreadPool::DispatchCost = 0;
+	EncryptionThreadPool::FragmentSizeMap EncryptionThreadPool::MinFragmentSizes;
 }
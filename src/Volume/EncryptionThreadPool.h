@@ -13,8 +13,11 @@
 #ifndef TC_HEADER_Volume_EncryptionThreadPool
 #define TC_HEADER_Volume_EncryptionThreadPool
 
+#include <atomic>
 #include "Platform/Platform.h"
 #include "EncryptionMode.h"
+#include "Pkcs5Kdf.h"
+#include "VolumePassword.h"
 
 namespace VeraCrypt
 {
@@ -31,30 +34,92 @@ namespace VeraCrypt
 			};
 		};
 
-		struct WorkItem
+		struct KeyDerivationTask;
+
+		struct KeyDerivationCompletion
+		{
+			KeyDerivationCompletion () : Aborted (0) { }
+
+			// Makes pending and running derivations of this completion stop early
+			void Abort () { Aborted = 1; }
+
+			// Waits until one of the tasks completes, removes it from the list and rethrows the
+			// exception it raised. Returns an empty pointer when no task is left.
+			shared_ptr <KeyDerivationTask> WaitForTask (list < shared_ptr <KeyDerivationTask> > &tasks);
+
+			long volatile Aborted;
+			SyncEvent CompletedEvent;
+
+		private:
+			KeyDerivationCompletion (const KeyDerivationCompletion &);
+			KeyDerivationCompletion &operator= (const KeyDerivationCompletion &);
+		};
+
+		struct KeyDerivationTask
+		{
+			KeyDerivationTask (shared_ptr <Pkcs5Kdf> pkcs5, const VolumePassword &password, int pim, const ConstBufferPtr &salt, size_t keySize, shared_ptr <KeyDerivationCompletion> completion)
+				: Completed (false), Completion (completion), DerivedKey (keySize), Password (password), Pim (pim), Pkcs5 (pkcs5), Salt (salt.Size())
+			{
+				Salt.CopyFrom (salt);
+			}
+
+			SharedVal <bool> Completed;
+			shared_ptr <KeyDerivationCompletion> Completion;
+			SecureBuffer DerivedKey;
+			unique_ptr <Exception> TaskException;
+			VolumePassword Password;
+			int Pim;
+			shared_ptr <Pkcs5Kdf> Pkcs5;
+			SecureBuffer Salt;
+
+		private:
+			KeyDerivationTask (const KeyDerivationTask &);
+			KeyDerivationTask &operator= (const KeyDerivationTask &);
+		};
+
+		// Completion state of data units submitted to the pool. Fragments refer to it
+		// until they are processed; the destructor therefore waits for them.
+		struct WorkItemCompletion
 		{
-			struct State
+			WorkItemCompletion (size_t fragmentCount) : ExceptionSet (false), OutstandingFragmentCount (fragmentCount), WaitCompleted (fragmentCount == 0) { }
+			~WorkItemCompletion ()
 			{
-				enum Enum
+				if (!WaitCompleted)
 				{
-					Free,
-					Ready,
-					Busy
-				};
-			};
+					try
+					{
+						CompletedEvent.Wait();
+					}
+					catch (...) { }
+				}
+			}
 
-			struct WorkItem *FirstFragment;
+			// Waits until all fragments are processed and rethrows the first exception they raised
+			void Wait ();
+
+			SyncEvent CompletedEvent;
+			atomic <bool> ExceptionSet;
 			unique_ptr <Exception> ItemException;
-			SyncEvent ItemCompletedEvent;
-			SharedVal <size_t> OutstandingFragmentCount;
-			SharedVal <State::Enum> State;
+			atomic <size_t> OutstandingFragmentCount;
+			bool WaitCompleted;
+
+		private:
+			WorkItemCompletion (const WorkItemCompletion &);
+			WorkItemCompletion &operator= (const WorkItemCompletion &);
+		};
+
+		struct WorkItem
+		{
+			WorkItemCompletion *Completion;
 			WorkType::Enum Type;
+			shared_ptr <KeyDerivationTask> KeyDerivation;
 
 			union
 			{
 				struct
 				{
 					const EncryptionMode *Mode;
+					const byte *Source; // Equals Data unless the data units are encrypted out of place
 					byte *Data;
 					uint64 StartUnitNo;
 					uint64 UnitCount;
@@ -63,28 +128,180 @@ namespace VeraCrypt
 			};
 		};
 
-		static void DoWork (WorkType::Enum type, const EncryptionMode *mode, byte *data, uint64 startUnitNo, uint64 unitCount, size_t sectorSize);
-		static bool IsRunning () { return ThreadPoolRunning; }
-		static void Start ();
-		static void Stop ();
+		typedef map <wstring, size_t> FragmentSizeMap;
+
+		// Scheduling weights of pool clients. Work queued by clients is served in
+		// proportion to their weights, so that interactive I/O overtakes bulk jobs.
+		struct ClientWeight
+		{
+			enum
+			{
+				Bulk = 1,
+				Interactive = 16
+			};
+		};
+
+	protected:
+		// Slot of the bounded multi-producer/multi-consumer work queue of a client.
+		// Sequence tells producers and consumers which lap of the ring the slot belongs to.
+		struct WorkQueueSlot
+		{
+			atomic <size_t> Sequence;
+			WorkItem Item;
+		};
+
+		struct ClientQueue
+		{
+			ClientQueue (uint32 weight, size_t queueSize);
+
+			bool IsEmpty () const { return DequeuePosition.load() == EnqueuePosition.load(); }
+			bool TryDequeue (WorkItem &workItem);
+
+			atomic <size_t> DequeuePosition;
+			atomic <size_t> EnqueuePosition;
+			size_t QueueSize;
+			SyncEvent SlotFreedEvent;
+			atomic <size_t> SlotWaiterCount;
+			unique_ptr <WorkQueueSlot[]> Slots;
+			atomic <uint64> VirtualTime;
+			uint32 Weight;
+
+		private:
+			ClientQueue (const ClientQueue &);
+			ClientQueue &operator= (const ClientQueue &);
+		};
+
+	public:
+		// Submission handle of a pool user. Each client has its own work queue;
+		// a client must not outlive its pool.
+		class Client
+		{
+		public:
+			virtual ~Client ();
+
+			void BeginKeyDerivation (shared_ptr <KeyDerivationTask> task);
+			shared_ptr <WorkItemCompletion> BeginWork (WorkType::Enum type, const EncryptionMode *mode, byte *data, uint64 startUnitNo, uint64 unitCount, size_t sectorSize) { return BeginWork (type, mode, data, data, startUnitNo, unitCount, sectorSize); }
+			shared_ptr <WorkItemCompletion> BeginWork (WorkType::Enum type, const EncryptionMode *mode, const byte *source, byte *data, uint64 startUnitNo, uint64 unitCount, size_t sectorSize);
+			void DoWork (WorkType::Enum type, const EncryptionMode *mode, byte *data, uint64 startUnitNo, uint64 unitCount, size_t sectorSize) { DoWork (type, mode, data, data, startUnitNo, unitCount, sectorSize); }
+			void DoWork (WorkType::Enum type, const EncryptionMode *mode, const byte *source, byte *data, uint64 startUnitNo, uint64 unitCount, size_t sectorSize);
+			EncryptionThreadPool &GetPool () const { return Pool; }
+			uint32 GetWeight () const { return Queue->Weight; }
+
+		protected:
+			friend class EncryptionThreadPool;
+
+			Client (EncryptionThreadPool &pool, uint32 weight);
+
+			void DoWorkFragmented (WorkType::Enum type, const EncryptionMode *mode, const byte *source, byte *data, uint64 startUnitNo, uint64 unitCount, size_t sectorSize, size_t fragmentCount);
+			void Enqueue (WorkItem &workItem);
+			uint64 GetFragmentCount (const EncryptionMode *mode, uint64 unitCount, size_t sectorSize) const;
+			void QueueFragments (WorkItemCompletion &completion, WorkType::Enum type, const EncryptionMode *mode, const byte *source, byte *data, uint64 startUnitNo, uint64 unitCount, size_t sectorSize, size_t fragmentCount, size_t queuedFragmentCount);
+
+			EncryptionThreadPool &Pool;
+			shared_ptr <ClientQueue> Queue;
+
+		private:
+			Client (const Client &);
+			Client &operator= (const Client &);
+		};
+
+		// Routes the static submission functions called by the current thread to a client
+		class ClientScope
+		{
+		public:
+			ClientScope (shared_ptr <Client> client) : PreviousClient (CurrentClient), ScopedClient (client) { CurrentClient = client.get(); }
+			~ClientScope () { CurrentClient = PreviousClient; }
+
+		protected:
+			Client *PreviousClient;
+			shared_ptr <Client> ScopedClient;
+
+		private:
+			ClientScope (const ClientScope &);
+			ClientScope &operator= (const ClientScope &);
+		};
+
+		EncryptionThreadPool ();
+		virtual ~EncryptionThreadPool ();
+
+		bool AreThreadsPinned () const { return ThreadsRunning && ThreadsPinned; }
+		shared_ptr <Client> CreateClient (uint32 weight);
+		Client &GetDefaultClient () const { return *DefaultClient; }
+		size_t GetRunningThreadCount () const { return ThreadsRunning ? ThreadCount : 0; }
+		void StartThreads (size_t threadCount = 0, bool pinThreads = false);
+		void StopThreads ();
+
+		// Static members operate on the current client of the calling thread, which is
+		// the default client of the default pool unless a ClientScope is active
+		static void BeginKeyDerivation (shared_ptr <KeyDerivationTask> task) { GetCurrentClient().BeginKeyDerivation (task); }
+		static shared_ptr <WorkItemCompletion> BeginWork (WorkType::Enum type, const EncryptionMode *mode, byte *data, uint64 startUnitNo, uint64 unitCount, size_t sectorSize) { return GetCurrentClient().BeginWork (type, mode, data, startUnitNo, unitCount, sectorSize); }
+		static shared_ptr <WorkItemCompletion> BeginWork (WorkType::Enum type, const EncryptionMode *mode, const byte *source, byte *data, uint64 startUnitNo, uint64 unitCount, size_t sectorSize) { return GetCurrentClient().BeginWork (type, mode, source, data, startUnitNo, unitCount, sectorSize); }
+		static void DoWork (WorkType::Enum type, const EncryptionMode *mode, byte *data, uint64 startUnitNo, uint64 unitCount, size_t sectorSize) { GetCurrentClient().DoWork (type, mode, data, startUnitNo, unitCount, sectorSize); }
+		static void DoWork (WorkType::Enum type, const EncryptionMode *mode, const byte *source, byte *data, uint64 startUnitNo, uint64 unitCount, size_t sectorSize) { GetCurrentClient().DoWork (type, mode, source, data, startUnitNo, unitCount, sectorSize); }
+		static size_t GetCpuCount ();
+		static Client &GetCurrentClient () { return CurrentClient ? *CurrentClient : GetDefault().GetDefaultClient(); }
+		static EncryptionThreadPool &GetDefault ();
+		static uint64 GetDispatchCost () { return DispatchCost; }
+		static size_t GetMinFragmentSize (const CipherList &ciphers);
+		static FragmentSizeMap GetMinFragmentSizes ();
+		static size_t GetThreadCount () { return GetCurrentClient().GetPool().GetRunningThreadCount(); }
+		static bool IsPinningThreads () { return GetCurrentClient().GetPool().AreThreadsPinned(); }
+		static bool IsRunning () { return GetThreadCount() > 0; }
+		static void Start (size_t threadCount = 0, bool pinThreads = false) { GetCurrentClient().GetPool().StartThreads (threadCount, pinThreads); }
+		static void Stop () { GetCurrentClient().GetPool().StopThreads(); }
 
 	protected:
-		static void WorkThreadProc ();
-
-		static const size_t MaxThreadCount = 32;
-		static const size_t QueueSize = MaxThreadCount * 2;
-
-		static Mutex DequeueMutex;
-		static volatile size_t DequeuePosition;
-		static volatile size_t EnqueuePosition;
-		static Mutex EnqueueMutex;
-		static list < shared_ptr <Thread> > RunningThreads;
-		static volatile bool StopPending;
-		static size_t ThreadCount;
-		static volatile bool ThreadPoolRunning;
-		static SyncEvent WorkItemCompletedEvent;
-		static WorkItem WorkItemQueue[QueueSize];
-		static SyncEvent WorkItemReadyEvent;
+		typedef vector < shared_ptr <ClientQueue> > ClientQueueList;
+
+		static void Calibrate (Client &client);
+		static size_t DetectCpuCount ();
+#ifdef TC_LINUX
+		static size_t GetCgroupCpuLimit ();
+#endif
+		static wstring GetCipherChainName (const CipherList &ciphers);
+		static void KeyDerivationThreadProc (KeyDerivationTask &task);
+		static void ProcessDataUnits (WorkType::Enum type, const EncryptionMode *mode, const byte *source, byte *data, uint64 startUnitNo, uint64 unitCount, size_t sectorSize);
+		void SignalWorkItemReady ();
+		bool TryDequeue (ClientQueueList &queues, size_t &queueListVersion, WorkItem &workItem);
+		void WorkThreadProc (int cpu);
+
+		static const size_t MinQueueSize = 64;
+		static const size_t SpinCount = 256;
+
+		// Scheduling cost charged for a key derivation, in bytes of data units
+		static const uint64 KeyDerivationCost = 1024 * 1024;
+		static const uint64 MaxBulkFragmentSize = 256 * 1024;
+
+		// A fragment is handed to another thread only if encrypting it takes at least
+		// FragmentCostFactor times as long as the calibrated dispatch round trip
+		static const size_t CalibrationDataSize = 16 * 1024;
+		static const size_t CalibrationPassCount = 16;
+		static const uint64 FragmentCostFactor = 2;
+
+		static bool Calibrated;
+		static Mutex CalibrationMutex;
+		static thread_local Client *CurrentClient;
+		static uint64 DispatchCost;
+		static FragmentSizeMap MinFragmentSizes;
+
+		ClientQueueList ClientQueues;
+		Mutex ClientQueuesMutex;
+		atomic <size_t> ClientQueuesVersion;
+		atomic <size_t> IdleThreadCount;
+		vector <int> PinnedCpus;
+		atomic <size_t> QueuedItemCount;
+		list < shared_ptr <Thread> > RunningThreads;
+		atomic <bool> StopPending;
+		size_t ThreadCount;
+		bool ThreadsPinned;
+		volatile bool ThreadsRunning;
+		atomic <uint64> VirtualTime;
+		SyncEvent WorkItemReadyEvent;
+		unique_ptr <Client> DefaultClient;
+
+	private:
+		EncryptionThreadPool (const EncryptionThreadPool &);
+		EncryptionThreadPool &operator= (const EncryptionThreadPool &);
 	};
 }
 
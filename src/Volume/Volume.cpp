@@ -14,6 +14,7 @@
 #include <errno.h>
 #endif
 #include "EncryptionModeXTS.h"
+#include "EncryptionThreadPool.h"
 #include "Volume.h"
 #include "VolumeHeader.h"
 #include "VolumeLayout.h"
@@ -40,6 +41,23 @@ namespace VeraCrypt
 	{
 	}
 
+	shared_ptr <FileIoQueue> Volume::AcquireIoQueue ()
+	{
+		{
+			ScopeLock lock (IoQueuesMutex);
+
+			if (!IoQueues.empty())
+			{
+				shared_ptr <FileIoQueue> ioQueue = IoQueues.front();
+				IoQueues.pop_front();
+				return ioQueue;
+			}
+		}
+
+		// Every thread reading or writing the volume concurrently uses a queue of its own
+		return shared_ptr <FileIoQueue> (new FileIoQueue (VolumeFile, IoQueueDepth));
+	}
+
 	void Volume::CheckProtectedRange (uint64 writeHostOffset, uint64 writeLength)
 	{
 		uint64 writeHostEndOffset = writeHostOffset + writeLength - 1;
@@ -56,6 +74,12 @@ namespace VeraCrypt
 		if (VolumeFile.get() == nullptr)
 			throw NotInitialized (SRC_POS);
 
+		// The queues keep the volume file open
+		{
+			ScopeLock lock (IoQueuesMutex);
+			IoQueues.clear();
+		}
+
 		VolumeFile.reset();
 	}
 
@@ -71,12 +95,16 @@ namespace VeraCrypt
 		return EA->GetMode();
 	}
 
-	void Volume::Open (const VolumePath &volumePath, bool preserveTimestamps, shared_ptr <VolumePassword> password, int pim, shared_ptr <Pkcs5Kdf> kdf, bool truecryptMode, shared_ptr <KeyfileList> keyfiles, VolumeProtection::Enum protection, shared_ptr <VolumePassword> protectionPassword, int protectionPim, shared_ptr <Pkcs5Kdf> protectionKdf, shared_ptr <KeyfileList> protectionKeyfiles, bool sharedAccessAllowed, VolumeType::Enum volumeType, bool useBackupHeaders, bool partitionInSystemEncryptionScope)
+	void Volume::Open (const VolumePath &volumePath, bool preserveTimestamps, shared_ptr <VolumePassword> password, int pim, shared_ptr <Pkcs5Kdf> kdf, bool truecryptMode, shared_ptr <KeyfileList> keyfiles, VolumeProtection::Enum protection, shared_ptr <VolumePassword> protectionPassword, int protectionPim, shared_ptr <Pkcs5Kdf> protectionKdf, shared_ptr <KeyfileList> protectionKeyfiles, bool sharedAccessAllowed, VolumeType::Enum volumeType, bool useBackupHeaders, bool partitionInSystemEncryptionScope, bool directIo)
 	{
 		make_shared_auto (File, file);
 
 		File::FileOpenFlags flags = (preserveTimestamps ? File::PreserveTimestamps : File::FlagsNone);
 
+		// Bypassing the page cache of the host leaves only the decrypted data cached
+		if (directIo)
+			flags = (File::FileOpenFlags) (flags | File::DirectIo);
+
 		try
 		{
 			if (protection == VolumeProtection::ReadOnly)
@@ -123,27 +151,32 @@ namespace VeraCrypt
 			VolumeHostSize = VolumeFile->Length();
 			shared_ptr <VolumePassword> passwordKey = Keyfile::ApplyListToPassword (keyfiles, password);
 
-			bool skipLayoutV1Normal = false;
+			HeaderCandidateList candidates;
 
-			// Test volume layouts
+			// Collect the header locations of all candidate layouts
 			foreach (shared_ptr <VolumeLayout> layout, VolumeLayout::GetAvailableLayouts (volumeType))
 			{
-				if (skipLayoutV1Normal && typeid (*layout) == typeid (VolumeLayoutV1Normal))
-				{
-					// Skip VolumeLayoutV1Normal as it shares header location with VolumeLayoutV2Normal
+				if (useBackupHeaders && !layout->HasBackupHeader())
 					continue;
-				}
 
-				if (useBackupHeaders && !layout->HasBackupHeader())
+				if (layout->HasDriveHeader() != partitionInSystemEncryptionScope)
 					continue;
 
-				SecureBuffer headerBuffer (layout->GetHeaderSize());
+				shared_ptr <HeaderCandidate> candidate (new HeaderCandidate);
+				candidate->Layout = layout;
+				candidate->HeaderBuffer.Allocate (layout->GetHeaderSize());
+				candidate->EncryptionAlgorithms = layout->GetSupportedEncryptionAlgorithms();
+				candidate->EncryptionModes = layout->GetSupportedEncryptionModes();
 
-				if (layout->HasDriveHeader())
+				if (typeid (*layout) == typeid (VolumeLayoutV2Normal))
 				{
-					if (!partitionInSystemEncryptionScope)
-						continue;
+					// Test all algorithms and modes of VolumeLayoutV1Normal as it shares header location with VolumeLayoutV2Normal
+					candidate->EncryptionAlgorithms = EncryptionAlgorithm::GetAvailableAlgorithms();
+					candidate->EncryptionModes = EncryptionMode::GetAvailableModes();
+				}
 
+				if (layout->HasDriveHeader())
+				{
 					if (!GetPath().IsDevice())
 						throw PartitionDeviceRequired (SRC_POS);
 
@@ -157,119 +190,133 @@ namespace VeraCrypt
 					else
 						driveDevice.SeekEnd (headerOffset);
 
-					if (driveDevice.Read (headerBuffer) != layout->GetHeaderSize())
+					if (driveDevice.Read (candidate->HeaderBuffer) != layout->GetHeaderSize())
 						continue;
+
+					candidate->HeaderRead = true;
 				}
 				else
 				{
-					if (partitionInSystemEncryptionScope)
-						continue;
-
 					int headerOffset = useBackupHeaders ? layout->GetBackupHeaderOffset() : layout->GetHeaderOffset();
 
-					if (headerOffset >= 0)
-						VolumeFile->SeekAt (headerOffset);
-					else
-						VolumeFile->SeekEnd (headerOffset);
-
-					if (VolumeFile->Read (headerBuffer) != layout->GetHeaderSize())
+					if (headerOffset < 0 && (uint64) -headerOffset > VolumeHostSize)
 						continue;
+
+					candidate->HeaderOffset = headerOffset >= 0 ? (uint64) headerOffset : VolumeHostSize + headerOffset;
+					candidate->HeaderRead = false;
 				}
 
-				EncryptionAlgorithmList layoutEncryptionAlgorithms = layout->GetSupportedEncryptionAlgorithms();
-				EncryptionModeList layoutEncryptionModes = layout->GetSupportedEncryptionModes();
+				candidates.push_back (candidate);
+			}
 
-				if (typeid (*layout) == typeid (VolumeLayoutV2Normal))
-				{
-					skipLayoutV1Normal = true;
+			ReadHeaderCandidates (candidates);
 
-					// Test all algorithms and modes of VolumeLayoutV1Normal as it shares header location with VolumeLayoutV2Normal
-					layoutEncryptionAlgorithms = EncryptionAlgorithm::GetAvailableAlgorithms();
-					layoutEncryptionModes = EncryptionMode::GetAvailableModes();
+			bool layoutV2NormalRead = false;
+			for (HeaderCandidateList::iterator i = candidates.begin(); i != candidates.end(); )
+			{
+				if (typeid (*(*i)->Layout) == typeid (VolumeLayoutV2Normal))
+				{
+					layoutV2NormalRead = true;
+				}
+				else if (layoutV2NormalRead && typeid (*(*i)->Layout) == typeid (VolumeLayoutV1Normal))
+				{
+					// Skip VolumeLayoutV1Normal as it shares header location with VolumeLayoutV2Normal
+					i = candidates.erase (i);
+					continue;
 				}
 
+				++i;
+			}
+
+			// Test volume layouts
+			shared_ptr <HeaderCandidate> decryptedCandidate = DecryptHeaderCandidates (candidates, *passwordKey, pim, kdf, truecryptMode);
+
+			if (decryptedCandidate)
+			{
+				// Header decrypted
+				shared_ptr <VolumeLayout> layout = decryptedCandidate->Layout;
 				shared_ptr <VolumeHeader> header = layout->GetHeader();
 
-				if (header->Decrypt (headerBuffer, *passwordKey, pim, kdf, truecryptMode, layout->GetSupportedKeyDerivationFunctions(truecryptMode), layoutEncryptionAlgorithms, layoutEncryptionModes))
+				if (!truecryptMode && typeid (*layout) == typeid (VolumeLayoutV2Normal) && header->GetRequiredMinProgramVersion() < 0x10b)
 				{
-					// Header decrypted
+					// VolumeLayoutV1Normal has been opened as VolumeLayoutV2Normal
+					layout.reset (new VolumeLayoutV1Normal);
+					header->SetSize (layout->GetHeaderSize());
+					layout->SetHeader (header);
+				}
 
-					if (!truecryptMode && typeid (*layout) == typeid (VolumeLayoutV2Normal) && header->GetRequiredMinProgramVersion() < 0x10b)
-					{
-						// VolumeLayoutV1Normal has been opened as VolumeLayoutV2Normal
-						layout.reset (new VolumeLayoutV1Normal);
-						header->SetSize (layout->GetHeaderSize());
-						layout->SetHeader (header);
-					}
+				TrueCryptMode = truecryptMode;
+				Pim = pim;
+				Type = layout->GetType();
+				SectorSize = header->GetSectorSize();
 
-					TrueCryptMode = truecryptMode;
-					Pim = pim;
-					Type = layout->GetType();
-					SectorSize = header->GetSectorSize();
+				VolumeDataOffset = layout->GetDataOffset (VolumeHostSize);
+				VolumeDataSize = layout->GetDataSize (VolumeHostSize);
+				EncryptedDataSize = header->GetEncryptedAreaLength();
 
-					VolumeDataOffset = layout->GetDataOffset (VolumeHostSize);
-					VolumeDataSize = layout->GetDataSize (VolumeHostSize);
-					EncryptedDataSize = header->GetEncryptedAreaLength();
+				// Sectors of the volume must be aligned to the blocks of the host storage for direct I/O
+				size_t directIoAlignment = VolumeFile->GetDirectIoAlignment();
+				if (directIoAlignment != 0 && (SectorSize % directIoAlignment != 0 || VolumeDataOffset % directIoAlignment != 0))
+					VolumeFile->DisableDirectIo();
 
-					Header = header;
-					Layout = layout;
-					EA = header->GetEncryptionAlgorithm();
-					EncryptionMode &mode = *EA->GetMode();
+				Header = header;
+				Layout = layout;
+				EA = header->GetEncryptionAlgorithm();
+				EncryptionMode &mode = *EA->GetMode();
 
-					if (layout->HasDriveHeader())
+				if (layout->HasDriveHeader())
+				{
+					if (header->GetEncryptedAreaLength() != header->GetVolumeDataSize())
 					{
-						if (header->GetEncryptedAreaLength() != header->GetVolumeDataSize())
-						{
-							EncryptionNotCompleted = true;
-							// we avoid writing data to the partition since it is only partially encrypted
-							Protection = VolumeProtection::ReadOnly;
-						}
+						EncryptionNotCompleted = true;
+						// we avoid writing data to the partition since it is only partially encrypted
+						Protection = VolumeProtection::ReadOnly;
+					}
 
-						uint64 partitionStartOffset = VolumeFile->GetPartitionDeviceStartOffset();
+					uint64 partitionStartOffset = VolumeFile->GetPartitionDeviceStartOffset();
 
-						if (partitionStartOffset < header->GetEncryptedAreaStart()
-							|| partitionStartOffset >= header->GetEncryptedAreaStart() + header->GetEncryptedAreaLength())
-							throw PasswordIncorrect (SRC_POS);
+					if (partitionStartOffset < header->GetEncryptedAreaStart()
+						|| partitionStartOffset >= header->GetEncryptedAreaStart() + header->GetEncryptedAreaLength())
+						throw PasswordIncorrect (SRC_POS);
 
-						EncryptedDataSize -= partitionStartOffset - header->GetEncryptedAreaStart();
+					EncryptedDataSize -= partitionStartOffset - header->GetEncryptedAreaStart();
 
-						mode.SetSectorOffset (partitionStartOffset / ENCRYPTION_DATA_UNIT_SIZE);
-					}
+					mode.SetSectorOffset (partitionStartOffset / ENCRYPTION_DATA_UNIT_SIZE);
+				}
 
-					// Volume protection
-					if (Protection == VolumeProtection::HiddenVolumeReadOnly)
+				// Volume protection
+				if (Protection == VolumeProtection::HiddenVolumeReadOnly)
+				{
+					if (Type == VolumeType::Hidden)
+						throw PasswordIncorrect (SRC_POS);
+					else
 					{
-						if (Type == VolumeType::Hidden)
-							throw PasswordIncorrect (SRC_POS);
-						else
+						try
 						{
-							try
-							{
-								Volume protectedVolume;
-
-								protectedVolume.Open (VolumeFile,
-									protectionPassword, protectionPim, protectionKdf, truecryptMode, protectionKeyfiles,
-									VolumeProtection::ReadOnly,
-									shared_ptr <VolumePassword> (), 0, shared_ptr <Pkcs5Kdf> (),shared_ptr <KeyfileList> (),
-									VolumeType::Hidden,
-									useBackupHeaders);
-
-								if (protectedVolume.GetType() != VolumeType::Hidden)
-									ParameterIncorrect (SRC_POS);
-
-								ProtectedRangeStart = protectedVolume.VolumeDataOffset;
-								ProtectedRangeEnd = protectedVolume.VolumeDataOffset + protectedVolume.VolumeDataSize;
-							}
-							catch (PasswordException&)
-							{
-								if (protectionKeyfiles && !protectionKeyfiles->empty())
-									throw ProtectionPasswordKeyfilesIncorrect (SRC_POS);
-								throw ProtectionPasswordIncorrect (SRC_POS);
-							}
+							Volume protectedVolume;
+
+							protectedVolume.Open (VolumeFile,
+								protectionPassword, protectionPim, protectionKdf, truecryptMode, protectionKeyfiles,
+								VolumeProtection::ReadOnly,
+								shared_ptr <VolumePassword> (), 0, shared_ptr <Pkcs5Kdf> (),shared_ptr <KeyfileList> (),
+								VolumeType::Hidden,
+								useBackupHeaders);
+
+							if (protectedVolume.GetType() != VolumeType::Hidden)
+								ParameterIncorrect (SRC_POS);
+
+							ProtectedRangeStart = protectedVolume.VolumeDataOffset;
+							ProtectedRangeEnd = protectedVolume.VolumeDataOffset + protectedVolume.VolumeDataSize;
+						}
+						catch (PasswordException&)
+						{
+							if (protectionKeyfiles && !protectionKeyfiles->empty())
+								throw ProtectionPasswordKeyfilesIncorrect (SRC_POS);
+							throw ProtectionPasswordIncorrect (SRC_POS);
 						}
 					}
-					return;
 				}
+				return;
 			}
 
 			if (partitionInSystemEncryptionScope)
@@ -310,46 +357,220 @@ namespace VeraCrypt
 		}
 	}
 
+	shared_ptr <Volume::HeaderCandidate> Volume::DecryptHeaderCandidates (const HeaderCandidateList &candidates, const VolumePassword &password, int pim, shared_ptr <Pkcs5Kdf> kdf, bool truecryptMode) const
+	{
+		size_t keyDerivationCount = 0;
+
+		foreach (shared_ptr <HeaderCandidate> candidate, candidates)
+		{
+			foreach (shared_ptr <Pkcs5Kdf> pkcs5, candidate->Layout->GetSupportedKeyDerivationFunctions (truecryptMode))
+			{
+				if (!kdf || kdf->GetName() == pkcs5->GetName())
+					++keyDerivationCount;
+			}
+		}
+
+		if (keyDerivationCount < 2 || EncryptionThreadPool::GetThreadCount() < 2)
+		{
+			foreach (shared_ptr <HeaderCandidate> candidate, candidates)
+			{
+				if (candidate->Layout->GetHeader()->Decrypt (candidate->HeaderBuffer, password, pim, kdf, truecryptMode,
+					candidate->Layout->GetSupportedKeyDerivationFunctions (truecryptMode), candidate->EncryptionAlgorithms, candidate->EncryptionModes))
+				{
+					return candidate;
+				}
+			}
+
+			return shared_ptr <HeaderCandidate> ();
+		}
+
+		// Derive the header keys of all layouts and PRFs concurrently and test them in order of completion
+		shared_ptr <EncryptionThreadPool::KeyDerivationCompletion> completion (new EncryptionThreadPool::KeyDerivationCompletion);
+		finally_do_arg (shared_ptr <EncryptionThreadPool::KeyDerivationCompletion>, completion, { finally_arg->Abort(); });
+
+		list < shared_ptr <EncryptionThreadPool::KeyDerivationTask> > tasks;
+		map <EncryptionThreadPool::KeyDerivationTask *, shared_ptr <HeaderCandidate> > taskCandidates;
+
+		foreach (shared_ptr <HeaderCandidate> candidate, candidates)
+		{
+			foreach (shared_ptr <Pkcs5Kdf> pkcs5, candidate->Layout->GetSupportedKeyDerivationFunctions (truecryptMode))
+			{
+				if (kdf && kdf->GetName() != pkcs5->GetName())
+					continue;
+
+				shared_ptr <EncryptionThreadPool::KeyDerivationTask> task (new EncryptionThreadPool::KeyDerivationTask (pkcs5, password, pim,
+					VolumeHeader::GetSalt (candidate->HeaderBuffer), VolumeHeader::GetLargestSerializedKeySize(), completion));
+
+				EncryptionThreadPool::BeginKeyDerivation (task);
+				tasks.push_back (task);
+				taskCandidates[task.get()] = candidate;
+			}
+		}
+
+		shared_ptr <EncryptionThreadPool::KeyDerivationTask> task;
+		while ((task = completion->WaitForTask (tasks)))
+		{
+			shared_ptr <HeaderCandidate> candidate = taskCandidates[task.get()];
+
+			if (candidate->Layout->GetHeader()->Decrypt (candidate->HeaderBuffer, task->DerivedKey, task->Pkcs5, truecryptMode, candidate->EncryptionAlgorithms, candidate->EncryptionModes))
+				return candidate;
+		}
+
+		return shared_ptr <HeaderCandidate> ();
+	}
+
+	void Volume::ReadHeaderCandidates (HeaderCandidateList &candidates) const
+	{
+		uint64 spanStart = 0;
+		uint64 spanEnd = 0;
+		bool spanEmpty = true;
+
+		foreach (shared_ptr <HeaderCandidate> candidate, candidates)
+		{
+			if (candidate->HeaderRead)
+				continue;
+
+			uint64 headerEnd = candidate->HeaderOffset + candidate->HeaderBuffer.Size();
+
+			if (spanEmpty || candidate->HeaderOffset < spanStart)
+				spanStart = candidate->HeaderOffset;
+
+			if (spanEmpty || headerEnd > spanEnd)
+				spanEnd = headerEnd;
+
+			spanEmpty = false;
+		}
+
+		if (!spanEmpty && spanEnd - spanStart <= TC_VOLUME_HEADER_GROUP_SIZE)
+		{
+			// All header locations lie within one header group and are read with a single request
+			SecureBuffer span ((size_t) (spanEnd - spanStart));
+			uint64 bytesRead = VolumeFile->ReadAt (span, spanStart);
+
+			foreach (shared_ptr <HeaderCandidate> candidate, candidates)
+			{
+				if (candidate->HeaderRead)
+					continue;
+
+				uint64 offset = candidate->HeaderOffset - spanStart;
+
+				if (offset + candidate->HeaderBuffer.Size() <= bytesRead)
+				{
+					candidate->HeaderBuffer.CopyFrom (span.GetRange ((size_t) offset, candidate->HeaderBuffer.Size()));
+					candidate->HeaderRead = true;
+				}
+			}
+		}
+		else if (!spanEmpty)
+		{
+			foreach (shared_ptr <HeaderCandidate> candidate, candidates)
+			{
+				if (!candidate->HeaderRead && VolumeFile->ReadAt (candidate->HeaderBuffer, candidate->HeaderOffset) == candidate->HeaderBuffer.Size())
+					candidate->HeaderRead = true;
+			}
+		}
+
+		for (HeaderCandidateList::iterator i = candidates.begin(); i != candidates.end(); )
+		{
+			if ((*i)->HeaderRead)
+				++i;
+			else
+				i = candidates.erase (i);
+		}
+	}
+
 	void Volume::ReadSectors (const BufferPtr &buffer, uint64 byteOffset)
 	{
 		if_debug (ValidateState ());
 
 		uint64 length = buffer.Size();
 		uint64 hostOffset = VolumeDataOffset + byteOffset;
-		size_t bufferOffset = 0;
+		uint64 dataRead = length;
 
 		if (length % SectorSize != 0 || byteOffset % SectorSize != 0)
 			throw ParameterIncorrect (SRC_POS);
 
-		if (VolumeFile->ReadAt (buffer, hostOffset) != length)
-			throw MissingVolumeData (SRC_POS);
-
-		// first sector can be unencrypted in some cases (e.g. windows repair)
-		// detect this case by looking for NTFS header
-		if (SystemEncryption && (hostOffset == 0) && ((BE64 (*(uint64 *) buffer.Get ())) == 0xEB52904E54465320ULL))
+		// Direct transfers of the volume file require aligned memory
+		size_t directIoAlignment = VolumeFile->GetDirectIoAlignment();
+		if (directIoAlignment != 0 && (uintptr_t) buffer.Get() % directIoAlignment != 0)
 		{
-			bufferOffset = (size_t) SectorSize;
-			hostOffset += SectorSize;
-			length -= SectorSize;
+			PooledSecureBuffer alignedBuffer (buffer.Size());
+			ReadSectors (alignedBuffer, byteOffset);
+			buffer.CopyFrom (alignedBuffer);
+			return;
 		}
 
-		if (length)
+		// Reads of the following chunks are kept in flight while the thread pool decrypts each chunk. If
+		// the queue performs reads synchronously, the next chunk is read while the previous one is decrypted.
+		shared_ptr <FileIoQueue> ioQueue = AcquireIoQueue();
+		finally_do_arg2 (Volume *, this, shared_ptr <FileIoQueue>, ioQueue, { finally_arg->ReleaseIoQueue (finally_arg2); });
+
+		size_t readAheadCount = ioQueue->IsAsynchronous() ? ioQueue->GetDepth() : 1;
+		list <FileIoQueue::RequestId> pendingReads;
+		uint64 readOffset = 0;
+
+		list < shared_ptr <EncryptionThreadPool::WorkItemCompletion> > pendingDecryptions;
+
+		for (uint64 chunkOffset = 0; chunkOffset < length; chunkOffset += IoPipelineChunkSize)
 		{
-			if (EncryptionNotCompleted)
+			size_t chunkLength = (size_t) VC_MIN (IoPipelineChunkSize, length - chunkOffset);
+			BufferPtr chunk = buffer.GetRange ((size_t) chunkOffset, chunkLength);
+			uint64 chunkHostOffset = hostOffset + chunkOffset;
+			size_t chunkBufferOffset = 0;
+
+			for (; readOffset < length && pendingReads.size() < readAheadCount; readOffset += IoPipelineChunkSize)
 			{
-				// if encryption is not complete, we decrypt only the encrypted sectors
-				if (hostOffset < EncryptedDataSize)
-				{
-					uint64 encryptedLength = VC_MIN (length, (EncryptedDataSize - hostOffset));
+				size_t readLength = (size_t) VC_MIN (IoPipelineChunkSize, length - readOffset);
+				pendingReads.push_back (ioQueue->QueueRead (buffer.GetRange ((size_t) readOffset, readLength), hostOffset + readOffset));
+			}
 
-					EA->DecryptSectors (buffer.GetRange (bufferOffset, encryptedLength), hostOffset / SectorSize, encryptedLength / SectorSize, SectorSize);			
-				}
+			ioQueue->Submit();
+
+			uint64 bytesRead = ioQueue->Wait (pendingReads.front());
+			pendingReads.pop_front();
+
+			if (bytesRead != chunkLength)
+				throw MissingVolumeData (SRC_POS);
+
+			// first sector can be unencrypted in some cases (e.g. windows repair)
+			// detect this case by looking for NTFS header
+			if (SystemEncryption && (chunkHostOffset == 0) && ((BE64 (*(uint64 *) chunk.Get ())) == 0xEB52904E54465320ULL))
+			{
+				chunkBufferOffset = (size_t) SectorSize;
+				chunkHostOffset += SectorSize;
+				dataRead -= SectorSize;
 			}
+
+			uint64 encryptedLength = chunkLength - chunkBufferOffset;
+
+			// if encryption is not complete, we decrypt only the encrypted sectors
+			if (EncryptionNotCompleted)
+				encryptedLength = chunkHostOffset < EncryptedDataSize ? VC_MIN (encryptedLength, EncryptedDataSize - chunkHostOffset) : 0;
+
+			if (encryptedLength == 0)
+				continue;
+
+			BufferPtr encryptedData = chunk.GetRange (chunkBufferOffset, (size_t) encryptedLength);
+
+			if (chunkOffset + chunkLength < length)
+				pendingDecryptions.push_back (EA->BeginDecryptSectors (encryptedData, chunkHostOffset / SectorSize, encryptedLength / SectorSize, SectorSize));
 			else
-				EA->DecryptSectors (buffer.GetRange (bufferOffset, length), hostOffset / SectorSize, length / SectorSize, SectorSize);
+				EA->DecryptSectors (encryptedData, chunkHostOffset / SectorSize, encryptedLength / SectorSize, SectorSize);
 		}
 
-		TotalDataRead += length;
+		foreach (shared_ptr <EncryptionThreadPool::WorkItemCompletion> decryption, pendingDecryptions)
+			decryption->Wait();
+
+		TotalDataRead += dataRead;
+	}
+
+	void Volume::ReleaseIoQueue (shared_ptr <FileIoQueue> ioQueue)
+	{
+		// Requests of a failed read or write may still be in flight
+		ioQueue->Reset();
+
+		ScopeLock lock (IoQueuesMutex);
+		IoQueues.push_back (ioQueue);
 	}
 
 	void Volume::ReEncryptHeader (bool backupHeader, const ConstBufferPtr &newSalt, const ConstBufferPtr &newHeaderKey, shared_ptr <Pkcs5Kdf> newPkcs5Kdf)
@@ -400,11 +621,49 @@ namespace VeraCrypt
 		if (Protection == VolumeProtection::HiddenVolumeReadOnly)
 			CheckProtectedRange (hostOffset, length);
 
-		SecureBuffer encBuf (buffer.Size());
-		encBuf.CopyFrom (buffer);
+		// The data is encrypted out of place into a buffer recycled by the calling thread
+		PooledSecureBuffer encBuf (buffer.Size());
+
+		// Each chunk is written while the thread pool encrypts the next one. Writes of previous chunks
+		// are kept in flight unless the queue performs them synchronously.
+		shared_ptr <FileIoQueue> ioQueue = AcquireIoQueue();
+		finally_do_arg2 (Volume *, this, shared_ptr <FileIoQueue>, ioQueue, { finally_arg->ReleaseIoQueue (finally_arg2); });
+
+		size_t writeBehindCount = ioQueue->IsAsynchronous() ? ioQueue->GetDepth() : 1;
+		list <FileIoQueue::RequestId> pendingWrites;
+
+		size_t chunkLength = (size_t) VC_MIN (IoPipelineChunkSize, length);
+		EA->EncryptSectors (buffer, encBuf, hostOffset / SectorSize, chunkLength / SectorSize, SectorSize);
+
+		for (uint64 chunkOffset = 0; chunkOffset < length; )
+		{
+			uint64 nextChunkOffset = chunkOffset + chunkLength;
+			size_t nextChunkLength = (size_t) VC_MIN (IoPipelineChunkSize, length - nextChunkOffset);
+			shared_ptr <EncryptionThreadPool::WorkItemCompletion> nextChunkEncryption;
+
+			if (nextChunkLength > 0)
+			{
+				nextChunkEncryption = EA->BeginEncryptSectors (buffer.GetRange ((size_t) nextChunkOffset, nextChunkLength), encBuf.GetRange ((size_t) nextChunkOffset, nextChunkLength),
+					(hostOffset + nextChunkOffset) / SectorSize, nextChunkLength / SectorSize, SectorSize);
+			}
+
+			pendingWrites.push_back (ioQueue->QueueWrite (encBuf.GetRange ((size_t) chunkOffset, chunkLength), hostOffset + chunkOffset));
+			ioQueue->Submit();
+
+			if (pendingWrites.size() >= writeBehindCount)
+			{
+				ioQueue->Wait (pendingWrites.front());
+				pendingWrites.pop_front();
+			}
+
+			if (nextChunkEncryption)
+				nextChunkEncryption->Wait();
+
+			chunkOffset = nextChunkOffset;
+			chunkLength = nextChunkLength;
+		}
 
-		EA->EncryptSectors (encBuf, hostOffset / SectorSize, length / SectorSize, SectorSize);
-		VolumeFile->WriteAt (encBuf, hostOffset);
+		ioQueue->WaitAll();
 
 		TotalDataWritten += length;
 
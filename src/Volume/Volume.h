@@ -14,6 +14,7 @@
 #define TC_HEADER_Volume_Volume
 
 #include "Platform/Platform.h"
+#include "Platform/FileIoQueue.h"
 #include "Platform/StringConverter.h"
 #include "EncryptionAlgorithm.h"
 #include "EncryptionMode.h"
@@ -123,7 +124,7 @@ namespace VeraCrypt
 		uint64 GetVolumeCreationTime () const { return Header->GetVolumeCreationTime(); }
 		bool IsHiddenVolumeProtectionTriggered () const { return HiddenVolumeProtectionTriggered; }
 		bool IsInSystemEncryptionScope () const { return SystemEncryption; }
-		void Open (const VolumePath &volumePath, bool preserveTimestamps, shared_ptr <VolumePassword> password, int pim, shared_ptr <Pkcs5Kdf> kdf, bool truecryptMode, shared_ptr <KeyfileList> keyfiles, VolumeProtection::Enum protection = VolumeProtection::None, shared_ptr <VolumePassword> protectionPassword = shared_ptr <VolumePassword> (), int protectionPim = 0, shared_ptr <Pkcs5Kdf> protectionKdf = shared_ptr <Pkcs5Kdf> (),shared_ptr <KeyfileList> protectionKeyfiles = shared_ptr <KeyfileList> (), bool sharedAccessAllowed = false, VolumeType::Enum volumeType = VolumeType::Unknown, bool useBackupHeaders = false, bool partitionInSystemEncryptionScope = false);
+		void Open (const VolumePath &volumePath, bool preserveTimestamps, shared_ptr <VolumePassword> password, int pim, shared_ptr <Pkcs5Kdf> kdf, bool truecryptMode, shared_ptr <KeyfileList> keyfiles, VolumeProtection::Enum protection = VolumeProtection::None, shared_ptr <VolumePassword> protectionPassword = shared_ptr <VolumePassword> (), int protectionPim = 0, shared_ptr <Pkcs5Kdf> protectionKdf = shared_ptr <Pkcs5Kdf> (),shared_ptr <KeyfileList> protectionKeyfiles = shared_ptr <KeyfileList> (), bool sharedAccessAllowed = false, VolumeType::Enum volumeType = VolumeType::Unknown, bool useBackupHeaders = false, bool partitionInSystemEncryptionScope = false, bool directIo = false);
 		void Open (shared_ptr <File> volumeFile, shared_ptr <VolumePassword> password, int pim, shared_ptr <Pkcs5Kdf> kdf, bool truecryptMode, shared_ptr <KeyfileList> keyfiles, VolumeProtection::Enum protection = VolumeProtection::None, shared_ptr <VolumePassword> protectionPassword = shared_ptr <VolumePassword> (), int protectionPim = 0, shared_ptr <Pkcs5Kdf> protectionKdf = shared_ptr <Pkcs5Kdf> (), shared_ptr <KeyfileList> protectionKeyfiles = shared_ptr <KeyfileList> (), VolumeType::Enum volumeType = VolumeType::Unknown, bool useBackupHeaders = false, bool partitionInSystemEncryptionScope = false);
 		void ReadSectors (const BufferPtr &buffer, uint64 byteOffset);
 		void ReEncryptHeader (bool backupHeader, const ConstBufferPtr &newSalt, const ConstBufferPtr &newHeaderKey, shared_ptr <Pkcs5Kdf> newPkcs5Kdf);
@@ -131,12 +132,36 @@ namespace VeraCrypt
 		bool IsEncryptionNotCompleted () const { return EncryptionNotCompleted; }
 
 	protected:
+		struct HeaderCandidate
+		{
+			shared_ptr <VolumeLayout> Layout;
+			SecureBuffer HeaderBuffer;
+			uint64 HeaderOffset;
+			bool HeaderRead;
+			EncryptionAlgorithmList EncryptionAlgorithms;
+			EncryptionModeList EncryptionModes;
+		};
+
+		typedef list < shared_ptr <HeaderCandidate> > HeaderCandidateList;
+
+		shared_ptr <FileIoQueue> AcquireIoQueue ();
 		void CheckProtectedRange (uint64 writeHostOffset, uint64 writeLength);
+		shared_ptr <HeaderCandidate> DecryptHeaderCandidates (const HeaderCandidateList &candidates, const VolumePassword &password, int pim, shared_ptr <Pkcs5Kdf> kdf, bool truecryptMode) const;
+		void ReadHeaderCandidates (HeaderCandidateList &candidates) const;
+		void ReleaseIoQueue (shared_ptr <FileIoQueue> ioQueue);
 		void ValidateState () const;
 
+		// Size of the chunks in which sector I/O is overlapped with encryption
+		static const uint64 IoPipelineChunkSize = 64 * 1024;
+
+		// Number of chunks of a sector read or write kept in flight
+		static const size_t IoQueueDepth = 8;
+
 		shared_ptr <EncryptionAlgorithm> EA;
 		shared_ptr <VolumeHeader> Header;
 		bool HiddenVolumeProtectionTriggered;
+		list < shared_ptr <FileIoQueue> > IoQueues;
+		Mutex IoQueuesMutex;
 		shared_ptr <VolumeLayout> Layout;
 		uint64 ProtectedRangeStart;
 		uint64 ProtectedRangeEnd;
@@ -12,7 +12,7 @@
 
 #include "Crc32.h"
 #include "EncryptionModeXTS.h"
-#include "Pkcs5Kdf.h"
+#include "EncryptionThreadPool.h"
 #include "Pkcs5Kdf.h"
 #include "VolumeHeader.h"
 #include "VolumeException.h"
@@ -87,50 +87,90 @@ namespace VeraCrypt
 		if (password.Size() < 1)
 			throw PasswordEmpty (SRC_POS);
 
-		ConstBufferPtr salt (encryptedData.GetRange (SaltOffset, SaltSize));
-		SecureBuffer header (EncryptedHeaderDataSize);
+		ConstBufferPtr salt (GetSalt (encryptedData));
 		SecureBuffer headerKey (GetLargestSerializedKeySize());
 
+		Pkcs5KdfList candidateKdfs;
 		foreach (shared_ptr <Pkcs5Kdf> pkcs5, keyDerivationFunctions)
 		{
 			if (kdf && (kdf->GetName() != pkcs5->GetName()))
 				continue;
 
+			candidateKdfs.push_back (pkcs5);
+		}
+
+		if (candidateKdfs.size() > 1 && EncryptionThreadPool::GetThreadCount() > 1)
+		{
+			// Derive the header keys for all PRFs concurrently and test them in order of completion
+			shared_ptr <EncryptionThreadPool::KeyDerivationCompletion> completion (new EncryptionThreadPool::KeyDerivationCompletion);
+			finally_do_arg (shared_ptr <EncryptionThreadPool::KeyDerivationCompletion>, completion, { finally_arg->Abort(); });
+
+			list < shared_ptr <EncryptionThreadPool::KeyDerivationTask> > tasks;
+
+			foreach (shared_ptr <Pkcs5Kdf> pkcs5, candidateKdfs)
+			{
+				shared_ptr <EncryptionThreadPool::KeyDerivationTask> task (new EncryptionThreadPool::KeyDerivationTask (pkcs5, password, pim, salt, headerKey.Size(), completion));
+				EncryptionThreadPool::BeginKeyDerivation (task);
+				tasks.push_back (task);
+			}
+
+			shared_ptr <EncryptionThreadPool::KeyDerivationTask> task;
+			while ((task = completion->WaitForTask (tasks)))
+			{
+				if (Decrypt (encryptedData, task->DerivedKey, task->Pkcs5, truecryptMode, encryptionAlgorithms, encryptionModes))
+					return true;
+			}
+
+			return false;
+		}
+
+		foreach (shared_ptr <Pkcs5Kdf> pkcs5, candidateKdfs)
+		{
 			pkcs5->DeriveKey (headerKey, password, pim, salt);
 
-			foreach (shared_ptr <EncryptionMode> mode, encryptionModes)
+			if (Decrypt (encryptedData, headerKey, pkcs5, truecryptMode, encryptionAlgorithms, encryptionModes))
+				return true;
+		}
+
+		return false;
+	}
+
+	bool VolumeHeader::Decrypt (const ConstBufferPtr &encryptedData, const ConstBufferPtr &headerKey, shared_ptr <Pkcs5Kdf> pkcs5, bool truecryptMode, const EncryptionAlgorithmList &encryptionAlgorithms, const EncryptionModeList &encryptionModes)
+	{
+		SecureBuffer header (EncryptedHeaderDataSize);
+
+		foreach (shared_ptr <EncryptionMode> mode, encryptionModes)
+		{
+			if (typeid (*mode) != typeid (EncryptionModeXTS))
+				mode->SetKey (headerKey.GetRange (0, mode->GetKeySize()));
+
+			foreach (shared_ptr <EncryptionAlgorithm> ea, encryptionAlgorithms)
 			{
-				if (typeid (*mode) != typeid (EncryptionModeXTS))
-					mode->SetKey (headerKey.GetRange (0, mode->GetKeySize()));
+				if (!ea->IsModeSupported (mode))
+					continue;
+
+				if (typeid (*mode) == typeid (EncryptionModeXTS))
+				{
+					ea->SetKey (headerKey.GetRange (0, ea->GetKeySize()));
+
+					mode = mode->GetNew();
+					mode->SetKey (headerKey.GetRange (ea->GetKeySize(), ea->GetKeySize()));
+				}
+				else
+				{
+					ea->SetKey (headerKey.GetRange (LegacyEncryptionModeKeyAreaSize, ea->GetKeySize()));
+				}
+
+				ea->SetMode (mode);
+
+				header.CopyFrom (encryptedData.GetRange (EncryptedHeaderDataOffset, EncryptedHeaderDataSize));
+				ea->Decrypt (header);
 
-				foreach (shared_ptr <EncryptionAlgorithm> ea, encryptionAlgorithms)
+				if (Deserialize (header, ea, mode, truecryptMode))
 				{
-					if (!ea->IsModeSupported (mode))
-						continue;
-
-					if (typeid (*mode) == typeid (EncryptionModeXTS))
-					{
-						ea->SetKey (headerKey.GetRange (0, ea->GetKeySize()));
-
-						mode = mode->GetNew();
-						mode->SetKey (headerKey.GetRange (ea->GetKeySize(), ea->GetKeySize()));
-					}
-					else
-					{
-						ea->SetKey (headerKey.GetRange (LegacyEncryptionModeKeyAreaSize, ea->GetKeySize()));
-					}
-
-					ea->SetMode (mode);
-
-					header.CopyFrom (encryptedData.GetRange (EncryptedHeaderDataOffset, EncryptedHeaderDataSize));
-					ea->Decrypt (header);
-
-					if (Deserialize (header, ea, mode, truecryptMode))
-					{
-						EA = ea;
-						Pkcs5 = pkcs5;
-						return true;
-					}
+					EA = ea;
+					Pkcs5 = pkcs5;
+					return true;
 				}
 			}
 		}
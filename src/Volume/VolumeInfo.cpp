@@ -114,6 +114,7 @@ namespace VeraCrypt
 		Pkcs5IterationCount = volume.GetPkcs5Kdf()->GetIterationCount(volume.GetPim ());
 		Pkcs5PrfName = volume.GetPkcs5Kdf()->GetName();
 		Protection = volume.GetProtectionType();
+		ReadAheadHits = 0;
 		Size = volume.GetSize();
 		SystemEncryption = volume.IsInSystemEncryptionScope();
 		Type = volume.GetType();
@@ -26,7 +26,7 @@ namespace VeraCrypt
 	class VolumeInfo : public Serializable
 	{
 	public:
-		VolumeInfo () { }
+		VolumeInfo () : ReadAheadHits (0) { }
 		virtual ~VolumeInfo () { }
 
 		TC_SERIALIZABLE (VolumeInfo);
@@ -63,6 +63,9 @@ namespace VeraCrypt
 		bool TrueCryptMode;
 		int Pim;
 
+		// Not serialized; reported separately by the FUSE service control file
+		uint64 ReadAheadHits;
+
 	private:
 		VolumeInfo (const VolumeInfo &);
 		VolumeInfo &operator= (const VolumeInfo &);